@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_NAVIGATION__DIJKSTRA_MESH_PLANNER__CONTRACTION_HIERARCHY_H
+#define MESH_NAVIGATION__DIJKSTRA_MESH_PLANNER__CONTRACTION_HIERARCHY_H
+
+#include <atomic>
+#include <lvr2/attrmaps/AttrMaps.hpp>
+#include <lvr2/geometry/HalfEdgeMesh.hpp>
+#include <lvr2/io/AttributeMeshIOBase.hpp>
+#include <memory>
+#include <mesh_map/mesh_map.h>
+#include <vector>
+
+namespace dijkstra_mesh_planner
+{
+/**
+ * @brief Contraction hierarchy over the edge graph of the mesh. The vertices are contracted in the order of their
+ * importance, shortcuts preserve the shortest path distances between the remaining vertices. Point to point queries
+ * are answered with a bidirectional search which only relaxes edges leading to higher ranked vertices.
+ */
+class ContractionHierarchy
+{
+public:
+  typedef std::shared_ptr<ContractionHierarchy> Ptr;
+
+  //! the group name used to store the hierarchy with the map
+  static const std::string CHANNEL_GROUP;
+
+  ContractionHierarchy();
+
+  /**
+   * @brief Contracts all passable vertices of the mesh
+   * @param mesh The mesh providing the edge graph
+   * @param edge_weights The edge weights to preserve the shortest paths for
+   * @param passable Vertices which are not passable are not part of the hierarchy
+   * @param cancel The build is stopped as soon as the flag is set
+   * @return true if the hierarchy has been built completely
+   */
+  bool build(const lvr2::HalfEdgeMesh<mesh_map::Vector>& mesh, const lvr2::DenseEdgeMap<float>& edge_weights,
+             const lvr2::DenseVertexMap<bool>& passable, const std::atomic_bool& cancel);
+
+  /**
+   * @brief Computes the shortest path between the start and the goal vertex
+   * @param start The start vertex
+   * @param goal The goal vertex
+   * @param path The unpacked path including the start and the goal vertex
+   * @param distance The path length
+   * @return true if a path has been found and completely unpacked
+   */
+  bool query(const lvr2::VertexHandle& start, const lvr2::VertexHandle& goal, std::vector<lvr2::VertexHandle>& path,
+             float& distance) const;
+
+  /**
+   * @brief Writes the hierarchy to the map
+   * @param io The mesh io of the map
+   * @return true if all channels have been written successfully
+   */
+  bool save(lvr2::AttributeMeshIOBase& io) const;
+
+  /**
+   * @brief Reads a hierarchy stored with the map, it is accepted only if it has been built for the given input
+   * @param io The mesh io of the map
+   * @param fingerprint The fingerprint of the current input, see computeFingerprint()
+   * @return true if a matching hierarchy has been loaded
+   */
+  bool load(lvr2::AttributeMeshIOBase& io, const uint32_t fingerprint);
+
+  /**
+   * @brief Computes a fingerprint of the input graph, i.e. of the passable vertices and the weights of their edges
+   */
+  static uint32_t computeFingerprint(const lvr2::HalfEdgeMesh<mesh_map::Vector>& mesh,
+                                     const lvr2::DenseEdgeMap<float>& edge_weights,
+                                     const lvr2::DenseVertexMap<bool>& passable);
+
+  /**
+   * @brief Returns the fingerprint of the input graph the hierarchy has been built for
+   */
+  uint32_t fingerprint() const
+  {
+    return input_fingerprint;
+  }
+
+  /**
+   * @brief Returns true if the vertex is part of the hierarchy
+   */
+  bool contains(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < rank.size() && rank[vH.idx()] != NONE;
+  }
+
+private:
+  //! marks missing vertices and original edges, i.e. edges without a middle vertex
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  //! the format version of the stored hierarchy
+  static constexpr uint32_t FORMAT_VERSION = 1;
+
+  //! edge of the hierarchy, shortcuts store the contracted middle vertex
+  struct Arc
+  {
+    uint32_t target;
+    float weight;
+    uint32_t middle;
+  };
+
+  /**
+   * @brief Unpacks the given arc recursively and appends all vertices except the first one
+   * @return false if an arc of the unpacked path is missing
+   */
+  bool unpack(const uint32_t from, const uint32_t to, std::vector<lvr2::VertexHandle>& path) const;
+
+  /**
+   * @brief Returns the upward arc between the given vertices or a nullptr if there is none
+   */
+  const Arc* findArc(const uint32_t a, const uint32_t b) const;
+
+  //! contraction order of each vertex, NONE for vertices which are not part of the hierarchy
+  std::vector<uint32_t> rank;
+
+  //! offsets of the upward arcs of each vertex
+  std::vector<uint32_t> up_offsets;
+
+  //! the arcs leading to higher ranked vertices
+  std::vector<Arc> up_arcs;
+
+  //! fingerprint of the input graph
+  uint32_t input_fingerprint;
+};
+
+}  // namespace dijkstra_mesh_planner
+
+#endif  // MESH_NAVIGATION__DIJKSTRA_MESH_PLANNER__CONTRACTION_HIERARCHY_H
@@ -42,7 +42,10 @@
 #include <mbf_msgs/GetPathResult.h>
 #include <mesh_map/mesh_map.h>
 #include <dijkstra_mesh_planner/DijkstraMeshPlannerConfig.h>
+#include <dijkstra_mesh_planner/contraction_hierarchy.h>
 #include <nav_msgs/Path.h>
+#include <mutex>
+#include <thread>
 
 namespace dijkstra_mesh_planner
 {
@@ -88,6 +91,27 @@ public:
                             double tolerance, std::vector<geometry_msgs::PoseStamped>& plan, double& cost,
                             std::string& message);
 
+  /**
+   * @brief Given multiple goal poses in the world, compute the plans to all of them with a single Dijkstra run.
+   * The search is seeded at the start and stops once all goal vertices are fixed. The vector field stored in the
+   * mesh map is not touched.
+   *
+   * @param start The start pose
+   * @param goals The goal poses
+   * @param tolerance If a goal is obstructed, how many meters the planner can
+   * relax the constraint in x and y before failing
+   * @param plans The plans... filled by the planner, one for each goal
+   * @param costs The costs for the plans, one for each goal
+   * @param outcomes The result codes for each goal as described on GetPath action result
+   * @param message Optional more detailed outcome as a string
+   *
+   * @return SUCCESS if at least one of the goals has been reached, otherwise an error result code
+   */
+  virtual uint32_t makePlans(const geometry_msgs::PoseStamped& start,
+                             const std::vector<geometry_msgs::PoseStamped>& goals, double tolerance,
+                             std::vector<std::vector<geometry_msgs::PoseStamped>>& plans, std::vector<double>& costs,
+                             std::vector<uint32_t>& outcomes, std::string& message);
+
   /**
    * @brief Requests the planner to cancel, e.g. if it takes too much time.
    *
@@ -134,7 +158,8 @@ protected:
    * @param goal[in] 3D goal position of the requested path
    * @param edge_weights[in] edge distances of the map
    * @param costs[in] vertex costs of the map
-   * @param path[out] optimal path from the given starting position to tie goal position
+   * @param path[out] optimal path from the given starting position to tie goal position, it starts with the vertex
+   * nearest to the start and ends before the vertex nearest to the goal
    * @param distances[out] per vertex distances to goal
    * @param predecessors[out] dense predecessor map for all visited vertices
    *
@@ -146,6 +171,60 @@ protected:
                     std::list<lvr2::VertexHandle>& path, lvr2::DenseVertexMap<float>& distances,
                     lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors);
 
+  /**
+   * @brief runs dijkstra path planning from the start to multiple goals at once
+   *
+   * @param start[in] 3D starting position of the requested paths, i.e. the seed
+   * @param goals[in] 3D goal positions of the requested paths
+   * @param edge_weights[in] edge distances of the map
+   * @param costs[in] vertex costs of the map
+   * @param paths[out] optimal paths from the given starting position to each of the goal positions
+   * @param outcomes[out] result code in form of GetPath action result for each goal
+   * @param distances[out] per vertex distances to the start
+   * @param predecessors[out] dense predecessor map for all visited vertices
+   *
+   * @return SUCCESS if at least one of the goals has been reached, otherwise NO_PATH_FOUND, INVALID_START,
+   * INVALID_GOAL, or CANCELED
+   */
+  uint32_t dijkstra(const mesh_map::Vector& start, const std::vector<mesh_map::Vector>& goals,
+                    const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::DenseVertexMap<float>& costs,
+                    std::vector<std::list<lvr2::VertexHandle>>& paths, std::vector<uint32_t>& outcomes,
+                    lvr2::DenseVertexMap<float>& distances, lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors);
+
+  /**
+   * @brief answers the query with the contraction hierarchy and computes the vector field in a corridor around the
+   * path. Triggers a (re-)build of the hierarchy in the background if there is no hierarchy for the current costs.
+   *
+   * @param start[in] 3D starting position of the requested path, i.e. the seed
+   * @param goal[in] 3D goal position of the requested path
+   * @param path[out] the path in the same order as computed by dijkstra()
+   *
+   * @return true if the query has been answered, false if the normal search has to be used
+   */
+  bool contractionHierarchyQuery(const mesh_map::Vector& start, const mesh_map::Vector& goal,
+                                 std::list<lvr2::VertexHandle>& path);
+
+  /**
+   * @brief loads a matching contraction hierarchy from the map or starts building one in the background
+   *
+   * @param cost_version[in] the cost version of the mesh map the hierarchy is requested for
+   */
+  void updateContractionHierarchy(const uint64_t cost_version);
+
+  /**
+   * @brief converts a vertex path into a plan of poses
+   *
+   * @param path[in] the vertices of the path, ordered from the start to the goal
+   * @param start[in] 3D starting position of the plan
+   * @param goal[in] 3D goal position of the plan
+   * @param header[in] the header used for all poses
+   * @param plan[out] the resulting plan
+   * @param cost[out] the length of the plan
+   */
+  void pathToPlan(const std::list<lvr2::VertexHandle>& path, const mesh_map::Vector& start,
+                  const mesh_map::Vector& goal, const std_msgs::Header& header,
+                  std::vector<geometry_msgs::PoseStamped>& plan, double& cost);
+
   /**
    * @brief calculates the vector field based on the current predecessors map and stores it to the vector_map field of this class
    */
@@ -168,6 +247,8 @@ private:
   ros::NodeHandle private_nh;
   // true if the abort of the current planning was requested; else false
   std::atomic_bool cancel_planning;
+  // serializes planning requests, e.g. from the action server and the multi goal service
+  std::mutex planning_mtx;
   // publisher of resulting path
   ros::Publisher path_pub;
   // publisher of resulting vector fiels
@@ -194,6 +275,21 @@ private:
   lvr2::DenseVertexMap<mesh_map::Vector> vector_map;
   // potential field or distance values to the source (path goal)
   lvr2::DenseVertexMap<float> potential;
+
+  // contraction hierarchy for the current costs, empty if none is available yet
+  ContractionHierarchy::Ptr contraction_hierarchy;
+  // cost version of the mesh map the contraction hierarchy has been built for
+  uint64_t hierarchy_cost_version;
+  // cost limit the contraction hierarchy has been built with
+  float hierarchy_cost_limit;
+  // protects the contraction hierarchy and its build state
+  std::mutex hierarchy_mtx;
+  // background thread building the contraction hierarchy
+  std::thread hierarchy_thread;
+  // true while the contraction hierarchy is built in the background
+  std::atomic_bool hierarchy_building;
+  // stops the background build on destruction
+  std::atomic_bool hierarchy_cancel;
 };
 
 }  // namespace dijkstra_mesh_planner
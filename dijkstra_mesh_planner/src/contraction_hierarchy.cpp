@@ -0,0 +1,518 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+
+#include "dijkstra_mesh_planner/contraction_hierarchy.h"
+
+namespace dijkstra_mesh_planner
+{
+const std::string ContractionHierarchy::CHANNEL_GROUP = "contraction_hierarchy";
+constexpr uint32_t ContractionHierarchy::NONE;
+constexpr uint32_t ContractionHierarchy::FORMAT_VERSION;
+
+//! limits the number of settled vertices of a witness search, missed witnesses only lead to additional shortcuts
+static constexpr size_t MAX_WITNESS_SETTLED = 500;
+
+//! serialises the reads and writes of the hierarchy channels, the hierarchy is written from the background build
+//! thread and several planners may share the map
+static std::mutex io_mtx;
+
+ContractionHierarchy::ContractionHierarchy() : input_fingerprint(0)
+{
+}
+
+uint32_t ContractionHierarchy::computeFingerprint(const lvr2::HalfEdgeMesh<mesh_map::Vector>& mesh,
+                                                  const lvr2::DenseEdgeMap<float>& edge_weights,
+                                                  const lvr2::DenseVertexMap<bool>& passable)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](const uint32_t value) {
+    for (int i = 0; i < 4; i++)
+    {
+      hash ^= (value >> (8 * i)) & 0xff;
+      hash *= 16777619u;
+    }
+  };
+
+  mix(mesh.nextVertexIndex());
+  for (auto vH : mesh.vertices())
+  {
+    if (passable[vH])
+      mix(vH.idx());
+  }
+  for (auto eH : mesh.edges())
+  {
+    const auto vertices = mesh.getVerticesOfEdge(eH);
+    if (!passable[vertices[0]] || !passable[vertices[1]])
+      continue;
+    const float weight = edge_weights[eH];
+    uint32_t bits;
+    std::memcpy(&bits, &weight, sizeof(bits));
+    mix(eH.idx());
+    mix(bits);
+  }
+  return hash;
+}
+
+bool ContractionHierarchy::build(const lvr2::HalfEdgeMesh<mesh_map::Vector>& mesh,
+                                 const lvr2::DenseEdgeMap<float>& edge_weights,
+                                 const lvr2::DenseVertexMap<bool>& passable, const std::atomic_bool& cancel)
+{
+  const size_t n = mesh.nextVertexIndex();
+  input_fingerprint = computeFingerprint(mesh, edge_weights, passable);
+  rank.assign(n, NONE);
+  up_offsets.assign(n + 1, 0);
+  up_arcs.clear();
+
+  // graph of the not yet contracted vertices including all shortcuts
+  std::vector<std::vector<Arc>> graph(n);
+  auto addArc = [&graph](const uint32_t from, const uint32_t to, const float weight, const uint32_t middle) {
+    for (auto& arc : graph[from])
+    {
+      if (arc.target == to)
+      {
+        if (weight < arc.weight)
+        {
+          arc.weight = weight;
+          arc.middle = middle;
+        }
+        return;
+      }
+    }
+    graph[from].push_back({ to, weight, middle });
+  };
+
+  std::vector<bool> in_graph(n, false);
+  for (auto vH : mesh.vertices())
+  {
+    in_graph[vH.idx()] = passable[vH];
+  }
+
+  for (auto eH : mesh.edges())
+  {
+    const auto vertices = mesh.getVerticesOfEdge(eH);
+    const uint32_t a = vertices[0].idx();
+    const uint32_t b = vertices[1].idx();
+    const float weight = edge_weights[eH];
+    if (!in_graph[a] || !in_graph[b] || !std::isfinite(weight))
+      continue;
+    addArc(a, b, weight, NONE);
+    addArc(b, a, weight, NONE);
+  }
+
+  std::vector<bool> contracted(n, false);
+  std::vector<int> contracted_neighbours(n, 0);
+
+  // witness search state, reset via the touched vertices
+  std::vector<float> witness_dist(n, std::numeric_limits<float>::infinity());
+  std::vector<uint32_t> touched;
+
+  typedef std::pair<float, uint32_t> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> witness_pq;
+
+  // the shortcuts (u, w, weight) which are necessary if v is contracted
+  std::vector<std::tuple<uint32_t, uint32_t, float>> shortcuts;
+  auto findShortcuts = [&](const uint32_t v) {
+    shortcuts.clear();
+    const auto& arcs = graph[v];
+    float max_weight = 0;
+    for (const auto& arc : arcs)
+    {
+      if (!contracted[arc.target])
+        max_weight = std::max(max_weight, arc.weight);
+    }
+
+    for (const auto& in : arcs)
+    {
+      const uint32_t u = in.target;
+      if (contracted[u])
+        continue;
+
+      // search for witnesses from u which do not pass v
+      const float limit = in.weight + max_weight;
+      witness_dist[u] = 0;
+      touched.push_back(u);
+      witness_pq.emplace(0, u);
+      size_t settled = 0;
+      while (!witness_pq.empty() && settled < MAX_WITNESS_SETTLED)
+      {
+        const QueueEntry top = witness_pq.top();
+        witness_pq.pop();
+        if (top.first > witness_dist[top.second])
+          continue;
+        if (top.first > limit)
+          break;
+        settled++;
+        for (const auto& arc : graph[top.second])
+        {
+          if (arc.target == v || contracted[arc.target])
+            continue;
+          const float dist = top.first + arc.weight;
+          if (dist < witness_dist[arc.target])
+          {
+            if (std::isinf(witness_dist[arc.target]))
+              touched.push_back(arc.target);
+            witness_dist[arc.target] = dist;
+            witness_pq.emplace(dist, arc.target);
+          }
+        }
+      }
+      witness_pq = decltype(witness_pq)();
+
+      // each pair is handled once, the graph is undirected
+      for (const auto& out : arcs)
+      {
+        const uint32_t w = out.target;
+        if (w <= u || contracted[w])
+          continue;
+        const float via = in.weight + out.weight;
+        if (witness_dist[w] > via)
+          shortcuts.emplace_back(u, w, via);
+      }
+
+      for (auto t : touched)
+        witness_dist[t] = std::numeric_limits<float>::infinity();
+      touched.clear();
+    }
+  };
+
+  auto priority = [&](const uint32_t v) {
+    int degree = 0;
+    for (const auto& arc : graph[v])
+    {
+      if (!contracted[arc.target])
+        degree++;
+    }
+    return static_cast<int>(shortcuts.size()) - degree + contracted_neighbours[v];
+  };
+
+  typedef std::pair<int, uint32_t> OrderEntry;
+  std::priority_queue<OrderEntry, std::vector<OrderEntry>, std::greater<OrderEntry>> order;
+  for (uint32_t v = 0; v < n; v++)
+  {
+    if (!in_graph[v])
+      continue;
+    findShortcuts(v);
+    order.emplace(priority(v), v);
+  }
+
+  uint32_t next_rank = 0;
+  while (!order.empty())
+  {
+    if (cancel)
+      return false;
+
+    const uint32_t v = order.top().second;
+    order.pop();
+    if (contracted[v])
+      continue;
+
+    // lazy update of the priority, postpone the vertex if it is not the least important one anymore
+    findShortcuts(v);
+    const int current_priority = priority(v);
+    if (!order.empty() && current_priority > order.top().first)
+    {
+      order.emplace(current_priority, v);
+      continue;
+    }
+
+    for (const auto& shortcut : shortcuts)
+    {
+      addArc(std::get<0>(shortcut), std::get<1>(shortcut), std::get<2>(shortcut), v);
+      addArc(std::get<1>(shortcut), std::get<0>(shortcut), std::get<2>(shortcut), v);
+    }
+
+    contracted[v] = true;
+    rank[v] = next_rank++;
+    for (const auto& arc : graph[v])
+    {
+      if (!contracted[arc.target])
+        contracted_neighbours[arc.target]++;
+    }
+  }
+
+  // keep only the arcs leading to higher ranked vertices
+  for (uint32_t v = 0; v < n; v++)
+  {
+    up_offsets[v] = up_arcs.size();
+    if (rank[v] == NONE)
+      continue;
+    for (const auto& arc : graph[v])
+    {
+      if (rank[arc.target] > rank[v])
+        up_arcs.push_back(arc);
+    }
+  }
+  up_offsets[n] = up_arcs.size();
+  return true;
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::findArc(const uint32_t a, const uint32_t b) const
+{
+  const uint32_t lower = rank[a] < rank[b] ? a : b;
+  const uint32_t higher = lower == a ? b : a;
+  for (uint32_t i = up_offsets[lower]; i < up_offsets[lower + 1]; i++)
+  {
+    if (up_arcs[i].target == higher)
+      return &up_arcs[i];
+  }
+  return nullptr;
+}
+
+bool ContractionHierarchy::unpack(const uint32_t from, const uint32_t to, std::vector<lvr2::VertexHandle>& path) const
+{
+  const Arc* arc = findArc(from, to);
+  if (!arc)
+    return false;
+
+  if (arc->middle == NONE)
+  {
+    path.push_back(lvr2::VertexHandle(to));
+    return true;
+  }
+  const uint32_t middle = arc->middle;
+  return unpack(from, middle, path) && unpack(middle, to, path);
+}
+
+bool ContractionHierarchy::query(const lvr2::VertexHandle& start, const lvr2::VertexHandle& goal,
+                                 std::vector<lvr2::VertexHandle>& path, float& distance) const
+{
+  path.clear();
+  if (!contains(start) || !contains(goal))
+    return false;
+
+  const uint32_t s = start.idx();
+  const uint32_t t = goal.idx();
+  if (s == t)
+  {
+    path.push_back(start);
+    distance = 0;
+    return true;
+  }
+
+  // distance and parent of the reached vertices for both search directions
+  typedef std::unordered_map<uint32_t, std::pair<float, uint32_t>> SearchSpace;
+  typedef std::pair<float, uint32_t> QueueEntry;
+  typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> Queue;
+
+  SearchSpace spaces[2];
+  Queue queues[2];
+  spaces[0][s] = { 0, NONE };
+  spaces[1][t] = { 0, NONE };
+  queues[0].emplace(0, s);
+  queues[1].emplace(0, t);
+
+  float best = std::numeric_limits<float>::infinity();
+  uint32_t meeting = NONE;
+  size_t direction = 0;
+
+  while (true)
+  {
+    const bool forward_done = queues[0].empty() || queues[0].top().first >= best;
+    const bool backward_done = queues[1].empty() || queues[1].top().first >= best;
+    if (forward_done && backward_done)
+      break;
+
+    direction = forward_done ? 1 : backward_done ? 0 : 1 - direction;
+    auto& space = spaces[direction];
+    const auto& other = spaces[1 - direction];
+    auto& queue = queues[direction];
+
+    const QueueEntry top = queue.top();
+    queue.pop();
+    if (top.first > space[top.second].first)
+      continue;
+
+    const auto other_iter = other.find(top.second);
+    if (other_iter != other.end() && top.first + other_iter->second.first < best)
+    {
+      best = top.first + other_iter->second.first;
+      meeting = top.second;
+    }
+
+    for (uint32_t i = up_offsets[top.second]; i < up_offsets[top.second + 1]; i++)
+    {
+      const Arc& arc = up_arcs[i];
+      const float dist = top.first + arc.weight;
+      auto iter = space.find(arc.target);
+      if (iter == space.end() || dist < iter->second.first)
+      {
+        space[arc.target] = { dist, top.second };
+        queue.emplace(dist, arc.target);
+      }
+    }
+  }
+
+  if (meeting == NONE)
+    return false;
+
+  // upward path from the start to the meeting vertex
+  std::vector<uint32_t> forward_chain;
+  for (uint32_t v = meeting; v != NONE; v = spaces[0].at(v).second)
+    forward_chain.push_back(v);
+
+  // a missing arc, e.g. of a corrupt stored hierarchy, fails the query instead of returning a path with a gap
+  path.push_back(start);
+  bool unpacked = true;
+  for (size_t i = forward_chain.size() - 1; i > 0 && unpacked; i--)
+    unpacked = unpack(forward_chain[i], forward_chain[i - 1], path);
+
+  // downward path from the meeting vertex to the goal
+  for (uint32_t v = meeting; spaces[1].at(v).second != NONE && unpacked; v = spaces[1].at(v).second)
+    unpacked = unpack(v, spaces[1].at(v).second, path);
+
+  if (!unpacked)
+  {
+    path.clear();
+    return false;
+  }
+
+  distance = best;
+  return true;
+}
+
+bool ContractionHierarchy::save(lvr2::AttributeMeshIOBase& io) const
+{
+  lvr2::IndexChannel rank_channel(rank.size(), 1);
+  std::copy(rank.begin(), rank.end(), rank_channel.dataPtr().get());
+
+  lvr2::IndexChannel offsets_channel(up_offsets.size(), 1);
+  std::copy(up_offsets.begin(), up_offsets.end(), offsets_channel.dataPtr().get());
+
+  lvr2::IndexChannel arcs_channel(up_arcs.size(), 2);
+  lvr2::FloatChannel weights_channel(up_arcs.size(), 1);
+  for (size_t i = 0; i < up_arcs.size(); i++)
+  {
+    arcs_channel.dataPtr()[2 * i] = up_arcs[i].target;
+    arcs_channel.dataPtr()[2 * i + 1] = up_arcs[i].middle;
+    weights_channel.dataPtr()[i] = up_arcs[i].weight;
+  }
+
+  // the meta data is written last, thus an incomplete hierarchy is never accepted
+  lvr2::IndexChannel meta_channel(1, 4);
+  meta_channel.dataPtr()[0] = FORMAT_VERSION;
+  meta_channel.dataPtr()[1] = input_fingerprint;
+  meta_channel.dataPtr()[2] = rank.size();
+  meta_channel.dataPtr()[3] = up_arcs.size();
+
+  std::lock_guard<std::mutex> lock(io_mtx);
+  return io.addChannel(CHANNEL_GROUP, "rank", rank_channel) &&
+         io.addChannel(CHANNEL_GROUP, "up_offsets", offsets_channel) &&
+         io.addChannel(CHANNEL_GROUP, "up_arcs", arcs_channel) &&
+         io.addChannel(CHANNEL_GROUP, "up_weights", weights_channel) &&
+         io.addChannel(CHANNEL_GROUP, "meta", meta_channel);
+}
+
+bool ContractionHierarchy::load(lvr2::AttributeMeshIOBase& io, const uint32_t fingerprint)
+{
+  std::lock_guard<std::mutex> lock(io_mtx);
+
+  lvr2::IndexChannelOptional meta_opt;
+  if (!io.getChannel(CHANNEL_GROUP, "meta", meta_opt) || !meta_opt || meta_opt->numElements() != 1 ||
+      meta_opt->width() != 4)
+    return false;
+
+  const auto meta = meta_opt->dataPtr();
+  if (meta[0] != FORMAT_VERSION || meta[1] != fingerprint)
+    return false;
+
+  const size_t n = meta[2];
+  const size_t m = meta[3];
+
+  lvr2::IndexChannelOptional rank_opt, offsets_opt, arcs_opt;
+  lvr2::FloatChannelOptional weights_opt;
+  if (!io.getChannel(CHANNEL_GROUP, "rank", rank_opt) || !io.getChannel(CHANNEL_GROUP, "up_offsets", offsets_opt) ||
+      !io.getChannel(CHANNEL_GROUP, "up_arcs", arcs_opt) || !io.getChannel(CHANNEL_GROUP, "up_weights", weights_opt))
+    return false;
+
+  if (!rank_opt || rank_opt->numElements() != n || rank_opt->width() != 1 || !offsets_opt ||
+      offsets_opt->numElements() != n + 1 || offsets_opt->width() != 1 || !arcs_opt || arcs_opt->numElements() != m || arcs_opt->width() != 2 || !weights_opt ||
+      weights_opt->numElements() != m)
+    return false;
+
+  const auto rank_data = rank_opt->dataPtr();
+  const auto offsets_data = offsets_opt->dataPtr();
+  const auto arcs_data = arcs_opt->dataPtr();
+  const auto weights_data = weights_opt->dataPtr();
+
+  // corrupt data with a matching fingerprint is rejected, since it would be read out of bounds by the queries
+  std::vector<bool> ranked(n, false);
+  for (size_t v = 0; v < n; v++)
+  {
+    if (rank_data[v] == NONE)
+      continue;
+    if (rank_data[v] >= n || ranked[rank_data[v]])
+      return false;
+    ranked[rank_data[v]] = true;
+  }
+  if (offsets_data[0] != 0 || offsets_data[n] != m)
+    return false;
+  for (size_t v = 0; v < n; v++)
+  {
+    if (offsets_data[v] > offsets_data[v + 1] || (rank_data[v] == NONE && offsets_data[v] != offsets_data[v + 1]))
+      return false;
+
+    // the arcs lead upwards and shortcuts bypass lower ranked vertices, thus the unpacking terminates
+    for (size_t i = offsets_data[v]; i < offsets_data[v + 1]; i++)
+    {
+      const uint32_t target = arcs_data[2 * i];
+      const uint32_t middle = arcs_data[2 * i + 1];
+      if (target >= n || rank_data[target] == NONE || rank_data[target] <= rank_data[v] || !(weights_data[i] >= 0))
+        return false;
+      if (middle != NONE && (middle >= n || rank_data[middle] >= rank_data[v]))
+        return false;
+    }
+  }
+
+  rank.assign(rank_data.get(), rank_data.get() + n);
+  up_offsets.assign(offsets_data.get(), offsets_data.get() + n + 1);
+  up_arcs.resize(m);
+  for (size_t i = 0; i < m; i++)
+  {
+    up_arcs[i] = { arcs_data[2 * i], weights_data[i], arcs_data[2 * i + 1] };
+  }
+  input_fingerprint = fingerprint;
+  return true;
+}
+
+}  // namespace dijkstra_mesh_planner
@@ -37,6 +37,7 @@
 
 #include <dijkstra_mesh_planner/dijkstra_mesh_planner.h>
 #include <lvr2/util/Meap.hpp>
+#include <queue>
 #include <mbf_msgs/GetPathResult.h>
 #include <mesh_map/util.h>
 #include <pluginlib/class_list_macros.h>
@@ -46,18 +47,22 @@ PLUGINLIB_EXPORT_CLASS(dijkstra_mesh_planner::DijkstraMeshPlanner, mbf_mesh_core
 namespace dijkstra_mesh_planner
 {
 DijkstraMeshPlanner::DijkstraMeshPlanner()
+  : hierarchy_cost_version(0), hierarchy_cost_limit(0), hierarchy_building(false), hierarchy_cancel(false)
 {
 }
 
 DijkstraMeshPlanner::~DijkstraMeshPlanner()
 {
+  hierarchy_cancel = true;
+  if (hierarchy_thread.joinable())
+    hierarchy_thread.join();
 }
 
 uint32_t DijkstraMeshPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
                                        double tolerance, std::vector<geometry_msgs::PoseStamped>& plan, double& cost,
                                        std::string& message)
 {
-  const auto& mesh = mesh_map->mesh();
+  std::lock_guard<std::mutex> lock(planning_mtx);
   std::list<lvr2::VertexHandle> path;
   ROS_INFO("start dijkstra mesh planner.");
 
@@ -65,7 +70,12 @@ uint32_t DijkstraMeshPlanner::makePlan(const geometry_msgs::PoseStamped& start,
   mesh_map::Vector start_vec = mesh_map::toVector(start.pose.position);
 
   // call dijkstra with the goal pose as seed / start vertex
-  uint32_t outcome = dijkstra(goal_vec, start_vec, path);
+  uint32_t outcome = mbf_msgs::GetPathResult::SUCCESS;
+  const bool hierarchy_query = config.use_contraction_hierarchy && contractionHierarchyQuery(goal_vec, start_vec, path);
+  if (!hierarchy_query)
+  {
+    outcome = dijkstra(goal_vec, start_vec, path);
+  }
 
   path.reverse();
 
@@ -73,42 +83,18 @@ uint32_t DijkstraMeshPlanner::makePlan(const geometry_msgs::PoseStamped& start,
   header.stamp = ros::Time::now();
   header.frame_id = mesh_map->mapFrame();
 
-  cost = 0;
-  if (!path.empty())
-  {
-    mesh_map::Vector& vec = start_vec;
-    const auto& vertex_normals = mesh_map->vertexNormals();
-    mesh_map::Normal normal = vertex_normals[path.front()];
-
-    float dir_length;
-    geometry_msgs::PoseStamped pose;
-    pose.header = header;
-
-    while (!path.empty())
-    {
-      // get next position
-      const lvr2::VertexHandle& vH = path.front();
-      mesh_map::Vector next = mesh.getVertexPosition(vH);
-
-      pose.pose = mesh_map::calculatePoseFromPosition(vec, next, normal, dir_length);
-      cost += dir_length;
-      vec = next;
-      normal = vertex_normals[vH];
-      plan.push_back(pose);
-      path.pop_front();
-    }
-    pose.pose = mesh_map::calculatePoseFromPosition(vec, goal_vec, normal, dir_length);
-    cost += dir_length;
-    plan.push_back(pose);
-  }
+  pathToPlan(path, start_vec, goal_vec, header, plan, cost);
 
-  ROS_INFO_STREAM("Path length: " << cost << "m");
   nav_msgs::Path path_msg;
   path_msg.poses = plan;
   path_msg.header = header;
 
   path_pub.publish(path_msg);
-  mesh_map->publishVertexCosts(potential, "Potential");
+  // the potential of a contraction hierarchy query is only known within the corridor
+  if (!hierarchy_query)
+  {
+    mesh_map->publishVertexCosts(potential, "Potential");
+  }
 
   ROS_INFO_STREAM("Path length: " << cost << "m");
 
@@ -120,6 +106,84 @@ uint32_t DijkstraMeshPlanner::makePlan(const geometry_msgs::PoseStamped& start,
   return outcome;
 }
 
+uint32_t DijkstraMeshPlanner::makePlans(const geometry_msgs::PoseStamped& start,
+                                        const std::vector<geometry_msgs::PoseStamped>& goals, double tolerance,
+                                        std::vector<std::vector<geometry_msgs::PoseStamped>>& plans,
+                                        std::vector<double>& costs, std::vector<uint32_t>& outcomes,
+                                        std::string& message)
+{
+  std::lock_guard<std::mutex> lock(planning_mtx);
+  std::vector<std::list<lvr2::VertexHandle>> paths;
+  ROS_INFO_STREAM("start dijkstra mesh planner for " << goals.size() << " goals.");
+
+  mesh_map::Vector start_vec = mesh_map::toVector(start.pose.position);
+  std::vector<mesh_map::Vector> goal_vecs;
+  goal_vecs.reserve(goals.size());
+  for (const auto& goal : goals)
+  {
+    goal_vecs.push_back(mesh_map::toVector(goal.pose.position));
+  }
+
+  // call dijkstra with the start pose as seed, the paths are then ordered from the start to the goals
+  uint32_t outcome = dijkstra(start_vec, goal_vecs, mesh_map->edgeDistances(), mesh_map->vertexCosts(), paths,
+                              outcomes, potential, predecessors);
+
+  std_msgs::Header header;
+  header.stamp = ros::Time::now();
+  header.frame_id = mesh_map->mapFrame();
+
+  plans.assign(goals.size(), std::vector<geometry_msgs::PoseStamped>());
+  costs.assign(goals.size(), 0);
+  for (size_t i = 0; i < goals.size(); i++)
+  {
+    if (outcomes[i] == mbf_msgs::GetPathResult::SUCCESS)
+    {
+      pathToPlan(paths[i], start_vec, goal_vecs[i], header, plans[i], costs[i]);
+      ROS_INFO_STREAM("Path length to goal " << i << ": " << costs[i] << "m");
+    }
+  }
+
+  if (publish_vector_field)
+  {
+    mesh_map->publishVectorField("vector_field", vector_map, publish_face_vectors);
+  }
+
+  return outcome;
+}
+
+void DijkstraMeshPlanner::pathToPlan(const std::list<lvr2::VertexHandle>& path, const mesh_map::Vector& start,
+                                     const mesh_map::Vector& goal, const std_msgs::Header& header,
+                                     std::vector<geometry_msgs::PoseStamped>& plan, double& cost)
+{
+  cost = 0;
+  if (path.empty())
+    return;
+
+  const auto& mesh = mesh_map->mesh();
+  const auto& vertex_normals = mesh_map->vertexNormals();
+  mesh_map::Vector vec = start;
+  mesh_map::Normal normal = vertex_normals[path.front()];
+
+  float dir_length;
+  geometry_msgs::PoseStamped pose;
+  pose.header = header;
+
+  for (const lvr2::VertexHandle& vH : path)
+  {
+    // get next position
+    mesh_map::Vector next = mesh.getVertexPosition(vH);
+
+    pose.pose = mesh_map::calculatePoseFromPosition(vec, next, normal, dir_length);
+    cost += dir_length;
+    vec = next;
+    normal = vertex_normals[vH];
+    plan.push_back(pose);
+  }
+  pose.pose = mesh_map::calculatePoseFromPosition(vec, goal, normal, dir_length);
+  cost += dir_length;
+  plan.push_back(pose);
+}
+
 bool DijkstraMeshPlanner::cancel()
 {
   cancel_planning = true;
@@ -187,7 +251,190 @@ void DijkstraMeshPlanner::computeVectorMap()
     // store the normalized rotated vector in the vector map
     vector_map.insert(v3, dirVec.normalized());
   }
+}
+
+bool DijkstraMeshPlanner::contractionHierarchyQuery(const mesh_map::Vector& start, const mesh_map::Vector& goal,
+                                                    std::list<lvr2::VertexHandle>& path)
+{
+  const uint64_t cost_version = mesh_map->costVersion();
+  ContractionHierarchy::Ptr hierarchy;
+  {
+    std::lock_guard<std::mutex> lock(hierarchy_mtx);
+    if (contraction_hierarchy && hierarchy_cost_version == cost_version &&
+        hierarchy_cost_limit == static_cast<float>(config.cost_limit))
+    {
+      hierarchy = contraction_hierarchy;
+    }
+  }
+
+  if (!hierarchy)
+  {
+    ROS_INFO_STREAM("No contraction hierarchy available for the current costs, using the normal search.");
+    updateContractionHierarchy(cost_version);
+    return false;
+  }
+
+  const auto& start_opt = mesh_map->getNearestVertexHandle(start);
+  const auto& goal_opt = mesh_map->getNearestVertexHandle(goal);
+  if (!start_opt || !goal_opt)
+    return false;
+
+  ros::WallTime t_query_start = ros::WallTime::now();
+
+  // the hierarchy is queried from the robot to the seed, the vector field has to point towards the seed
+  std::vector<lvr2::VertexHandle> vertices;
+  float distance;
+  if (!hierarchy->query(goal_opt.unwrap(), start_opt.unwrap(), vertices, distance))
+    return false;
+
+  ros::WallTime t_query_end = ros::WallTime::now();
+
+  const auto& mesh = mesh_map->mesh();
+  const auto& edge_distances = mesh_map->edgeDistances();
+  const auto& vertex_costs = mesh_map->vertexCosts();
+
+  // keep the order of dijkstra(), i.e. from the seed to the robot without the robot's vertex itself
+  path.clear();
+  for (auto iter = vertices.rbegin(); iter + 1 != vertices.rend(); ++iter)
+  {
+    path.push_back(*iter);
+  }
+
+  vector_map.clear();
+  potential.clear();
+  predecessors.clear();
+
+  typedef std::pair<float, lvr2::Index> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> pq;
+  lvr2::DenseVertexMap<float> corridor_dist;
+
+  // the path vertices point along the path towards the seed
+  float remaining = distance;
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    const lvr2::VertexHandle& vH = vertices[i];
+    const lvr2::VertexHandle& next = i + 1 < vertices.size() ? vertices[i + 1] : vH;
+    predecessors.insert(vH, next);
+    potential.insert(vH, std::max(remaining, 0.0f));
+    if (next != vH)
+      remaining -= edge_distances[mesh.getEdgeBetween(vH, next).unwrap()];
+    corridor_dist.insert(vH, 0);
+    pq.emplace(0, vH.idx());
+  }
+
+  // the vertices around the path point towards the path
+  std::vector<lvr2::EdgeHandle> edges;
+  while (!pq.empty())
+  {
+    const QueueEntry top = pq.top();
+    pq.pop();
+    const lvr2::VertexHandle vH(top.second);
+    if (top.first > corridor_dist[vH])
+      continue;
+
+    edges.clear();
+    try
+    {
+      mesh.getEdgesOfVertex(vH, edges);
+    }
+    catch (lvr2::PanicException exception)
+    {
+      continue;
+    }
+    catch (lvr2::VertexLoopException exception)
+    {
+      continue;
+    }
+
+    for (auto eH : edges)
+    {
+      const auto edge_vertices = mesh.getVerticesOfEdge(eH);
+      const lvr2::VertexHandle& nH = edge_vertices[0] == vH ? edge_vertices[1] : edge_vertices[0];
+      if (vertex_costs[nH] > config.cost_limit || mesh_map->invalid[nH])
+        continue;
+
+      const float dist = top.first + edge_distances[eH];
+      const auto nH_dist = corridor_dist.get(nH);
+      if (dist > config.corridor_radius || (nH_dist && *nH_dist <= dist))
+        continue;
+
+      corridor_dist.insert(nH, dist);
+      predecessors.insert(nH, vH);
+      potential.insert(nH, potential[vH] + edge_distances[eH]);
+      pq.emplace(dist, nH.idx());
+    }
+  }
+
+  for (auto vH : predecessors)
+  {
+    const lvr2::VertexHandle& pred = predecessors[vH];
+    if (pred != vH)
+      vector_map.insert(vH, (mesh.getVertexPosition(pred) - mesh.getVertexPosition(vH)).normalized());
+  }
   mesh_map->setVectorMap(vector_map);
+
+  ros::WallTime t_corridor_end = ros::WallTime::now();
+  ROS_INFO_STREAM("Contraction hierarchy query (ms): " << (t_query_end - t_query_start).toNSec() * 1e-6);
+  ROS_INFO_STREAM("Corridor vector field computation (ms): " << (t_corridor_end - t_query_end).toNSec() * 1e-6);
+  return true;
+}
+
+void DijkstraMeshPlanner::updateContractionHierarchy(const uint64_t cost_version)
+{
+  if (hierarchy_building)
+    return;
+  if (hierarchy_thread.joinable())
+    hierarchy_thread.join();
+
+  const auto& mesh = mesh_map->mesh();
+  const auto& vertex_costs = mesh_map->vertexCosts();
+  const float cost_limit = config.cost_limit;
+
+  lvr2::DenseVertexMap<bool> passable(mesh.nextVertexIndex(), false);
+  for (auto vH : mesh.vertices())
+  {
+    passable[vH] = !mesh_map->invalid[vH] && vertex_costs[vH] <= cost_limit;
+  }
+  const uint32_t fingerprint = ContractionHierarchy::computeFingerprint(mesh, mesh_map->edgeDistances(), passable);
+
+  // a hierarchy which has been built for the same input is reused from the map
+  auto hierarchy = std::make_shared<ContractionHierarchy>();
+  if (hierarchy->load(*mesh_map->mesh_io_ptr, fingerprint))
+  {
+    ROS_INFO_STREAM("Loaded the contraction hierarchy from the map.");
+    std::lock_guard<std::mutex> lock(hierarchy_mtx);
+    contraction_hierarchy = hierarchy;
+    hierarchy_cost_version = cost_version;
+    hierarchy_cost_limit = cost_limit;
+    return;
+  }
+
+  ROS_INFO_STREAM("Start building the contraction hierarchy in the background.");
+  hierarchy_building = true;
+  // the thread keeps the mesh io alive, its channel writes are serialised with the layers by the map's LockedMeshIO
+  const std::shared_ptr<lvr2::AttributeMeshIOBase> mesh_io = mesh_map->mesh_io_ptr;
+  hierarchy_thread = std::thread([this, hierarchy, passable, cost_version, cost_limit, mesh_io]() {
+    ros::WallTime t_build_start = ros::WallTime::now();
+    if (!hierarchy->build(mesh_map->mesh(), mesh_map->edgeDistances(), passable, hierarchy_cancel))
+    {
+      hierarchy_building = false;
+      return;
+    }
+    ROS_INFO_STREAM("Built the contraction hierarchy (ms): " << (ros::WallTime::now() - t_build_start).toNSec() * 1e-6);
+
+    if (!hierarchy->save(*mesh_io))
+    {
+      ROS_WARN_STREAM("Could not store the contraction hierarchy with the map.");
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(hierarchy_mtx);
+      contraction_hierarchy = hierarchy;
+      hierarchy_cost_version = cost_version;
+      hierarchy_cost_limit = cost_limit;
+    }
+    hierarchy_building = false;
+  });
 }
 
 uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& start, const mesh_map::Vector& goal,
@@ -201,39 +448,113 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
                                        const lvr2::DenseVertexMap<float>& costs, std::list<lvr2::VertexHandle>& path,
                                        lvr2::DenseVertexMap<float>& distances,
                                        lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors)
+{
+  std::vector<std::list<lvr2::VertexHandle>> paths;
+  std::vector<uint32_t> outcomes;
+
+  const uint32_t outcome =
+      dijkstra(original_start, { original_goal }, edge_weights, costs, paths, outcomes, distances, predecessors);
+  path.clear();
+  if (!paths.empty())
+  {
+    path.swap(paths.front());
+  }
+
+  // the backtracked path leads from the seed to the goal vertex without the seed, whereas the single goal path keeps
+  // the seed vertex and ends before the goal vertex, i.e. before the robot's vertex in makePlan()
+  if (!path.empty())
+  {
+    path.push_front(predecessors[path.front()]);
+    path.pop_back();
+  }
+
+  // share the vector field with the controller
+  if (outcome == mbf_msgs::GetPathResult::SUCCESS && !path.empty())
+  {
+    mesh_map->setVectorMap(vector_map);
+  }
+  return outcome;
+}
+
+uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start,
+                                       const std::vector<mesh_map::Vector>& original_goals,
+                                       const lvr2::DenseEdgeMap<float>& edge_weights,
+                                       const lvr2::DenseVertexMap<float>& costs,
+                                       std::vector<std::list<lvr2::VertexHandle>>& paths,
+                                       std::vector<uint32_t>& outcomes, lvr2::DenseVertexMap<float>& distances,
+                                       lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors)
 {
   ROS_INFO_STREAM("Init wave front propagation.");
   ros::WallTime t_initialization_start = ros::WallTime::now();
 
   const auto& mesh = mesh_map->mesh();
-  const auto& vertex_costs = mesh_map->vertexCosts();
 
   auto& invalid = mesh_map->invalid;
 
+  paths.assign(original_goals.size(), std::list<lvr2::VertexHandle>());
+  outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::NO_PATH_FOUND);
+
   mesh_map->publishDebugPoint(original_start, mesh_map::color(0, 1, 0), "start_point");
-  mesh_map->publishDebugPoint(original_goal, mesh_map::color(0, 0, 1), "goal_point");
 
-  // Find the closest vertex handle of start and goal
+  // Find the closest vertex handle of the start
   const auto& start_opt = mesh_map->getNearestVertexHandle(original_start);
-  const auto& goal_opt = mesh_map->getNearestVertexHandle(original_goal);
   // reset cancel planning
   cancel_planning = false;
 
   if (!start_opt)
+  {
+    outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::INVALID_START);
     return mbf_msgs::GetPathResult::INVALID_START;
-  if (!goal_opt)
+  }
+  if (original_goals.empty())
     return mbf_msgs::GetPathResult::INVALID_GOAL;
 
   const auto& start_vertex = start_opt.unwrap();
-  const auto& goal_vertex = goal_opt.unwrap();
 
-  path.clear();
   distances.clear();
   predecessors.clear();
 
-  if (goal_vertex == start_vertex)
+  // Find the closest vertex handles of the goals, the goals which are left have to be reached by the search
+  std::vector<lvr2::VertexHandle> goal_vertices(original_goals.size(), start_vertex);
+  lvr2::DenseVertexMap<bool> is_goal_vertex(mesh.nextVertexIndex(), false);
+  size_t open_goals_cnt = 0;
+  for (size_t i = 0; i < original_goals.size(); i++)
+  {
+    if (mesh_map->debugEnabled())
+      mesh_map->publishDebugPoint(original_goals[i], mesh_map::color(0, 0, 1), "goal_point_" + std::to_string(i));
+    const auto& goal_opt = mesh_map->getNearestVertexHandle(original_goals[i]);
+    if (!goal_opt)
+    {
+      outcomes[i] = mbf_msgs::GetPathResult::INVALID_GOAL;
+      continue;
+    }
+    goal_vertices[i] = goal_opt.unwrap();
+    if (goal_vertices[i] == start_vertex)
+    {
+      outcomes[i] = mbf_msgs::GetPathResult::SUCCESS;
+      continue;
+    }
+    if (!is_goal_vertex[goal_vertices[i]])
+    {
+      is_goal_vertex[goal_vertices[i]] = true;
+      open_goals_cnt++;
+    }
+  }
+
+  auto aggregatedOutcome = [&outcomes]() {
+    uint32_t outcome = mbf_msgs::GetPathResult::NO_PATH_FOUND;
+    for (auto goal_outcome : outcomes)
+    {
+      if (goal_outcome == mbf_msgs::GetPathResult::SUCCESS)
+        return goal_outcome;
+      outcome = goal_outcome;
+    }
+    return outcome;
+  };
+
+  if (open_goals_cnt == 0)
   {
-    return mbf_msgs::GetPathResult::SUCCESS;
+    return aggregatedOutcome();
   }
 
   lvr2::DenseVertexMap<bool> fixed(mesh.nextVertexIndex(), false);
@@ -260,6 +581,7 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
   pq.insert(start_vertex, 0);
 
   float goal_dist = std::numeric_limits<float>::infinity();
+  size_t reached_cnt = 0;
 
   ROS_INFO_STREAM("Start Dijkstra");
   ros::WallTime t_propagation_start = ros::WallTime::now();
@@ -273,16 +595,17 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
     fixed[current_vh] = true;
     fixed_set_cnt++;
 
-    if (current_vh == goal_vertex)
+    // the search stops as soon as the last goal vertex has been fixed
+    if (is_goal_vertex[current_vh] && ++reached_cnt == open_goals_cnt)
     {
-      ROS_INFO_STREAM("The Dijkstra Mesh Planner reached the goal.");
+      ROS_INFO_STREAM("The Dijkstra Mesh Planner reached all goals.");
       goal_dist = distances[current_vh] + goal_dist_offset;
     }
 
     if (distances[current_vh] > goal_dist)
       continue;
 
-    if (vertex_costs[current_vh] > config.cost_limit)
+    if (costs[current_vh] > config.cost_limit)
       continue;
 
     std::vector<lvr2::EdgeHandle> edges;
@@ -333,27 +656,36 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
   if (cancel_planning)
   {
     ROS_WARN_STREAM("Wave front propagation has been canceled!");
+    outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::CANCELED);
     return mbf_msgs::GetPathResult::CANCELED;
   }
 
   ROS_INFO_STREAM("The Dijkstra Mesh Planner finished the propagation.");
 
-  if (goal_vertex == predecessors[goal_vertex])
-  {
-    ROS_WARN("Predecessor of the goal is not set! No path found!");
-    return mbf_msgs::GetPathResult::NO_PATH_FOUND;
-  }
-
   ros::WallTime t_propagation_end = ros::WallTime::now();
   double propagation_duration = (t_propagation_end - t_propagation_start).toNSec() * 1e-6;
 
-  auto vH = goal_vertex;
-
-  while (vH != start_vertex && !cancel_planning)
+  for (size_t i = 0; i < original_goals.size() && !cancel_planning; i++)
   {
-    vH = predecessors[vH];
-    path.push_front(vH);
-  };
+    const auto& goal_vertex = goal_vertices[i];
+    if (outcomes[i] != mbf_msgs::GetPathResult::NO_PATH_FOUND)
+      continue;
+
+    if (goal_vertex == predecessors[goal_vertex])
+    {
+      ROS_WARN_STREAM("Predecessor of the goal " << i << " is not set! No path found!");
+      continue;
+    }
+
+    auto& path = paths[i];
+    auto vH = goal_vertex;
+    while (vH != start_vertex && !cancel_planning)
+    {
+      path.push_front(vH);
+      vH = predecessors[vH];
+    }
+    outcomes[i] = mbf_msgs::GetPathResult::SUCCESS;
+  }
 
   t_end = ros::WallTime::now();
   double execution_time = (t_end - t_start).toNSec() * 1e-6;
@@ -365,6 +697,7 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
   if (cancel_planning)
   {
     ROS_WARN_STREAM("Dijkstra has been canceled!");
+    outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::CANCELED);
     return mbf_msgs::GetPathResult::CANCELED;
   }
 
@@ -377,7 +710,7 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
   ROS_INFO_STREAM("Path backtracking duration (ms): " << path_backtracking_duration);
 
   ROS_INFO_STREAM("Successfully finished Dijkstra back tracking!");
-  return mbf_msgs::GetPathResult::SUCCESS;
+  return aggregatedOutcome();
 }
 
 } /* namespace dijkstra_mesh_planner */
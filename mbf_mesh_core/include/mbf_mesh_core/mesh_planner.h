@@ -40,6 +40,7 @@
 #include <boost/shared_ptr.hpp>
 #include <geometry_msgs/PoseStamped.h>
 #include <mbf_abstract_core/abstract_planner.h>
+#include <mbf_msgs/GetPathResult.h>
 #include <mesh_map/mesh_map.h>
 #include <stdint.h>
 #include <string>
@@ -72,6 +73,42 @@ public:
                             double tolerance, std::vector<geometry_msgs::PoseStamped>& plan, double& cost,
                             std::string& message) = 0;
 
+  /**
+   * @brief Given multiple goal poses in the world, compute a plan from the start pose to each of the goals.
+   * Planners which propagate from a single seed can answer all goals within one propagation. The default
+   * implementation calls makePlan for every goal.
+   * @param start The start pose
+   * @param goals The goal poses
+   * @param tolerance If a goal is obstructed, how many meters the planner can
+   * relax the constraint in x and y before failing
+   * @param plans The plans, one for each goal
+   * @param costs The costs of the plans, one for each goal
+   * @param outcomes The result codes for each goal as described on GetPath action result.
+   * @param message Optional more detailed outcome as a string
+   * @return SUCCESS if a plan to at least one of the goals has been found, otherwise the last error result code.
+   */
+  virtual uint32_t makePlans(const geometry_msgs::PoseStamped& start,
+                             const std::vector<geometry_msgs::PoseStamped>& goals, double tolerance,
+                             std::vector<std::vector<geometry_msgs::PoseStamped>>& plans, std::vector<double>& costs,
+                             std::vector<uint32_t>& outcomes, std::string& message)
+  {
+    plans.assign(goals.size(), std::vector<geometry_msgs::PoseStamped>());
+    costs.assign(goals.size(), 0);
+    outcomes.assign(goals.size(), mbf_msgs::GetPathResult::FAILURE);
+
+    uint32_t outcome = goals.empty() ? mbf_msgs::GetPathResult::INVALID_GOAL : mbf_msgs::GetPathResult::FAILURE;
+    bool any_success = false;
+    for (size_t i = 0; i < goals.size(); i++)
+    {
+      outcomes[i] = makePlan(start, goals[i], tolerance, plans[i], costs[i], message);
+      if (outcomes[i] == mbf_msgs::GetPathResult::SUCCESS)
+        any_success = true;
+      else
+        outcome = outcomes[i];
+    }
+    return any_success ? mbf_msgs::GetPathResult::SUCCESS : outcome;
+  }
+
   /**
    * @brief Requests the planner to cancel, e.g. if it takes too much time.
    * @return True if a cancel has been successfully requested, false if not
@@ -44,6 +44,7 @@
 #include "mesh_planner_execution.h"
 #include "mesh_recovery_execution.h"
 
+#include <mbf_mesh_nav/MakePlans.h>
 #include <mbf_mesh_nav/MoveBaseFlexConfig.h>
 #include <mbf_msgs/CheckPath.h>
 #include <mbf_msgs/CheckPose.h>
@@ -161,7 +162,9 @@ private:
                                         const mbf_abstract_core::AbstractRecovery::Ptr& behavior_ptr);
 
   /**
-   * @brief Callback method for the check_pose_cost service
+   * @brief Callback method for the check_pose_cost service. Locates the triangle of the pose within the maximum
+   * distance "check_pose_max_dist" and interpolates the combined costs at the pose. Free poses report the cost in
+   * hundredths, lethal and unknown poses report the respective cost multiplier, poses off the mesh are outside.
    * @param request Request object, see the mbf_msgs/CheckPose service
    * definition file.
    * @param response Response object, see the mbf_msgs/CheckPose service
@@ -188,6 +191,16 @@ private:
    */
   bool callServiceClearMesh(std_srvs::Empty::Request& request, std_srvs::Empty::Response& response);
 
+  /**
+   * @brief Callback method for the make_plans service, which computes plans to multiple goals with one planner run
+   * @param request Request object, see the mbf_mesh_nav/MakePlans service
+   * definition file.
+   * @param response Response object, see the mbf_mesh_nav/MakePlans service
+   * definition file.
+   * @return true, if the service completed successfully, false otherwise
+   */
+  bool callServiceMakePlans(mbf_mesh_nav::MakePlans::Request& request, mbf_mesh_nav::MakePlans::Response& response);
+
   /**
    * @brief Reconfiguration method called by dynamic reconfigure.
    * @param config Configuration parameters. See the MoveBaseFlexConfig
@@ -226,9 +239,15 @@ private:
   //! Service Server for the check_pose_cost service
   ros::ServiceServer check_pose_cost_srv_;
 
+  //! maximum distance of a checked pose to the mesh surface
+  double check_pose_max_dist_;
+
   //! Service Server for the check_path_cost service
   ros::ServiceServer check_path_cost_srv_;
 
+  //! Service Server for the make_plans service
+  ros::ServiceServer make_plans_srv_;
+
   //! Start/stop meshs mutex; concurrent calls to start can lead to segfault
   boost::mutex check_meshs_mutex_;
 };
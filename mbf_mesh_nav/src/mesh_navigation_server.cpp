@@ -35,8 +35,10 @@
  *
  */
 
+#include <cmath>
 #include <geometry_msgs/PoseArray.h>
 #include <mbf_abstract_nav/MoveBaseFlexConfig.h>
+#include <mbf_msgs/GetPathResult.h>
 #include <mesh_map/mesh_map.h>
 #include <nav_msgs/Path.h>
 
@@ -52,12 +54,15 @@ MeshNavigationServer::MeshNavigationServer(const TFPtr& tf_listener_ptr)
   , mesh_ptr_(new mesh_map::MeshMap(*tf_listener_ptr_))
   , setup_reconfigure_(false)
 {
+  private_nh_.param("check_pose_max_dist", check_pose_max_dist_, 0.4);
+
   // advertise services and current goal topic
   check_pose_cost_srv_ =
       private_nh_.advertiseService("check_pose_cost", &MeshNavigationServer::callServiceCheckPoseCost, this);
   check_path_cost_srv_ =
       private_nh_.advertiseService("check_path_cost", &MeshNavigationServer::callServiceCheckPathCost, this);
   clear_mesh_srv_ = private_nh_.advertiseService("clear_mesh", &MeshNavigationServer::callServiceClearMesh, this);
+  make_plans_srv_ = private_nh_.advertiseService("make_plans", &MeshNavigationServer::callServiceMakePlans, this);
 
   // dynamic reconfigure server for mbf_mesh_nav configuration; also include
   // abstract server parameters
@@ -267,8 +272,47 @@ void MeshNavigationServer::reconfigure(mbf_mesh_nav::MoveBaseFlexConfig& config,
 bool MeshNavigationServer::callServiceCheckPoseCost(mbf_msgs::CheckPose::Request& request,
                                                     mbf_msgs::CheckPose::Response& response)
 {
-  // TODO implement
-  return false;
+  if (request.current_pose)
+  {
+    ROS_WARN_STREAM("Checking the current robot pose is not supported, the pose has to be given!");
+    return false;
+  }
+
+  const std::string& map_frame = mesh_ptr_->mapFrame();
+  if (!request.pose.header.frame_id.empty() && request.pose.header.frame_id != map_frame)
+  {
+    ROS_WARN_STREAM("The pose has to be given in the map frame \"" << map_frame << "\"!");
+    return false;
+  }
+
+  const auto& position = request.pose.pose.position;
+  auto located = mesh_ptr_->locateFace(position.x, position.y, position.z, check_pose_max_dist_);
+  if (!located)
+  {
+    response.state = mbf_msgs::CheckPose::Response::OUTSIDE;
+    response.cost = 0;
+    return true;
+  }
+
+  // the combined cost is interpolated at the position, lethal vertices have infinite costs
+  const auto& vertices = mesh_ptr_->mesh().getVerticesOfFace(std::get<0>(*located));
+  const float cost = mesh_ptr_->costAtPosition(vertices, std::get<1>(*located));
+  if (std::isnan(cost))
+  {
+    response.state = mbf_msgs::CheckPose::Response::UNKNOWN;
+    response.cost = request.unknown_cost_mult;
+  }
+  else if (std::isinf(cost))
+  {
+    response.state = mbf_msgs::CheckPose::Response::LETHAL;
+    response.cost = request.lethal_cost_mult;
+  }
+  else
+  {
+    response.state = mbf_msgs::CheckPose::Response::FREE;
+    response.cost = static_cast<uint32_t>(std::lround(std::max(0.0f, cost) * 100));
+  }
+  return true;
 }
 
 bool MeshNavigationServer::callServiceCheckPathCost(mbf_msgs::CheckPath::Request& request,
@@ -284,4 +328,74 @@ bool MeshNavigationServer::callServiceClearMesh(std_srvs::Empty::Request& reques
   return true;
 }
 
+bool MeshNavigationServer::callServiceMakePlans(mbf_mesh_nav::MakePlans::Request& request,
+                                                mbf_mesh_nav::MakePlans::Response& response)
+{
+  const std::vector<std::string> planner_names = planner_plugin_manager_.getLoadedNames();
+  if (planner_names.empty())
+  {
+    response.outcome = mbf_msgs::GetPathResult::INVALID_PLUGIN;
+    response.message = "No planner plugin has been loaded!";
+    ROS_WARN_STREAM(response.message);
+    return true;
+  }
+
+  const std::string planner_name = request.planner.empty() ? planner_names.front() : request.planner;
+  mbf_mesh_core::MeshPlanner::Ptr planner_ptr =
+      boost::static_pointer_cast<mbf_mesh_core::MeshPlanner>(planner_plugin_manager_.getPlugin(planner_name));
+  if (!planner_ptr)
+  {
+    response.outcome = mbf_msgs::GetPathResult::INVALID_PLUGIN;
+    response.message = "No planner plugin with the name \"" + planner_name + "\" has been loaded!";
+    ROS_WARN_STREAM(response.message);
+    return true;
+  }
+
+  const std::string& map_frame = mesh_ptr_->mapFrame();
+  if (!request.start.header.frame_id.empty() && request.start.header.frame_id != map_frame)
+  {
+    response.outcome = mbf_msgs::GetPathResult::INVALID_START;
+    response.message = "The start pose has to be given in the map frame \"" + map_frame + "\"!";
+    ROS_WARN_STREAM(response.message);
+    return true;
+  }
+
+  // goals in other frames are rejected individually, the others are planned together
+  std::vector<geometry_msgs::PoseStamped> goals;
+  std::vector<size_t> goal_indices;
+  response.outcomes.assign(request.goals.size(), mbf_msgs::GetPathResult::INVALID_GOAL);
+  response.costs.assign(request.goals.size(), 0);
+  response.paths.resize(request.goals.size());
+  for (size_t i = 0; i < request.goals.size(); i++)
+  {
+    const auto& goal = request.goals[i];
+    if (!goal.header.frame_id.empty() && goal.header.frame_id != map_frame)
+    {
+      ROS_WARN_STREAM("The goal " << i << " is not given in the map frame \"" << map_frame << "\"!");
+      continue;
+    }
+    goals.push_back(goal);
+    goal_indices.push_back(i);
+  }
+
+  std::vector<std::vector<geometry_msgs::PoseStamped>> plans;
+  std::vector<double> costs;
+  std::vector<uint32_t> outcomes;
+  response.outcome = planner_ptr->makePlans(request.start, goals, request.tolerance, plans, costs, outcomes,
+                                            response.message);
+
+  std_msgs::Header header;
+  header.stamp = ros::Time::now();
+  header.frame_id = map_frame;
+  for (size_t i = 0; i < goal_indices.size() && i < outcomes.size(); i++)
+  {
+    const size_t index = goal_indices[i];
+    response.outcomes[index] = outcomes[i];
+    response.costs[index] = costs[i];
+    response.paths[index].header = header;
+    response.paths[index].poses = plans[i];
+  }
+  return true;
+}
+
 } /* namespace mbf_mesh_nav */
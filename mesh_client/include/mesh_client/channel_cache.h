@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_CLIENT__CHANNEL_CACHE_H_
+#define MESH_CLIENT__CHANNEL_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace mesh_client
+{
+/**
+ * @brief A persistent on-disk cache for received channels. Each entry is stored with the ETag the server answered
+ * with, thus it can be validated with a conditional request. Valid entries are memory mapped instead of being read.
+ */
+class ChannelCache
+{
+public:
+  /**
+   * @brief A memory mapped cache entry, the mapping is released when the last copy of the mapping pointer is destroyed
+   */
+  struct Entry
+  {
+    char type;
+    uint64_t size;
+    uint64_t width;
+    void* data;
+    size_t data_size;
+    std::shared_ptr<void> mapping;
+  };
+
+  /**
+   * @brief Constructs a cache in the given directory, the directory is created if it does not exist
+   * @param directory The cache directory
+   */
+  explicit ChannelCache(const std::string& directory);
+
+  /**
+   * @brief Computes the cache key for a request, the description has to contain everything which defines the result
+   * @param request_description e.g. the server url and the request body
+   * @return A hex string which is used as file name
+   */
+  static std::string key(const std::string& request_description);
+
+  /**
+   * @brief Reads the ETag of the cached entry
+   * @param key The cache key
+   * @param etag The stored ETag
+   * @return true if an entry exists for the key
+   */
+  bool etag(const std::string& key, std::string& etag) const;
+
+  /**
+   * @brief Maps the cached entry into memory, the mapping is private, thus the data can be modified
+   * @param key The cache key
+   * @param entry The mapped entry
+   * @return true if the entry has been mapped successfully
+   */
+  bool load(const std::string& key, Entry& entry) const;
+
+  /**
+   * @brief Stores a received channel, the entry is written to a temporary file and moved into place afterwards
+   * @param key The cache key
+   * @param etag The ETag the server answered with
+   * @param type The channel's type
+   * @param size The number of elements
+   * @param width The number of values per element
+   * @param data The channel's data
+   * @param data_size The size of the data in bytes
+   * @return true if the entry has been stored successfully
+   */
+  bool store(const std::string& key, const std::string& etag, const char type, const uint64_t size,
+             const uint64_t width, const char* data, const size_t data_size) const;
+
+private:
+  //! the entries' data starts at this offset, thus it is aligned in the mapped memory
+  static constexpr size_t DATA_OFFSET = 32;
+
+  /**
+   * @brief Returns the path of the cache file with the given extension
+   */
+  std::string path(const std::string& key, const std::string& extension) const;
+
+  //! the cache directory
+  std::string directory_;
+};
+
+}  // namespace mesh_client
+
+#endif  // MESH_CLIENT__CHANNEL_CACHE_H_
@@ -0,0 +1,179 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_CLIENT__CHANNEL_CODEC_H_
+#define MESH_CLIENT__CHANNEL_CODEC_H_
+
+#include <array>
+#include <cstdint>
+#include <lvr2/io/AttributeMeshIOBase.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mesh_client
+{
+/**
+ * @brief Payload types of the compact channel encodings, the raw types are defined by MeshClient::Type.
+ * Each payload starts with the 17 byte header: one byte type, eight bytes number of elements and eight bytes width.
+ */
+enum Encoding : char
+{
+  //! per component minimum and scale as floats, followed by one uint16 per value
+  QUANTIZED_16 = 3,
+  //! zigzag coded deltas of consecutive values as LEB128 varints
+  DELTA_VARINT = 4,
+  //! per component minimum and scale as floats, followed by one uint8 per value
+  QUANTIZED_8 = 5
+};
+
+//! set in the payload type if the data following the header is a zstd frame
+const char COMPRESSED_FLAG = 0x40;
+
+/**
+ * @brief Returns true if the payload type is one of the compact encodings, possibly compressed
+ */
+bool isEncoded(const char type);
+
+/**
+ * @brief Returns true if zstd compressed payloads can be decoded
+ */
+bool compressionSupported();
+
+/**
+ * @brief Decodes a compact channel payload while it is received, the values are written directly into the channel
+ * buffer. Compressed payloads are decompressed in a streaming fashion.
+ */
+class ChannelDecoder
+{
+public:
+  /**
+   * @brief Constructs a decoder for float values, used for the quantized encodings
+   * @param type The payload type
+   * @param size The number of elements
+   * @param width The number of values per element
+   * @param output The destination buffer with size * width values
+   */
+  ChannelDecoder(const char type, const uint64_t size, const uint64_t width, float* output);
+
+  /**
+   * @brief Constructs a decoder for index values, used for the delta varint encoding
+   * @param type The payload type
+   * @param size The number of elements
+   * @param width The number of values per element
+   * @param output The destination buffer with size * width values
+   */
+  ChannelDecoder(const char type, const uint64_t size, const uint64_t width, lvr2::Index* output);
+
+  ~ChannelDecoder();
+
+  /**
+   * @brief Decodes the next part of the payload following the header
+   * @return false if the payload is malformed, e.g. it contains more values than announced
+   */
+  bool consume(const char* data, const size_t length);
+
+  /**
+   * @brief Returns true if all values have been decoded
+   */
+  bool finished() const
+  {
+    return decoded == count;
+  }
+
+private:
+  /**
+   * @brief Decodes uncompressed payload data
+   */
+  bool consumePlain(const char* data, const size_t length);
+
+  const char encoding;
+  const bool compressed;
+  const uint64_t width;
+  const uint64_t count;
+
+  float* float_output;
+  lvr2::Index* index_output;
+  uint64_t decoded;
+
+  //! the quantization parameters, minimum and scale per component
+  std::vector<char> parameters;
+  size_t parameters_received;
+
+  //! bytes of a value which has been split between two chunks
+  std::array<unsigned char, 2> partial;
+  size_t partial_received;
+
+  //! varint decoding state
+  uint64_t varint;
+  unsigned int varint_shift;
+  int64_t previous;
+
+  //! streaming decompression state
+  struct Decompressor;
+  std::unique_ptr<Decompressor> decompressor;
+};
+
+/**
+ * @brief Encodes float channel values quantized to 8 or 16 bit per value, relative to the per component value range
+ * of the finite values. The three top codes are reserved for +inf, -inf and NaN, which are restored exactly.
+ * @param values The values, size * width
+ * @param size The number of elements
+ * @param width The number of values per element
+ * @param encoding QUANTIZED_16 or QUANTIZED_8
+ * @return The payload including the header
+ */
+std::string encodeQuantized(const float* values, const uint64_t size, const uint64_t width, const Encoding encoding);
+
+/**
+ * @brief Encodes index channel values as zigzag coded deltas in varints
+ * @param values The values, size * width
+ * @param size The number of elements
+ * @param width The number of values per element
+ * @return The payload including the header
+ */
+std::string encodeDeltaVarint(const lvr2::Index* values, const uint64_t size, const uint64_t width);
+
+/**
+ * @brief Compresses the data following the header of the payload as a zstd frame and marks the payload type
+ * @return false if zstd is not available or the compression failed, the payload is unchanged in this case
+ */
+bool compressPayload(std::string& payload, const int level = 3);
+
+}  // namespace mesh_client
+
+#endif  // MESH_CLIENT__CHANNEL_CODEC_H_
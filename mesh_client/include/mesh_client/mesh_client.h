@@ -42,10 +42,17 @@
 
 #include <string>
 #include <array>
+#include <map>
+#include <memory>
+#include <vector>
+#include <curl/curl.h>
+#include <mesh_client/channel_cache.h>
+#include <mesh_client/channel_codec.h>
 #include <lvr2/io/AttributeMeshIOBase.hpp>
 #include <lvr2/geometry/BoundingBox.hpp>
 #include <lvr2/geometry/BaseVector.hpp>
 #include <jsoncpp/json/json.h>
+#include <boost/shared_array.hpp>
 
 namespace mesh_client
 {
@@ -59,12 +66,39 @@ public:
   MeshClient(const std::string& srv_url, const std::string& server_username, const std::string& server_password,
              const std::string& mesh_layer);
 
+  /**
+   * @brief Destructor, closes all pooled connections
+   */
+  ~MeshClient();
+
+  /**
+   * @brief Requests the given channels concurrently over the pooled connections. The received payloads are kept until
+   * the channels are accessed, e.g. with getVertices(), getIndices() or getChannel().
+   * @param channels The names of the channels to request
+   * @return true if all channels have been received successfully
+   */
+  bool prefetchChannels(const std::vector<std::string>& channels);
+
   /**
    * @brief sets the Bounding box for the query which is send to the server
    */
   void setBoundingBox(float min_x, float min_y, float min_z, const float max_x, const float max_y, const float max_z);
   void addFilter(std::string channel, float min_value, float max_value);
 
+  /**
+   * @brief Enables the persistent channel cache in the given directory. Cached channels are validated with a
+   * conditional request using the stored ETag and memory mapped if the server reports them as unmodified.
+   * @param directory The cache directory, an empty string disables the cache
+   */
+  void setCacheDirectory(const std::string& directory);
+
+  /**
+   * @brief Announces the compact encodings to the server: quantized float channels, delta varint coded index channels
+   * and zstd compression if available. The server decides per channel which encoding it answers with, raw payloads are
+   * still accepted. Quantized values are lossy, the error is bounded by the per component value range / 65535.
+   */
+  void setCompactEncoding(const bool enabled);
+
   /**
    * @brief Builds a JSON string containing the set bounding
    *        box and the attribute name and the attribute group
@@ -163,7 +197,110 @@ public:
   bool addChannel(const std::string group, const std::string name, const lvr2::UCharChannel& channel);
 
 private:
-  std::unique_ptr<std::string> requestChannel(std::string channel);
+  /**
+   * @brief Receives a channel payload. The payload starts with a 17 byte header holding the type, the number of
+   * elements and the element width. Once the header has been received the data is written directly into a buffer
+   * of the channel's type, which is handed over to the channel without copying it.
+   */
+  struct ChannelReceiver
+  {
+    //! size of the payload header: one byte type, eight bytes size and eight bytes width
+    static constexpr size_t HEADER_SIZE = 17;
+
+    std::array<char, HEADER_SIZE> header;
+    size_t header_received = 0;
+
+    char type = 0;
+    uint64_t size = 0;
+    uint64_t width = 0;
+
+    //! the destination buffer, only the one matching the type is allocated
+    boost::shared_array<float> float_data;
+    boost::shared_array<lvr2::Index> index_data;
+    boost::shared_array<unsigned char> uchar_data;
+
+    //! the destination buffer as bytes
+    char* data = nullptr;
+    size_t data_size = 0;
+    size_t data_received = 0;
+
+    //! decodes compact payloads into the destination buffer, null for raw payloads
+    std::unique_ptr<ChannelDecoder> decoder;
+
+    //! the cache key of the request, empty if the cache is disabled
+    std::string cache_key;
+
+    //! the ETag of the cached entry which is sent for validation
+    std::string cached_etag;
+
+    //! the ETag the server answered with
+    std::string etag;
+
+    //! request specific headers, used for the conditional request
+    struct curl_slist* request_headers = nullptr;
+
+    ~ChannelReceiver()
+    {
+      curl_slist_free_all(request_headers);
+    }
+
+    /**
+     * @brief Returns true if the header and the complete data have been received
+     */
+    bool complete() const
+    {
+      return header_received == HEADER_SIZE && (decoder ? decoder->finished() : data_received == data_size);
+    }
+  };
+
+  /**
+   * @brief Returns the prefetched channel or requests it over the pooled connection
+   */
+  std::unique_ptr<ChannelReceiver> requestChannel(std::string channel);
+
+  /**
+   * @brief Sets the request options for the given channel on the handle, the received data is written to the receiver
+   */
+  void setupRequest(CURL* handle, const std::string& channel, ChannelReceiver& receiver);
+
+  /**
+   * @brief Checks the transfer result, the HTTP response code and the completeness of a finished request. Loads the
+   * cached channel if the server reports it as unmodified and stores newly received channels in the cache.
+   */
+  bool requestSucceeded(CURL* handle, CURLcode result, const std::string& channel, ChannelReceiver& receiver);
+
+  /**
+   * @brief Hands the memory mapped cache entry of the receiver's request over to the receiver
+   */
+  bool loadCached(ChannelReceiver& receiver);
+
+  /**
+   * @brief Stores the ETag response header in the receiver
+   */
+  static size_t headerFunction(char* buffer, size_t size, size_t nitems, ChannelReceiver* receiver);
+
+  /**
+   * @brief Parses the payload header and writes the following data into the receiver's channel buffer
+   */
+  static size_t writeFunction(void* ptr, size_t size, size_t nmemb, ChannelReceiver* receiver);
+
+  //! the prefetched channels which have not been accessed yet
+  std::map<std::string, std::unique_ptr<ChannelReceiver>> prefetched_channels;
+
+  //! multi handle for the concurrent requests, it keeps the connection cache between the prefetches
+  CURLM* multi_handle_;
+
+  //! pool of easy handles, each keeps its connection alive for the next request
+  std::vector<CURL*> handles_;
+
+  //! the request headers, shared by all requests
+  struct curl_slist* headers_;
+
+  //! the persistent channel cache, null if disabled
+  std::unique_ptr<ChannelCache> cache_;
+
+  //! whether the compact encodings are announced to the server
+  bool compact_encoding_;
 
   std::map<std::string, lvr2::UCharChannel> uchar_channels;
   std::map<std::string, lvr2::IndexChannel> index_channels;
@@ -178,12 +315,6 @@ private:
   std::map<std::string, std::pair<float, float>> mesh_filters_;
 };
 
-size_t writeFunction(void* ptr, size_t size, size_t nmemb, std::string* data)
-{
-  data->append((char*)ptr, size * nmemb);
-  return size * nmemb;
-}
-
 }  // namespace mesh_client
 
 #endif  // MESH_CLIENT_H_
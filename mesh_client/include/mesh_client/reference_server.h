@@ -0,0 +1,209 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_CLIENT__REFERENCE_SERVER_H_
+#define MESH_CLIENT__REFERENCE_SERVER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <lvr2/io/AttributeMeshIOBase.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mesh_client
+{
+/**
+ * @brief A small local HTTP server implementing the mesh server protocol used by the MeshClient, for tests and
+ * benchmarks. It answers the JSON POST requests built by MeshClient::buildJson with the 17 byte header and the channel
+ * data, crops the mesh to the requested bounding box, applies the attribute filters, supports the compact encodings
+ * announced by the client and answers conditional requests using ETags.
+ */
+class ReferenceServer
+{
+public:
+  /**
+   * @brief Constructs the server, the map has to be loaded or generated before it is started
+   */
+  ReferenceServer();
+
+  /**
+   * @brief Destructor, stops the server
+   */
+  ~ReferenceServer();
+
+  /**
+   * @brief Loads the mesh part from the HDF5 map file, the attribute channels are read on request
+   * @param file The HDF5 map file
+   * @param part The name of the mesh in the map file
+   * @return true if the geometry has been loaded successfully
+   */
+  bool loadMap(const std::string& file, const std::string& part);
+
+  /**
+   * @brief Generates a regular triangulated grid with a wavy surface, including vertex and face normals, a
+   * "roughness" and a "height_diff" channel
+   * @param resolution The number of vertices per side
+   * @param spacing The distance between neighbouring vertices
+   */
+  void generateGrid(const size_t resolution, const float spacing);
+
+  /**
+   * @brief Opens the listening socket and starts serving requests in the background
+   * @param port The port to listen on, 0 to choose a free port
+   * @return true if the server has been started
+   */
+  bool start(const uint16_t port);
+
+  /**
+   * @brief Closes the listening socket and all connections and waits for the connection threads
+   */
+  void stop();
+
+  /**
+   * @brief Returns the port the server listens on
+   */
+  uint16_t port() const
+  {
+    return port_;
+  }
+
+  /**
+   * @brief Returns the url the MeshClient should connect to
+   */
+  std::string url() const;
+
+private:
+  //! the vertices and faces within a requested bounding box which pass the requested filters
+  struct Selection
+  {
+    //! the selected vertices as indices into the full mesh
+    std::vector<lvr2::Index> vertices;
+
+    //! the selected faces as indices into the full mesh
+    std::vector<lvr2::Index> faces;
+
+    //! maps the vertex indices of the full mesh to the selection
+    std::vector<lvr2::Index> vertex_map;
+  };
+
+  /**
+   * @brief Accepts connections until the server is stopped
+   */
+  void acceptLoop();
+
+  /**
+   * @brief Serves the requests of a keep alive connection until it is closed
+   */
+  void serveConnection(const int fd);
+
+  /**
+   * @brief Builds the response to the JSON request body
+   * @param body The request body
+   * @param if_none_match The ETag of the client's cached entry, may be empty
+   * @param status The HTTP status code
+   * @param etag The ETag of the payload
+   * @return The response payload
+   */
+  std::string respond(const std::string& body, const std::string& if_none_match, int& status, std::string& etag);
+
+  /**
+   * @brief Encodes the selected part of the named channel as payload
+   * @return false if the channel does not exist
+   */
+  bool encodeChannel(const std::string& name, const Selection& selection, const std::set<std::string>& encodings,
+                     std::string& payload);
+
+  /**
+   * @brief Returns the selection for the request, selections are cached for repeated requests, e.g. of the channels
+   * of the same bounding box
+   */
+  std::shared_ptr<const Selection> select(const std::array<float, 6>& bounding_box,
+                                          const std::map<std::string, std::pair<float, float>>& filters);
+
+  /**
+   * @brief Loads the named float channel from the map file if it has not been loaded yet
+   */
+  const lvr2::FloatChannel* floatChannel(const std::string& name);
+
+  /**
+   * @brief Loads the named index channel from the map file if it has not been loaded yet
+   */
+  const lvr2::IndexChannel* indexChannel(const std::string& name);
+
+  /**
+   * @brief Loads the named unsigned char channel from the map file if it has not been loaded yet
+   */
+  const lvr2::UCharChannel* ucharChannel(const std::string& name);
+
+  //! the map file, null for generated maps
+  std::shared_ptr<lvr2::AttributeMeshIOBase> io_;
+
+  //! guards the map file and the loaded channels
+  std::mutex channels_mtx_;
+
+  std::unique_ptr<lvr2::FloatChannel> vertices_;
+  std::unique_ptr<lvr2::IndexChannel> indices_;
+  std::map<std::string, lvr2::FloatChannel> float_channels_;
+  std::map<std::string, lvr2::IndexChannel> index_channels_;
+  std::map<std::string, lvr2::UCharChannel> uchar_channels_;
+
+  //! guards the cached selections
+  std::mutex selections_mtx_;
+
+  //! the selection of the last requests, keyed by bounding box and filters
+  std::map<std::string, std::shared_ptr<const Selection>> selections_;
+
+  //! guards the connections
+  std::mutex connections_mtx_;
+  std::set<int> connection_fds_;
+  std::vector<std::thread> connection_threads_;
+
+  std::atomic<bool> running_;
+  int listen_fd_;
+  uint16_t port_;
+  std::thread accept_thread_;
+};
+
+}  // namespace mesh_client
+
+#endif  // MESH_CLIENT__REFERENCE_SERVER_H_
@@ -0,0 +1,284 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mesh_client/mesh_client.h>
+#include <mesh_client/reference_server.h>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Measures the load time, the peak memory usage and the per channel throughput of the MeshClient. Each load runs in
+ * a forked process so that its peak resident set size is not distorted by previous loads. With --grid the maps are
+ * generated and served by a ReferenceServer in a separate process, one for each resolution, otherwise the given
+ * server is used. The channels are prefetched concurrently like the mesh map does, with --sequential they are
+ * requested one after the other to measure the throughput of each channel.
+ */
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+  std::string url;
+  std::string layer = "mesh0";
+  std::vector<size_t> grid_resolutions;
+  float grid_spacing = 0.1;
+  std::vector<std::string> channels = { "vertex_normals", "face_normals", "roughness", "height_diff" };
+  bool compact = false;
+  bool sequential = false;
+  size_t repetitions = 3;
+};
+
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program
+            << " (--url URL [--layer LAYER] | --grid RESOLUTION [RESOLUTION ...] [--spacing S])"
+               " [--channels NAME[,NAME ...]] [--compact] [--sequential] [--repetitions N]"
+            << std::endl;
+}
+
+double seconds(const Clock::time_point& start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void printChannel(const std::string& name, const size_t elements, const size_t bytes, const double time)
+{
+  std::printf("  %-16s %10zu elements %10.2f MB %9.2f ms %9.1f MB/s\n", name.c_str(), elements, bytes / 1e6,
+              time * 1e3, time > 0 ? bytes / 1e6 / time : 0.0);
+}
+
+/**
+ * @brief Loads the geometry and the channels and prints the timings, runs in the forked process
+ */
+int load(const Options& options, const std::string& url)
+{
+  mesh_client::MeshClient client(url, "", "", options.layer);
+  client.setCompactEncoding(options.compact);
+
+  const Clock::time_point start = Clock::now();
+  if (!options.sequential)
+  {
+    // all channels are requested concurrently, the accesses below only take over the received channels
+    std::vector<std::string> names = { "vertices", "face_indices" };
+    names.insert(names.end(), options.channels.begin(), options.channels.end());
+    if (!client.prefetchChannels(names))
+      return EXIT_FAILURE;
+    std::printf("  prefetch of %zu channels %.2f ms\n", names.size(), seconds(start) * 1e3);
+  }
+
+  Clock::time_point channel_start = Clock::now();
+  const auto vertices = client.getVertices();
+  if (!vertices)
+    return EXIT_FAILURE;
+  printChannel("vertices", vertices->numElements(), vertices->numElements() * vertices->width() * sizeof(float),
+               seconds(channel_start));
+
+  channel_start = Clock::now();
+  const auto indices = client.getIndices();
+  if (!indices)
+    return EXIT_FAILURE;
+  printChannel("face_indices", indices->numElements(),
+               indices->numElements() * indices->width() * sizeof(lvr2::Index), seconds(channel_start));
+
+  for (const auto& name : options.channels)
+  {
+    channel_start = Clock::now();
+    lvr2::FloatChannelOptional channel;
+    if (!client.getChannel("", name, channel) || !channel)
+      return EXIT_FAILURE;
+    printChannel(name, channel->numElements(), channel->numElements() * channel->width() * sizeof(float),
+                 seconds(channel_start));
+  }
+  std::printf("  load time %.2f ms\n", seconds(start) * 1e3);
+  std::fflush(stdout);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Runs the load in a forked process
+ * @return false if the load failed
+ */
+bool measure(const Options& options, const std::string& url)
+{
+  std::fflush(stdout);
+  const pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0)
+    _exit(load(options, url));
+
+  int status = 0;
+  struct rusage usage;
+  if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+    return false;
+  // ru_maxrss is given in kilobytes
+  std::printf("  peak rss  %.2f MB\n", usage.ru_maxrss / 1e3);
+  return true;
+}
+
+/**
+ * @brief Starts a reference server with a generated grid in a forked process
+ * @return the process id of the server, -1 on failure
+ */
+pid_t startServer(const size_t resolution, const float spacing, uint16_t& port)
+{
+  int fds[2];
+  if (pipe(fds) < 0)
+    return -1;
+  std::fflush(stdout);
+  const pid_t pid = fork();
+  if (pid < 0)
+    return -1;
+  if (pid == 0)
+  {
+    close(fds[0]);
+    mesh_client::ReferenceServer server;
+    server.generateGrid(resolution, spacing);
+    port = server.start(0) ? server.port() : 0;
+    if (write(fds[1], &port, sizeof(port)) != sizeof(port) || !port)
+      _exit(EXIT_FAILURE);
+    close(fds[1]);
+    // serve until the benchmark terminates the process
+    while (true)
+    {
+      pause();
+    }
+  }
+  close(fds[1]);
+  const bool started = read(fds[0], &port, sizeof(port)) == sizeof(port) && port;
+  close(fds[0]);
+  if (!started)
+  {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    return -1;
+  }
+  return pid;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options options;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string option = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (option == "--url" && has_value)
+      options.url = argv[++i];
+    else if (option == "--layer" && has_value)
+      options.layer = argv[++i];
+    else if (option == "--grid" && has_value)
+    {
+      while (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        options.grid_resolutions.push_back(std::strtoul(argv[++i], nullptr, 10));
+      }
+    }
+    else if (option == "--spacing" && has_value)
+      options.grid_spacing = std::atof(argv[++i]);
+    else if (option == "--channels" && has_value)
+    {
+      options.channels.clear();
+      std::istringstream names(argv[++i]);
+      std::string name;
+      while (std::getline(names, name, ','))
+      {
+        if (!name.empty())
+          options.channels.push_back(name);
+      }
+    }
+    else if (option == "--compact")
+      options.compact = true;
+    else if (option == "--sequential")
+      options.sequential = true;
+    else if (option == "--repetitions" && has_value)
+      options.repetitions = std::strtoul(argv[++i], nullptr, 10);
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (options.url.empty() == options.grid_resolutions.empty())
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bool success = true;
+  if (!options.url.empty())
+  {
+    for (size_t r = 0; r < options.repetitions; r++)
+    {
+      std::printf("%s, run %zu:\n", options.url.c_str(), r + 1);
+      success &= measure(options, options.url);
+    }
+  }
+
+  for (const size_t resolution : options.grid_resolutions)
+  {
+    uint16_t port = 0;
+    const pid_t server = startServer(resolution, options.grid_spacing, port);
+    if (server < 0)
+    {
+      std::cerr << "Could not start the reference server!" << std::endl;
+      return EXIT_FAILURE;
+    }
+    const std::string url = "http://127.0.0.1:" + std::to_string(port);
+    for (size_t r = 0; r < options.repetitions; r++)
+    {
+      std::printf("grid %zux%zu, run %zu:\n", resolution, resolution, r + 1);
+      success &= measure(options, url);
+    }
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "mesh_client/channel_cache.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <ros/ros.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mesh_client
+{
+//! identifies the cache file format
+static const char CACHE_MAGIC[4] = { 'M', 'C', 'C', '1' };
+
+ChannelCache::ChannelCache(const std::string& directory) : directory_(directory)
+{
+  struct stat info;
+  if (stat(directory_.c_str(), &info) != 0 && mkdir(directory_.c_str(), 0755) != 0)
+  {
+    ROS_WARN_STREAM("Could not create the channel cache directory \"" << directory_ << "\": " << strerror(errno));
+  }
+}
+
+std::string ChannelCache::key(const std::string& request_description)
+{
+  // 64 bit FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : request_description)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  std::stringstream stream;
+  stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return stream.str();
+}
+
+std::string ChannelCache::path(const std::string& key, const std::string& extension) const
+{
+  return directory_ + "/" + key + extension;
+}
+
+bool ChannelCache::etag(const std::string& key, std::string& etag) const
+{
+  std::ifstream file(path(key, ".etag"));
+  return file && std::getline(file, etag) && !etag.empty();
+}
+
+bool ChannelCache::load(const std::string& key, Entry& entry) const
+{
+  const std::string file_path = path(key, ".channel");
+  const int fd = open(file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < DATA_OFFSET)
+  {
+    close(fd);
+    return false;
+  }
+
+  const size_t length = info.st_size;
+  void* mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+  {
+    ROS_WARN_STREAM("Could not map the cached channel \"" << file_path << "\": " << strerror(errno));
+    return false;
+  }
+  entry.mapping = std::shared_ptr<void>(mapped, [length](void* ptr) { munmap(ptr, length); });
+
+  const char* header = static_cast<const char*>(mapped);
+  if (std::memcmp(header, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+  {
+    entry.mapping.reset();
+    return false;
+  }
+  entry.type = header[4];
+  std::memcpy(&entry.size, header + 8, sizeof(uint64_t));
+  std::memcpy(&entry.width, header + 16, sizeof(uint64_t));
+  entry.data = static_cast<char*>(mapped) + DATA_OFFSET;
+  entry.data_size = length - DATA_OFFSET;
+  return true;
+}
+
+bool ChannelCache::store(const std::string& key, const std::string& etag, const char type, const uint64_t size,
+                         const uint64_t width, const char* data, const size_t data_size) const
+{
+  const std::string channel_path = path(key, ".channel");
+  const std::string etag_path = path(key, ".etag");
+
+  // the ETag is written last, thus an entry without a complete data file is never validated
+  std::remove(etag_path.c_str());
+  {
+    std::ofstream file(channel_path + ".tmp", std::ios::binary | std::ios::trunc);
+    char header[DATA_OFFSET] = {};
+    std::memcpy(header, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header[4] = type;
+    std::memcpy(header + 8, &size, sizeof(uint64_t));
+    std::memcpy(header + 16, &width, sizeof(uint64_t));
+    file.write(header, DATA_OFFSET);
+    file.write(data, data_size);
+    if (!file)
+    {
+      ROS_WARN_STREAM("Could not write the channel cache file \"" << channel_path << "\"");
+      std::remove((channel_path + ".tmp").c_str());
+      return false;
+    }
+  }
+  {
+    std::ofstream file(etag_path + ".tmp", std::ios::trunc);
+    file << etag << std::endl;
+    if (!file)
+      return false;
+  }
+  return std::rename((channel_path + ".tmp").c_str(), channel_path.c_str()) == 0 &&
+         std::rename((etag_path + ".tmp").c_str(), etag_path.c_str()) == 0;
+}
+
+}  // namespace mesh_client
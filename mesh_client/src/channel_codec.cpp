@@ -0,0 +1,335 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "mesh_client/channel_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef MESH_CLIENT_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace mesh_client
+{
+namespace
+{
+//! size of the payload header: one byte type, eight bytes size and eight bytes width
+const size_t HEADER_SIZE = 17;
+
+std::string encodeHeader(const char type, const uint64_t size, const uint64_t width)
+{
+  std::string header(HEADER_SIZE, '\0');
+  header[0] = type;
+  std::memcpy(&header[1], &size, sizeof(uint64_t));
+  std::memcpy(&header[9], &width, sizeof(uint64_t));
+  return header;
+}
+
+//! the top codes of the quantized values are reserved for +inf, -inf and NaN, e.g. the costs of lethal vertices
+const uint32_t NON_FINITE_CODES = 3;
+
+inline uint32_t maxCode(const size_t value_size)
+{
+  return value_size == 2 ? 65535 : 255;
+}
+
+inline uint64_t zigzag(const int64_t value)
+{
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(const uint64_t value)
+{
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+}  // namespace
+
+bool isEncoded(const char type)
+{
+  const char encoding = type & ~COMPRESSED_FLAG;
+  return encoding == QUANTIZED_16 || encoding == DELTA_VARINT || encoding == QUANTIZED_8;
+}
+
+bool compressionSupported()
+{
+#ifdef MESH_CLIENT_WITH_ZSTD
+  return true;
+#else
+  return false;
+#endif
+}
+
+struct ChannelDecoder::Decompressor
+{
+#ifdef MESH_CLIENT_WITH_ZSTD
+  Decompressor() : stream(ZSTD_createDStream()), buffer(ZSTD_DStreamOutSize())
+  {
+    ZSTD_initDStream(stream);
+  }
+
+  ~Decompressor()
+  {
+    ZSTD_freeDStream(stream);
+  }
+
+  ZSTD_DStream* stream;
+  std::vector<char> buffer;
+#endif
+};
+
+ChannelDecoder::ChannelDecoder(const char type, const uint64_t size, const uint64_t width, float* output)
+  : encoding(type & ~COMPRESSED_FLAG)
+  , compressed(type & COMPRESSED_FLAG)
+  , width(width)
+  , count(size * width)
+  , float_output(output)
+  , index_output(nullptr)
+  , decoded(0)
+  , parameters(2 * width * sizeof(float))
+  , parameters_received(0)
+  , partial_received(0)
+  , varint(0)
+  , varint_shift(0)
+  , previous(0)
+{
+  if (compressed)
+    decompressor = std::make_unique<Decompressor>();
+}
+
+ChannelDecoder::ChannelDecoder(const char type, const uint64_t size, const uint64_t width, lvr2::Index* output)
+  : encoding(type & ~COMPRESSED_FLAG)
+  , compressed(type & COMPRESSED_FLAG)
+  , width(width)
+  , count(size * width)
+  , float_output(nullptr)
+  , index_output(output)
+  , decoded(0)
+  , parameters_received(0)
+  , partial_received(0)
+  , varint(0)
+  , varint_shift(0)
+  , previous(0)
+{
+  if (compressed)
+    decompressor = std::make_unique<Decompressor>();
+}
+
+ChannelDecoder::~ChannelDecoder()
+{
+}
+
+bool ChannelDecoder::consume(const char* data, const size_t length)
+{
+  if (!compressed)
+    return consumePlain(data, length);
+
+#ifdef MESH_CLIENT_WITH_ZSTD
+  ZSTD_inBuffer input = { data, length, 0 };
+  while (input.pos < input.size)
+  {
+    ZSTD_outBuffer output = { decompressor->buffer.data(), decompressor->buffer.size(), 0 };
+    const size_t result = ZSTD_decompressStream(decompressor->stream, &output, &input);
+    if (ZSTD_isError(result) || !consumePlain(decompressor->buffer.data(), output.pos))
+      return false;
+  }
+  return true;
+#else
+  // compressed payloads are only sent if the client announced zstd support
+  return false;
+#endif
+}
+
+bool ChannelDecoder::consumePlain(const char* data, const size_t length)
+{
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  size_t pos = 0;
+
+  if (encoding == DELTA_VARINT)
+  {
+    if (!index_output)
+      return false;
+    for (; pos < length; pos++)
+    {
+      varint |= static_cast<uint64_t>(bytes[pos] & 0x7f) << varint_shift;
+      varint_shift += 7;
+      if (bytes[pos] & 0x80)
+      {
+        if (varint_shift > 63)
+          return false;
+        continue;
+      }
+      if (decoded == count)
+        return false;
+      previous += unzigzag(varint);
+      index_output[decoded++] = static_cast<lvr2::Index>(previous);
+      varint = 0;
+      varint_shift = 0;
+    }
+    return true;
+  }
+
+  if ((encoding != QUANTIZED_16 && encoding != QUANTIZED_8) || !float_output)
+    return false;
+
+  // the minimum and scale per component precede the values
+  if (parameters_received < parameters.size())
+  {
+    const size_t parameter_bytes = std::min(length, parameters.size() - parameters_received);
+    std::memcpy(parameters.data() + parameters_received, bytes, parameter_bytes);
+    parameters_received += parameter_bytes;
+    pos += parameter_bytes;
+    if (parameters_received < parameters.size())
+      return true;
+  }
+
+  const float* minimum = reinterpret_cast<const float*>(parameters.data());
+  const float* scale = minimum + width;
+  const size_t value_size = encoding == QUANTIZED_16 ? 2 : 1;
+  while (pos < length)
+  {
+    // complete a value split between two chunks
+    const size_t value_bytes = std::min(length - pos, value_size - partial_received);
+    std::memcpy(partial.data() + partial_received, bytes + pos, value_bytes);
+    partial_received += value_bytes;
+    pos += value_bytes;
+    if (partial_received < value_size)
+      break;
+
+    if (decoded == count)
+      return false;
+    const uint32_t quantized = value_size == 2 ? partial[0] | (partial[1] << 8) : partial[0];
+    const uint64_t component = decoded % width;
+    const uint32_t max_code = maxCode(value_size);
+    if (quantized == max_code)
+      float_output[decoded++] = std::numeric_limits<float>::infinity();
+    else if (quantized == max_code - 1)
+      float_output[decoded++] = -std::numeric_limits<float>::infinity();
+    else if (quantized == max_code - 2)
+      float_output[decoded++] = std::numeric_limits<float>::quiet_NaN();
+    else
+      float_output[decoded++] = minimum[component] + quantized * scale[component];
+    partial_received = 0;
+  }
+  return true;
+}
+
+std::string encodeQuantized(const float* values, const uint64_t size, const uint64_t width, const Encoding encoding)
+{
+  const uint32_t max_code = maxCode(encoding == QUANTIZED_16 ? 2 : 1);
+  const float max_quantized = max_code - NON_FINITE_CODES;
+  std::vector<float> minimum(width, std::numeric_limits<float>::max());
+  std::vector<float> maximum(width, std::numeric_limits<float>::lowest());
+  for (uint64_t i = 0; i < size * width; i++)
+  {
+    if (!std::isfinite(values[i]))
+      continue;
+    minimum[i % width] = std::min(minimum[i % width], values[i]);
+    maximum[i % width] = std::max(maximum[i % width], values[i]);
+  }
+  std::vector<float> scale(width);
+  for (uint64_t c = 0; c < width; c++)
+  {
+    if (minimum[c] > maximum[c])
+      minimum[c] = maximum[c] = 0;
+    scale[c] = (maximum[c] - minimum[c]) / max_quantized;
+  }
+
+  std::string payload = encodeHeader(encoding, size, width);
+  payload.append(reinterpret_cast<const char*>(minimum.data()), width * sizeof(float));
+  payload.append(reinterpret_cast<const char*>(scale.data()), width * sizeof(float));
+  payload.reserve(payload.size() + size * width * (encoding == QUANTIZED_16 ? 2 : 1));
+  for (uint64_t i = 0; i < size * width; i++)
+  {
+    const uint64_t c = i % width;
+    const float value = values[i];
+    uint32_t quantized = 0;
+    if (std::isnan(value))
+      quantized = max_code - 2;
+    else if (std::isinf(value))
+      quantized = value > 0 ? max_code : max_code - 1;
+    else if (scale[c] > 0)
+      quantized = static_cast<uint32_t>(std::lround((value - minimum[c]) / scale[c]));
+    payload.push_back(static_cast<char>(quantized & 0xff));
+    if (encoding == QUANTIZED_16)
+      payload.push_back(static_cast<char>((quantized >> 8) & 0xff));
+  }
+  return payload;
+}
+
+std::string encodeDeltaVarint(const lvr2::Index* values, const uint64_t size, const uint64_t width)
+{
+  std::string payload = encodeHeader(DELTA_VARINT, size, width);
+  payload.reserve(payload.size() + size * width * 2);
+  int64_t previous = 0;
+  for (uint64_t i = 0; i < size * width; i++)
+  {
+    uint64_t value = zigzag(static_cast<int64_t>(values[i]) - previous);
+    previous = values[i];
+    do
+    {
+      const char byte = value & 0x7f;
+      value >>= 7;
+      payload.push_back(value ? byte | 0x80 : byte);
+    } while (value);
+  }
+  return payload;
+}
+
+bool compressPayload(std::string& payload, const int level)
+{
+#ifdef MESH_CLIENT_WITH_ZSTD
+  if (payload.size() < HEADER_SIZE)
+    return false;
+  std::string compressed(HEADER_SIZE + ZSTD_compressBound(payload.size() - HEADER_SIZE), '\0');
+  const size_t result = ZSTD_compress(&compressed[HEADER_SIZE], compressed.size() - HEADER_SIZE,
+                                      payload.data() + HEADER_SIZE, payload.size() - HEADER_SIZE, level);
+  if (ZSTD_isError(result))
+    return false;
+  std::memcpy(&compressed[0], payload.data(), HEADER_SIZE);
+  compressed[0] |= COMPRESSED_FLAG;
+  compressed.resize(HEADER_SIZE + result);
+  payload.swap(compressed);
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace mesh_client
@@ -36,18 +36,59 @@
  */
 #include "mesh_client/mesh_client.h"
 
-#include <curl/curl.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
 #include <ros/ros.h>
+#include <strings.h>
 
 namespace mesh_client
 {
+//! curl_global_init is not thread-safe and must only be called once per process
+static std::once_flag curl_init_flag;
+
+//! upper bound of the channel buffer size announced by the server, larger channels abort the transfer
+static const uint64_t MAX_CHANNEL_BYTES = uint64_t(1) << 32;
+
+/**
+ * @brief Allocates the buffer for a channel with the number of values announced by the server
+ * @return The buffer or null, if the size exceeds MAX_CHANNEL_BYTES or the allocation fails
+ */
+template <typename T>
+static boost::shared_array<T> allocateChannel(const uint64_t elements)
+{
+  if (elements > MAX_CHANNEL_BYTES / sizeof(T))
+    return boost::shared_array<T>();
+  return boost::shared_array<T>(new (std::nothrow) T[elements]);
+}
+
 MeshClient::MeshClient(const std::string& server_url, const std::string& server_username,
                        const std::string& server_password, const std::string& mesh_layer)
-  : server_url_(server_url)
+  : multi_handle_(nullptr)
+  , headers_(nullptr)
+  , compact_encoding_(false)
+  , server_url_(server_url)
   , server_username_(server_username)
   , server_password_(server_password)
   , mesh_layer_(mesh_layer)
 {
+  std::call_once(curl_init_flag, []() { curl_global_init(CURL_GLOBAL_ALL); });
+  multi_handle_ = curl_multi_init();
+  headers_ = curl_slist_append(headers_, "Content-Type: application/json");
+}
+
+MeshClient::~MeshClient()
+{
+  for (auto handle : handles_)
+  {
+    curl_easy_cleanup(handle);
+  }
+  if (multi_handle_)
+  {
+    curl_multi_cleanup(multi_handle_);
+  }
+  curl_slist_free_all(headers_);
 }
 
 void MeshClient::setBoundingBox(float min_x, float min_y, float min_z, const float max_x, const float max_y,
@@ -61,6 +102,19 @@ void MeshClient::setBoundingBox(float min_x, float min_y, float min_z, const flo
   bounding_box_[5] = max_z;
 }
 
+void MeshClient::setCacheDirectory(const std::string& directory)
+{
+  if (directory.empty())
+    cache_.reset();
+  else
+    cache_ = std::make_unique<ChannelCache>(directory);
+}
+
+void MeshClient::setCompactEncoding(const bool enabled)
+{
+  compact_encoding_ = enabled;
+}
+
 void MeshClient::addFilter(std::string channel, float min_value, float max_value)
 {
   mesh_filters_[channel] = std::make_pair(min_value, max_value);
@@ -99,25 +153,18 @@ std::string MeshClient::buildJson(const std::string& attribute_name)
   request["boundingbox"] = json_bb;
   request["attribute"] = attr;
   request["layer"] = mesh_layer_;
-  Json::FastWriter fast_writer;
-  return fast_writer.write(request);
-}
-
-bool parseByteDataString(std::string string, char& type, unsigned long& size, unsigned long& width, char*& data)
-{
-  if (string.length() < 10)
+  if (compact_encoding_)
   {
-    return false;
+    Json::Value encodings;
+    encodings.append("quantized16");
+    encodings.append("quantized8");
+    encodings.append("varint");
+    if (compressionSupported())
+      encodings.append("zstd");
+    request["encodings"] = encodings;
   }
-
-  // parse body
-  const char* body = string.c_str();
-  type = body[0];                                                // one byte for type of message
-  size = *reinterpret_cast<const unsigned long*>(body + 1);      // eight bytes for length of message
-  width = *reinterpret_cast<const unsigned long*>(body + 9);     // eight bytes for amount of values per element
-  data = reinterpret_cast<char*>(const_cast<char*>(body + 17));  // raw data
-
-  return true;
+  Json::FastWriter fast_writer;
+  return fast_writer.write(request);
 }
 
 lvr2::FloatChannelOptional MeshClient::getVertices()
@@ -127,24 +174,11 @@ lvr2::FloatChannelOptional MeshClient::getVertices()
     return float_channels["vertices"];
   }
 
-  unique_ptr<std::string> str = requestChannel("vertices");
-
-  if (str && str->size() > 17)
+  std::unique_ptr<ChannelReceiver> receiver = requestChannel("vertices");
+  if (receiver && receiver->type == Type::FLOAT)
   {
-    char type;
-    unsigned long size, width;
-    char* data;
-
     ROS_DEBUG_STREAM("Received vertices channel");
-
-    if (parseByteDataString(*str, type, size, width, data) && type == Type::FLOAT)
-    {
-      float* float_data = reinterpret_cast<float*>(data);
-      auto channel = lvr2::FloatChannel(size, width);
-      memcpy(channel.dataPtr().get(), float_data, size * width * sizeof(float));
-
-      return channel;
-    }
+    return lvr2::FloatChannel(receiver->size, receiver->width, receiver->float_data);
   }
   ROS_ERROR_STREAM("Failed to load vertices channel!");
   return lvr2::FloatChannelOptional();
@@ -157,24 +191,11 @@ lvr2::IndexChannelOptional MeshClient::getIndices()
     return index_channels["face_indices"];
   }
 
-  unique_ptr<std::string> str = requestChannel("face_indices");
-
-  if (str && str->size() > 17)
+  std::unique_ptr<ChannelReceiver> receiver = requestChannel("face_indices");
+  if (receiver && receiver->type == Type::UINT)
   {
-    char type;
-    unsigned long size, width;
-    char* data;
-
     ROS_DEBUG_STREAM("Received indices channel");
-
-    if (parseByteDataString(*str, type, size, width, data) && type == Type::UINT)
-    {
-      unsigned int* index_data = reinterpret_cast<unsigned int*>(data);
-      auto channel = lvr2::IndexChannel(size, width);
-      memcpy(channel.dataPtr().get(), index_data, size * width * sizeof(lvr2::Index));
-
-      return channel;
-    }
+    return lvr2::IndexChannel(receiver->size, receiver->width, receiver->index_data);
   }
   ROS_ERROR_STREAM("Failed to load indices channel!");
   return lvr2::IndexChannelOptional();
@@ -194,30 +215,18 @@ bool MeshClient::addIndices(const lvr2::IndexChannel& channel)
 
 bool MeshClient::getChannel(const std::string group, const std::string name, lvr2::FloatChannelOptional& channel)
 {
-  std::cout << "channel " << name << std::endl;
   if (float_channels.find(name) != float_channels.end())
   {
     channel = float_channels[name];
     return true;
   }
 
-  unique_ptr<std::string> str = requestChannel(name);
-
-  if (str && str->size() > 17)
+  std::unique_ptr<ChannelReceiver> receiver = requestChannel(name);
+  if (receiver && receiver->type == Type::FLOAT)
   {
-    char type;
-    unsigned long size, width;
-    char* data;
-
     ROS_DEBUG_STREAM("Received " << name << " channel");
-
-    if (parseByteDataString(*str, type, size, width, data) && type == Type::FLOAT)
-    {
-      float* float_data = reinterpret_cast<float*>(data);
-      channel = lvr2::FloatChannel(size, width);
-      memcpy(channel.get().dataPtr().get(), float_data, size * width * sizeof(float));
-      return true;
-    }
+    channel = lvr2::FloatChannel(receiver->size, receiver->width, receiver->float_data);
+    return true;
   }
   ROS_ERROR_STREAM("Failed to load " << name << " channel!");
   return false;
@@ -231,23 +240,12 @@ bool MeshClient::getChannel(const std::string group, const std::string name, lvr
     return true;
   }
 
-  unique_ptr<std::string> str = requestChannel(name);
-
-  if (str && str->size() > 17)
+  std::unique_ptr<ChannelReceiver> receiver = requestChannel(name);
+  if (receiver && receiver->type == Type::UINT)
   {
-    char type;
-    unsigned long size, width;
-    char* data;
-
     ROS_DEBUG_STREAM("Received " << name << " channel");
-
-    if (parseByteDataString(*str, type, size, width, data) && type == Type::UINT)
-    {
-      unsigned int* index_data = reinterpret_cast<unsigned int*>(data);
-      channel = lvr2::IndexChannel(size, width);
-      memcpy(channel.get().dataPtr().get(), index_data, size * width * sizeof(lvr2::Index));
-      return true;
-    }
+    channel = lvr2::IndexChannel(receiver->size, receiver->width, receiver->index_data);
+    return true;
   }
   ROS_ERROR_STREAM("Failed to load " << name << " channel!");
   return false;
@@ -261,23 +259,12 @@ bool MeshClient::getChannel(const std::string group, const std::string name, lvr
     return true;
   }
 
-  unique_ptr<std::string> str = requestChannel(name);
-
-  if (str && str->size() > 17)
+  std::unique_ptr<ChannelReceiver> receiver = requestChannel(name);
+  if (receiver && receiver->type == Type::UCHAR)
   {
-    char type;
-    unsigned long size, width;
-    char* data;
-
     ROS_DEBUG_STREAM("Received " << name << " channel");
-
-    if (parseByteDataString(*str, type, size, width, data) && type == Type::UINT)
-    {
-      unsigned char* uchar_data = reinterpret_cast<unsigned char*>(data);
-      channel = lvr2::UCharChannel(size, width);
-      memcpy(channel.get().dataPtr().get(), uchar_data, size * width * sizeof(unsigned char));
-      return true;
-    }
+    channel = lvr2::UCharChannel(receiver->size, receiver->width, receiver->uchar_data);
+    return true;
   }
   ROS_ERROR_STREAM("Failed to load " << name << " channel!");
   return false;
@@ -301,44 +288,324 @@ bool MeshClient::addChannel(const std::string group, const std::string name, con
   return true;
 }
 
-std::unique_ptr<std::string> MeshClient::requestChannel(std::string channel)
+size_t MeshClient::writeFunction(void* ptr, size_t size, size_t nmemb, ChannelReceiver* receiver)
 {
-  CURL* curl;
+  const size_t length = size * nmemb;
+  const char* bytes = static_cast<const char*>(ptr);
+  size_t consumed = 0;
 
-  curl_global_init(CURL_GLOBAL_ALL);
+  if (receiver->header_received < ChannelReceiver::HEADER_SIZE)
+  {
+    const size_t header_bytes = std::min(length, ChannelReceiver::HEADER_SIZE - receiver->header_received);
+    std::memcpy(receiver->header.data() + receiver->header_received, bytes, header_bytes);
+    receiver->header_received += header_bytes;
+    consumed += header_bytes;
+
+    if (receiver->header_received < ChannelReceiver::HEADER_SIZE)
+      return length;
+
+    // the header is complete, allocate the channel buffer for the announced type and size
+    receiver->type = receiver->header[0];
+    std::memcpy(&receiver->size, receiver->header.data() + 1, sizeof(uint64_t));
+    std::memcpy(&receiver->width, receiver->header.data() + 9, sizeof(uint64_t));
+    // the size and width are untrusted, their product must neither overflow nor exceed the buffer limit
+    if (receiver->width != 0 && receiver->size > MAX_CHANNEL_BYTES / receiver->width)
+      return 0;
+    const size_t elements = receiver->size * receiver->width;
+    if (isEncoded(receiver->type))
+    {
+      // compact payloads are decoded into a buffer of the type they represent
+      const char encoding = receiver->type & ~COMPRESSED_FLAG;
+      if (encoding == Encoding::QUANTIZED_16 || encoding == Encoding::QUANTIZED_8)
+      {
+        receiver->float_data = allocateChannel<float>(elements);
+        if (!receiver->float_data)
+          return 0;
+        receiver->decoder = std::make_unique<ChannelDecoder>(receiver->type, receiver->size, receiver->width,
+                                                             receiver->float_data.get());
+        receiver->type = Type::FLOAT;
+        receiver->data = reinterpret_cast<char*>(receiver->float_data.get());
+        receiver->data_size = elements * sizeof(float);
+      }
+      else if (encoding == Encoding::DELTA_VARINT)
+      {
+        receiver->index_data = allocateChannel<lvr2::Index>(elements);
+        if (!receiver->index_data)
+          return 0;
+        receiver->decoder = std::make_unique<ChannelDecoder>(receiver->type, receiver->size, receiver->width,
+                                                             receiver->index_data.get());
+        receiver->type = Type::UINT;
+        receiver->data = reinterpret_cast<char*>(receiver->index_data.get());
+        receiver->data_size = elements * sizeof(lvr2::Index);
+      }
+      else
+      {
+        return 0;
+      }
+    }
+    else
+    {
+      switch (receiver->type)
+      {
+        case Type::FLOAT:
+          receiver->float_data = allocateChannel<float>(elements);
+          if (!receiver->float_data)
+            return 0;
+          receiver->data = reinterpret_cast<char*>(receiver->float_data.get());
+          receiver->data_size = elements * sizeof(float);
+          break;
+        case Type::UINT:
+          receiver->index_data = allocateChannel<lvr2::Index>(elements);
+          if (!receiver->index_data)
+            return 0;
+          receiver->data = reinterpret_cast<char*>(receiver->index_data.get());
+          receiver->data_size = elements * sizeof(lvr2::Index);
+          break;
+        case Type::UCHAR:
+          receiver->uchar_data = allocateChannel<unsigned char>(elements);
+          if (!receiver->uchar_data)
+            return 0;
+          receiver->data = reinterpret_cast<char*>(receiver->uchar_data.get());
+          receiver->data_size = elements * sizeof(unsigned char);
+          break;
+        default:
+          // an unknown type aborts the transfer
+          return 0;
+      }
+    }
+  }
 
-  curl = curl_easy_init();
-  if (!curl)
+  const size_t data_bytes = length - consumed;
+  if (receiver->decoder)
   {
-    curl_global_cleanup();
-    return nullptr;
+    // a malformed payload aborts the transfer
+    if (!receiver->decoder->consume(bytes + consumed, data_bytes))
+      return 0;
+    if (receiver->decoder->finished())
+      receiver->data_received = receiver->data_size;
+    return length;
+  }
+  if (receiver->data_received + data_bytes > receiver->data_size)
+  {
+    // more data than announced aborts the transfer
+    return 0;
+  }
+  std::memcpy(receiver->data + receiver->data_received, bytes + consumed, data_bytes);
+  receiver->data_received += data_bytes;
+  return length;
+}
+
+void MeshClient::setupRequest(CURL* handle, const std::string& channel, ChannelReceiver& receiver)
+{
+  // resetting the options keeps the handle's open connection alive
+  curl_easy_reset(handle);
+  curl_easy_setopt(handle, CURLOPT_URL, server_url_.c_str());
+  const std::string post_body = buildJson(channel);
+  curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers_);
+  if (cache_)
+  {
+    // the request body contains the layer, the bounding box, the filters and the channel name
+    receiver.cache_key = ChannelCache::key(server_url_ + "\n" + post_body);
+    if (cache_->etag(receiver.cache_key, receiver.cached_etag))
+    {
+      receiver.request_headers = curl_slist_append(receiver.request_headers, "Content-Type: application/json");
+      const std::string if_none_match = "If-None-Match: " + receiver.cached_etag;
+      receiver.request_headers = curl_slist_append(receiver.request_headers, if_none_match.c_str());
+      curl_easy_setopt(handle, CURLOPT_HTTPHEADER, receiver.request_headers);
+    }
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, &MeshClient::headerFunction);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, &receiver);
   }
+  curl_easy_setopt(handle, CURLOPT_COPYPOSTFIELDS, post_body.c_str());
+  curl_easy_setopt(handle, CURLOPT_HTTPAUTH, CURLAUTH_ANY);
+  std::string usr_pwd = server_username_ + ":" + server_password_;
+  curl_easy_setopt(handle, CURLOPT_USERPWD, usr_pwd.c_str());
+  curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &MeshClient::writeFunction);
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, &receiver);
+}
 
-  std::string post_body = buildJson(channel);
-  curl_easy_setopt(curl, CURLOPT_URL, server_url_.c_str());
+bool MeshClient::requestSucceeded(CURL* handle, CURLcode result, const std::string& channel,
+                                  ChannelReceiver& receiver)
+{
+  if (result != CURLE_OK)
+  {
+    ROS_ERROR_STREAM("Request of the channel \"" << channel << "\" failed: " << curl_easy_strerror(result));
+    return false;
+  }
+  long response_code = 0;
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response_code);
+  if (response_code == 304 && !receiver.cached_etag.empty())
+  {
+    if (loadCached(receiver))
+    {
+      ROS_INFO_STREAM("The channel \"" << channel << "\" is unmodified, loaded it from the cache.");
+      return true;
+    }
+    ROS_ERROR_STREAM("Could not load the cached channel \"" << channel << "\"!");
+    return false;
+  }
+  if (response_code >= 400)
+  {
+    ROS_WARN_STREAM("The server responded with code " << response_code << " to the request of the channel \""
+                                                      << channel << "\".");
+    return false;
+  }
+  if (!receiver.complete())
+  {
+    ROS_ERROR_STREAM("The channel \"" << channel << "\" has been received incompletely.");
+    return false;
+  }
+  if (cache_ && !receiver.etag.empty())
+  {
+    cache_->store(receiver.cache_key, receiver.etag, receiver.type, receiver.size, receiver.width, receiver.data,
+                  receiver.data_size);
+  }
+  return true;
+}
+
+bool MeshClient::loadCached(ChannelReceiver& receiver)
+{
+  ChannelCache::Entry entry;
+  if (!cache_ || !cache_->load(receiver.cache_key, entry))
+    return false;
 
-  struct curl_slist* list = curl_slist_append(list, "Content-Type: application/json");
+  // the channel buffers keep the mapping alive
+  const std::shared_ptr<void> mapping = entry.mapping;
+  size_t element_size = 0;
+  switch (entry.type)
+  {
+    case Type::FLOAT:
+      receiver.float_data = boost::shared_array<float>(static_cast<float*>(entry.data), [mapping](float*) {});
+      element_size = sizeof(float);
+      break;
+    case Type::UINT:
+      receiver.index_data =
+          boost::shared_array<lvr2::Index>(static_cast<lvr2::Index*>(entry.data), [mapping](lvr2::Index*) {});
+      element_size = sizeof(lvr2::Index);
+      break;
+    case Type::UCHAR:
+      receiver.uchar_data =
+          boost::shared_array<unsigned char>(static_cast<unsigned char*>(entry.data), [mapping](unsigned char*) {});
+      element_size = sizeof(unsigned char);
+      break;
+    default:
+      return false;
+  }
 
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list);
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_body.c_str());
-  curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_ANY);
-  std::string usr_pwd = server_username_ + ":" + server_password_;
-  curl_easy_setopt(curl, CURLOPT_USERPWD, usr_pwd.c_str());
+  if (entry.size * entry.width * element_size != entry.data_size)
+    return false;
+
+  receiver.type = entry.type;
+  receiver.size = entry.size;
+  receiver.width = entry.width;
+  receiver.data = static_cast<char*>(entry.data);
+  receiver.header_received = ChannelReceiver::HEADER_SIZE;
+  receiver.data_size = receiver.data_received = entry.data_size;
+  return true;
+}
 
-  unique_ptr<std::string> result = std::make_unique<std::string>();
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeFunction);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, result.get());
+size_t MeshClient::headerFunction(char* buffer, size_t size, size_t nitems, ChannelReceiver* receiver)
+{
+  const size_t length = size * nitems;
+  const char name[] = "ETag:";
+  const size_t name_length = sizeof(name) - 1;
+  if (length > name_length && strncasecmp(buffer, name, name_length) == 0)
+  {
+    std::string value(buffer + name_length, length - name_length);
+    const size_t begin = value.find_first_not_of(" \t");
+    const size_t end = value.find_last_not_of(" \t\r\n");
+    receiver->etag = begin == std::string::npos ? std::string() : value.substr(begin, end - begin + 1);
+  }
+  return length;
+}
+
+bool MeshClient::prefetchChannels(const std::vector<std::string>& channels)
+{
+  if (!multi_handle_)
+    return false;
 
-  CURLcode res = curl_easy_perform(curl);
-  if (res != CURLE_OK)
+  while (handles_.size() < channels.size())
   {
-    std::cout << "error" << std::endl;
-    curl_easy_cleanup(curl);
-    return nullptr;
+    CURL* handle = curl_easy_init();
+    if (!handle)
+      return false;
+    handles_.push_back(handle);
   }
 
-  curl_easy_cleanup(curl);
-  return result;
+  std::vector<std::unique_ptr<ChannelReceiver>> receivers(channels.size());
+  for (size_t i = 0; i < channels.size(); i++)
+  {
+    receivers[i] = std::make_unique<ChannelReceiver>();
+    setupRequest(handles_[i], channels[i], *receivers[i]);
+    curl_multi_add_handle(multi_handle_, handles_[i]);
+  }
+
+  int running = 0;
+  do
+  {
+    CURLMcode code = curl_multi_perform(multi_handle_, &running);
+    if (code == CURLM_OK && running)
+    {
+      code = curl_multi_wait(multi_handle_, nullptr, 0, 1000, nullptr);
+    }
+    if (code != CURLM_OK)
+    {
+      ROS_ERROR_STREAM("Concurrent channel requests failed: " << curl_multi_strerror(code));
+      break;
+    }
+  } while (running);
+
+  bool success = true;
+  std::vector<bool> received(channels.size(), false);
+  int msgs_left = 0;
+  while (CURLMsg* msg = curl_multi_info_read(multi_handle_, &msgs_left))
+  {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+    const size_t i = std::find(handles_.begin(), handles_.end(), msg->easy_handle) - handles_.begin();
+    if (i < channels.size() && requestSucceeded(msg->easy_handle, msg->data.result, channels[i], *receivers[i]))
+    {
+      received[i] = true;
+      prefetched_channels[channels[i]] = std::move(receivers[i]);
+    }
+  }
+
+  for (size_t i = 0; i < channels.size(); i++)
+  {
+    curl_multi_remove_handle(multi_handle_, handles_[i]);
+    success &= received[i];
+  }
+  return success;
+}
+
+std::unique_ptr<MeshClient::ChannelReceiver> MeshClient::requestChannel(std::string channel)
+{
+  auto prefetched = prefetched_channels.find(channel);
+  if (prefetched != prefetched_channels.end())
+  {
+    std::unique_ptr<ChannelReceiver> receiver = std::move(prefetched->second);
+    prefetched_channels.erase(prefetched);
+    return receiver;
+  }
+
+  if (handles_.empty())
+  {
+    CURL* handle = curl_easy_init();
+    if (!handle)
+      return nullptr;
+    handles_.push_back(handle);
+  }
+
+  CURL* handle = handles_.front();
+  std::unique_ptr<ChannelReceiver> receiver = std::make_unique<ChannelReceiver>();
+  setupRequest(handle, channel, *receiver);
+
+  if (!requestSucceeded(handle, curl_easy_perform(handle), channel, *receiver))
+  {
+    return nullptr;
+  }
+  return receiver;
 }
 
 } /* namespace mesh_client */
@@ -0,0 +1,714 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "mesh_client/reference_server.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <jsoncpp/json/json.h>
+#include <limits>
+#include <lvr2/io/hdf5/MeshIO.hpp>
+#include <mesh_client/channel_cache.h>
+#include <mesh_client/channel_codec.h>
+#include <mesh_client/mesh_client.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <ros/ros.h>
+#include <sstream>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mesh_client
+{
+using HDF5MeshIO = lvr2::Hdf5IO<lvr2::hdf5features::ArrayIO, lvr2::hdf5features::ChannelIO,
+                                lvr2::hdf5features::VariantChannelIO, lvr2::hdf5features::MeshIO>;
+
+namespace
+{
+//! the attribute groups searched for requested channels in the map file
+const std::vector<std::string> CHANNEL_GROUPS = { "vertex_attributes", "face_attributes", "channels" };
+
+//! the number of cached selections, e.g. of the bounding boxes which are currently requested
+const size_t MAX_SELECTIONS = 16;
+
+const lvr2::Index INVALID_INDEX = std::numeric_limits<lvr2::Index>::max();
+
+/**
+ * @brief Builds a raw payload of the given type
+ */
+template <typename T>
+std::string rawPayload(const MeshClient::Type type, const std::vector<T>& values, const uint64_t width)
+{
+  const uint64_t size = width ? values.size() / width : 0;
+  std::string payload(17, '\0');
+  payload[0] = type;
+  std::memcpy(&payload[1], &size, sizeof(uint64_t));
+  std::memcpy(&payload[9], &width, sizeof(uint64_t));
+  payload.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  return payload;
+}
+
+/**
+ * @brief Gathers the values of the selected elements, all elements if the channel is neither a vertex nor a face
+ * channel of the mesh
+ */
+template <typename T>
+std::vector<T> gather(const lvr2::Channel<T>& channel, const std::vector<lvr2::Index>& vertices,
+                      const std::vector<lvr2::Index>& faces, const size_t num_vertices, const size_t num_faces)
+{
+  const T* data = channel.dataPtr().get();
+  const size_t width = channel.width();
+  const std::vector<lvr2::Index>* elements = nullptr;
+  if (channel.numElements() == num_vertices)
+    elements = &vertices;
+  else if (channel.numElements() == num_faces)
+    elements = &faces;
+
+  if (!elements)
+    return std::vector<T>(data, data + channel.numElements() * width);
+
+  std::vector<T> values;
+  values.reserve(elements->size() * width);
+  for (const lvr2::Index element : *elements)
+  {
+    values.insert(values.end(), data + element * width, data + (element + 1) * width);
+  }
+  return values;
+}
+
+/**
+ * @brief Sends the complete buffer
+ */
+bool sendAll(const int fd, const char* data, size_t length)
+{
+  while (length > 0)
+  {
+    const ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+    if (sent <= 0)
+      return false;
+    data += sent;
+    length -= sent;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the trimmed value of the header line if it has the given name
+ */
+bool headerValue(const std::string& line, const std::string& name, std::string& value)
+{
+  if (line.size() <= name.size() || line[name.size()] != ':' || strncasecmp(line.c_str(), name.c_str(), name.size()))
+    return false;
+  const size_t begin = line.find_first_not_of(" \t", name.size() + 1);
+  const size_t end = line.find_last_not_of(" \t\r");
+  value = begin == std::string::npos ? std::string() : line.substr(begin, end - begin + 1);
+  return true;
+}
+}  // namespace
+
+ReferenceServer::ReferenceServer() : running_(false), listen_fd_(-1), port_(0)
+{
+}
+
+ReferenceServer::~ReferenceServer()
+{
+  stop();
+}
+
+bool ReferenceServer::loadMap(const std::string& file, const std::string& part)
+{
+  std::lock_guard<std::mutex> lock(channels_mtx_);
+  try
+  {
+    HDF5MeshIO* hdf_5_mesh_io = new HDF5MeshIO();
+    io_ = std::shared_ptr<lvr2::AttributeMeshIOBase>(hdf_5_mesh_io);
+    hdf_5_mesh_io->open(file);
+    hdf_5_mesh_io->setMeshName(part);
+    auto vertices_opt = io_->getVertices();
+    auto indices_opt = io_->getIndices();
+    if (!vertices_opt || !indices_opt || vertices_opt->width() != 3 || indices_opt->width() != 3)
+    {
+      ROS_ERROR_STREAM("Could not read the mesh \"" << part << "\" from the map file \"" << file << "\"!");
+      return false;
+    }
+    vertices_ = std::make_unique<lvr2::FloatChannel>(*vertices_opt);
+    indices_ = std::make_unique<lvr2::IndexChannel>(*indices_opt);
+  }
+  catch (const std::exception& e)
+  {
+    ROS_ERROR_STREAM("Could not open the map file \"" << file << "\": " << e.what());
+    return false;
+  }
+  float_channels_.clear();
+  index_channels_.clear();
+  uchar_channels_.clear();
+  ROS_INFO_STREAM("Serving the mesh \"" << part << "\" with " << vertices_->numElements() << " vertices and "
+                                        << indices_->numElements() << " faces.");
+  return true;
+}
+
+void ReferenceServer::generateGrid(const size_t resolution, const float spacing)
+{
+  std::lock_guard<std::mutex> lock(channels_mtx_);
+  io_.reset();
+  float_channels_.clear();
+  index_channels_.clear();
+  uchar_channels_.clear();
+
+  const size_t n = std::max<size_t>(resolution, 2);
+  const size_t num_vertices = n * n;
+  const size_t num_faces = 2 * (n - 1) * (n - 1);
+  vertices_ = std::make_unique<lvr2::FloatChannel>(num_vertices, 3);
+  indices_ = std::make_unique<lvr2::IndexChannel>(num_faces, 3);
+  lvr2::FloatChannel vertex_normals(num_vertices, 3);
+  lvr2::FloatChannel face_normals(num_faces, 3);
+  lvr2::FloatChannel roughness(num_vertices, 1);
+  lvr2::FloatChannel height_diff(num_vertices, 1);
+
+  // a wavy surface with analytic normals
+  float* vertices = vertices_->dataPtr().get();
+  for (size_t j = 0; j < n; j++)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      const size_t v = j * n + i;
+      const float x = i * spacing;
+      const float y = j * spacing;
+      vertices[3 * v] = x;
+      vertices[3 * v + 1] = y;
+      vertices[3 * v + 2] = 0.25f * std::sin(0.5f * x) * std::cos(0.5f * y);
+      const float dx = 0.125f * std::cos(0.5f * x) * std::cos(0.5f * y);
+      const float dy = -0.125f * std::sin(0.5f * x) * std::sin(0.5f * y);
+      const float norm = std::sqrt(dx * dx + dy * dy + 1);
+      vertex_normals.dataPtr()[3 * v] = -dx / norm;
+      vertex_normals.dataPtr()[3 * v + 1] = -dy / norm;
+      vertex_normals.dataPtr()[3 * v + 2] = 1 / norm;
+      roughness.dataPtr()[v] = 1 - 1 / norm;
+      height_diff.dataPtr()[v] = std::sqrt(dx * dx + dy * dy) * spacing;
+    }
+  }
+
+  lvr2::Index* indices = indices_->dataPtr().get();
+  size_t f = 0;
+  for (size_t j = 0; j + 1 < n; j++)
+  {
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+      const lvr2::Index a = j * n + i;
+      const lvr2::Index b = a + 1;
+      const lvr2::Index c = a + n;
+      const lvr2::Index d = c + 1;
+      for (const auto& face : { std::array<lvr2::Index, 3>{ a, b, c }, std::array<lvr2::Index, 3>{ b, d, c } })
+      {
+        std::copy(face.begin(), face.end(), indices + 3 * f);
+        const float* p0 = vertices + 3 * face[0];
+        const float* p1 = vertices + 3 * face[1];
+        const float* p2 = vertices + 3 * face[2];
+        const float u[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const float w[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        const float normal[3] = { u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0] };
+        const float norm = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (size_t k = 0; k < 3; k++)
+        {
+          face_normals.dataPtr()[3 * f + k] = normal[k] / norm;
+        }
+        f++;
+      }
+    }
+  }
+
+  float_channels_["vertex_normals"] = vertex_normals;
+  float_channels_["face_normals"] = face_normals;
+  float_channels_["roughness"] = roughness;
+  float_channels_["height_diff"] = height_diff;
+  ROS_INFO_STREAM("Serving a generated grid with " << num_vertices << " vertices and " << num_faces << " faces.");
+}
+
+bool ReferenceServer::start(const uint16_t port)
+{
+  if (running_ || !vertices_ || !indices_)
+    return false;
+
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0)
+    return false;
+  const int reuse = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  // the reference server is meant for local tests only
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  socklen_t address_length = sizeof(address);
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listen_fd_, 16) < 0 ||
+      getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &address_length) < 0)
+  {
+    ROS_ERROR_STREAM("Could not listen on port " << port << ": " << std::strerror(errno));
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+  port_ = ntohs(address.sin_port);
+  running_ = true;
+  accept_thread_ = std::thread(&ReferenceServer::acceptLoop, this);
+  ROS_INFO_STREAM("The reference server listens on " << url());
+  return true;
+}
+
+void ReferenceServer::stop()
+{
+  if (!running_.exchange(false))
+    return;
+
+  // shutting the sockets down wakes the blocked accept and recv calls
+  shutdown(listen_fd_, SHUT_RDWR);
+  if (accept_thread_.joinable())
+    accept_thread_.join();
+  close(listen_fd_);
+  listen_fd_ = -1;
+
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(connections_mtx_);
+    for (const int fd : connection_fds_)
+    {
+      shutdown(fd, SHUT_RDWR);
+    }
+    threads.swap(connection_threads_);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+std::string ReferenceServer::url() const
+{
+  return "http://127.0.0.1:" + std::to_string(port_);
+}
+
+void ReferenceServer::acceptLoop()
+{
+  while (running_)
+  {
+    const int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    const int no_delay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+    std::lock_guard<std::mutex> lock(connections_mtx_);
+    if (!running_)
+    {
+      close(fd);
+      break;
+    }
+    connection_fds_.insert(fd);
+    connection_threads_.emplace_back(&ReferenceServer::serveConnection, this, fd);
+  }
+}
+
+void ReferenceServer::serveConnection(const int fd)
+{
+  std::string buffer;
+  std::vector<char> chunk(1 << 16);
+  const auto receive = [&]() {
+    const ssize_t received = recv(fd, chunk.data(), chunk.size(), 0);
+    if (received <= 0)
+      return false;
+    buffer.append(chunk.data(), received);
+    return true;
+  };
+
+  bool keep_alive = true;
+  while (keep_alive && running_)
+  {
+    size_t header_end;
+    bool connected = true;
+    while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos && (connected = receive()))
+    {
+    }
+    if (!connected)
+      break;
+
+    std::istringstream header_stream(buffer.substr(0, header_end));
+    std::string request_line, line, value, if_none_match;
+    std::getline(header_stream, request_line);
+    size_t content_length = 0;
+    bool expect_continue = false;
+    while (std::getline(header_stream, line))
+    {
+      if (headerValue(line, "Content-Length", value))
+        content_length = std::strtoul(value.c_str(), nullptr, 10);
+      else if (headerValue(line, "If-None-Match", value))
+        if_none_match = value;
+      else if (headerValue(line, "Expect", value))
+        expect_continue = strcasecmp(value.c_str(), "100-continue") == 0;
+      else if (headerValue(line, "Connection", value))
+        keep_alive = strcasecmp(value.c_str(), "close") != 0;
+    }
+
+    // curl waits for the interim response before it sends larger request bodies
+    const size_t request_size = header_end + 4 + content_length;
+    if (expect_continue && buffer.size() < request_size)
+    {
+      const std::string interim = "HTTP/1.1 100 Continue\r\n\r\n";
+      sendAll(fd, interim.data(), interim.size());
+    }
+    while (buffer.size() < request_size && (connected = receive()))
+    {
+    }
+    if (!connected)
+      break;
+    const std::string body = buffer.substr(header_end + 4, content_length);
+    buffer.erase(0, request_size);
+
+    int status = 200;
+    std::string etag, payload;
+    if (request_line.compare(0, 5, "POST ") != 0)
+      status = 405;
+    else
+      payload = respond(body, if_none_match, status, etag);
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << (status == 200 ? " OK" : status == 304 ? " Not Modified" : " Error") << "\r\n"
+             << "Content-Type: application/octet-stream\r\n"
+             << "Content-Length: " << payload.size() << "\r\n";
+    if (!etag.empty())
+      response << "ETag: " << etag << "\r\n";
+    response << (keep_alive ? "Connection: keep-alive" : "Connection: close") << "\r\n\r\n";
+    const std::string header = response.str();
+    if (!sendAll(fd, header.data(), header.size()) || !sendAll(fd, payload.data(), payload.size()))
+      break;
+  }
+
+  std::lock_guard<std::mutex> lock(connections_mtx_);
+  connection_fds_.erase(fd);
+  close(fd);
+}
+
+std::string ReferenceServer::respond(const std::string& body, const std::string& if_none_match, int& status,
+                                     std::string& etag)
+{
+  Json::Value request;
+  Json::Reader reader;
+  if (!reader.parse(body, request) || !request.isObject())
+  {
+    status = 400;
+    return std::string();
+  }
+
+  const Json::Value& attribute = request["attribute"];
+  const std::string name = attribute["name"].asString();
+
+  std::array<float, 6> bounding_box = { 0, 0, 0, 0, 0, 0 };
+  const Json::Value& json_bb = request["boundingbox"];
+  const char* bb_keys[] = { "x_min", "y_min", "z_min", "x_max", "y_max", "z_max" };
+  for (size_t i = 0; i < bounding_box.size(); i++)
+  {
+    bounding_box[i] = json_bb[bb_keys[i]].asFloat();
+  }
+
+  std::map<std::string, std::pair<float, float>> filters;
+  for (const Json::Value& filter : attribute["filters"])
+  {
+    filters[filter["attribute_name"].asString()] =
+        std::make_pair(filter["min_val"].asFloat(), filter["max_val"].asFloat());
+  }
+
+  std::set<std::string> encodings;
+  for (const Json::Value& encoding : request["encodings"])
+  {
+    encodings.insert(encoding.asString());
+  }
+
+  std::string payload;
+  if (!encodeChannel(name, *select(bounding_box, filters), encodings, payload))
+  {
+    status = 404;
+    return std::string();
+  }
+
+  etag = "\"" + ChannelCache::key(payload) + "\"";
+  if (etag == if_none_match)
+  {
+    status = 304;
+    return std::string();
+  }
+  status = 200;
+  return payload;
+}
+
+bool ReferenceServer::encodeChannel(const std::string& name, const Selection& selection,
+                                    const std::set<std::string>& encodings, std::string& payload)
+{
+  const size_t num_vertices = vertices_->numElements();
+  const size_t num_faces = indices_->numElements();
+  const bool quantized16 = encodings.count("quantized16");
+  const bool quantized8 = encodings.count("quantized8");
+  const bool varint = encodings.count("varint");
+  bool encoded = false;
+
+  if (name == "vertices")
+  {
+    // the quantization range is the bounding box of the selected vertices
+    const std::vector<float> values = gather(*vertices_, selection.vertices, {}, num_vertices, 0);
+    encoded = quantized16;
+    payload = encoded ? encodeQuantized(values.data(), values.size() / 3, 3, QUANTIZED_16) :
+                        rawPayload(MeshClient::Type::FLOAT, values, 3);
+  }
+  else if (name == "face_indices")
+  {
+    std::vector<lvr2::Index> values = gather(*indices_, {}, selection.faces, 0, num_faces);
+    for (lvr2::Index& index : values)
+    {
+      index = selection.vertex_map[index];
+    }
+    encoded = varint;
+    payload = encoded ? encodeDeltaVarint(values.data(), values.size() / 3, 3) :
+                        rawPayload(MeshClient::Type::UINT, values, 3);
+  }
+  else if (const lvr2::FloatChannel* channel = floatChannel(name))
+  {
+    const std::vector<float> values = gather(*channel, selection.vertices, selection.faces, num_vertices, num_faces);
+    const size_t width = channel->width();
+    const size_t suffix = std::string("_normals").size();
+    // normals are unit vectors and tolerate the coarse quantization
+    const bool normals = name.size() > suffix && name.compare(name.size() - suffix, suffix, "_normals") == 0;
+    encoded = quantized16 || quantized8;
+    if (normals && quantized8)
+      payload = encodeQuantized(values.data(), values.size() / width, width, QUANTIZED_8);
+    else if (quantized16)
+      payload = encodeQuantized(values.data(), values.size() / width, width, QUANTIZED_16);
+    else
+      payload = rawPayload(MeshClient::Type::FLOAT, values, width);
+  }
+  else if (const lvr2::IndexChannel* channel = indexChannel(name))
+  {
+    const std::vector<lvr2::Index> values =
+        gather(*channel, selection.vertices, selection.faces, num_vertices, num_faces);
+    const size_t width = channel->width();
+    encoded = varint;
+    payload = encoded ? encodeDeltaVarint(values.data(), values.size() / width, width) :
+                        rawPayload(MeshClient::Type::UINT, values, width);
+  }
+  else if (const lvr2::UCharChannel* channel = ucharChannel(name))
+  {
+    const std::vector<unsigned char> values =
+        gather(*channel, selection.vertices, selection.faces, num_vertices, num_faces);
+    payload = rawPayload(MeshClient::Type::UCHAR, values, channel->width());
+  }
+  else
+  {
+    return false;
+  }
+
+  // only the compact encodings are decoded in a streaming fashion by the client
+  if (encoded && encodings.count("zstd"))
+    compressPayload(payload);
+  return true;
+}
+
+std::shared_ptr<const ReferenceServer::Selection>
+ReferenceServer::select(const std::array<float, 6>& bounding_box,
+                        const std::map<std::string, std::pair<float, float>>& filters)
+{
+  std::ostringstream key;
+  key.precision(9);
+  for (const float value : bounding_box)
+  {
+    key << value << " ";
+  }
+  for (const auto& filter : filters)
+  {
+    key << filter.first << " " << filter.second.first << " " << filter.second.second << " ";
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(selections_mtx_);
+    auto cached = selections_.find(key.str());
+    if (cached != selections_.end())
+      return cached->second;
+  }
+
+  const size_t num_vertices = vertices_->numElements();
+  const size_t num_faces = indices_->numElements();
+  const float* vertices = vertices_->dataPtr().get();
+  const lvr2::Index* indices = indices_->dataPtr().get();
+
+  // an axis of the bounding box only restricts the selection if it is not empty, as the default box of the client
+  std::vector<bool> inside(num_vertices, true);
+  for (size_t axis = 0; axis < 3; axis++)
+  {
+    const float min = bounding_box[axis];
+    const float max = bounding_box[axis + 3];
+    if (max <= min)
+      continue;
+    for (size_t v = 0; v < num_vertices; v++)
+    {
+      const float value = vertices[3 * v + axis];
+      inside[v] = inside[v] && value >= min && value <= max;
+    }
+  }
+
+  // filters with an empty range are disabled
+  std::vector<bool> valid(num_vertices, true);
+  for (const auto& filter : filters)
+  {
+    const float min = filter.second.first;
+    const float max = filter.second.second;
+    const lvr2::FloatChannel* channel = floatChannel(filter.first);
+    if (max <= min || !channel || channel->numElements() != num_vertices || channel->width() != 1)
+      continue;
+    const float* values = channel->dataPtr().get();
+    for (size_t v = 0; v < num_vertices; v++)
+    {
+      valid[v] = valid[v] && values[v] >= min && values[v] <= max;
+    }
+  }
+
+  // faces crossing the bounding box are selected completely
+  auto selection = std::make_shared<Selection>();
+  selection->vertex_map.assign(num_vertices, INVALID_INDEX);
+  for (size_t f = 0; f < num_faces; f++)
+  {
+    const lvr2::Index* face = indices + 3 * f;
+    if (face[0] >= num_vertices || face[1] >= num_vertices || face[2] >= num_vertices)
+      continue;
+    if (!(inside[face[0]] || inside[face[1]] || inside[face[2]]) || !(valid[face[0]] && valid[face[1]] && valid[face[2]]))
+      continue;
+    selection->faces.push_back(f);
+    for (size_t k = 0; k < 3; k++)
+    {
+      if (selection->vertex_map[face[k]] == INVALID_INDEX)
+      {
+        selection->vertex_map[face[k]] = selection->vertices.size();
+        selection->vertices.push_back(face[k]);
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(selections_mtx_);
+  if (selections_.size() >= MAX_SELECTIONS)
+    selections_.clear();
+  selections_[key.str()] = selection;
+  return selection;
+}
+
+const lvr2::FloatChannel* ReferenceServer::floatChannel(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(channels_mtx_);
+  auto channel = float_channels_.find(name);
+  if (channel != float_channels_.end())
+    return &channel->second;
+  if (!io_)
+    return nullptr;
+  for (const auto& group : CHANNEL_GROUPS)
+  {
+    lvr2::FloatChannelOptional channel_opt;
+    try
+    {
+      if (io_->getChannel(group, name, channel_opt) && channel_opt)
+        return &float_channels_.emplace(name, *channel_opt).first->second;
+    }
+    catch (const std::exception& e)
+    {
+      ROS_DEBUG_STREAM("Could not read the float channel \"" << group << "/" << name << "\": " << e.what());
+    }
+  }
+  return nullptr;
+}
+
+const lvr2::IndexChannel* ReferenceServer::indexChannel(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(channels_mtx_);
+  auto channel = index_channels_.find(name);
+  if (channel != index_channels_.end())
+    return &channel->second;
+  if (!io_)
+    return nullptr;
+  for (const auto& group : CHANNEL_GROUPS)
+  {
+    lvr2::IndexChannelOptional channel_opt;
+    try
+    {
+      if (io_->getChannel(group, name, channel_opt) && channel_opt)
+        return &index_channels_.emplace(name, *channel_opt).first->second;
+    }
+    catch (const std::exception& e)
+    {
+      ROS_DEBUG_STREAM("Could not read the index channel \"" << group << "/" << name << "\": " << e.what());
+    }
+  }
+  return nullptr;
+}
+
+const lvr2::UCharChannel* ReferenceServer::ucharChannel(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(channels_mtx_);
+  auto channel = uchar_channels_.find(name);
+  if (channel != uchar_channels_.end())
+    return &channel->second;
+  if (!io_)
+    return nullptr;
+  for (const auto& group : CHANNEL_GROUPS)
+  {
+    lvr2::UCharChannelOptional channel_opt;
+    try
+    {
+      if (io_->getChannel(group, name, channel_opt) && channel_opt)
+        return &uchar_channels_.emplace(name, *channel_opt).first->second;
+    }
+    catch (const std::exception& e)
+    {
+      ROS_DEBUG_STREAM("Could not read the unsigned char channel \"" << group << "/" << name << "\": " << e.what());
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace mesh_client
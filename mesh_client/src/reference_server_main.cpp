@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <mesh_client/reference_server.h>
+#include <string>
+#include <thread>
+
+namespace
+{
+std::atomic<bool> shutdown_requested(false);
+
+void signalHandler(int)
+{
+  shutdown_requested = true;
+}
+
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [--port PORT] (--map FILE --part NAME | --grid RESOLUTION [--spacing S])"
+            << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int port = 8080;
+  std::string map_file, mesh_part;
+  size_t grid_resolution = 0;
+  float grid_spacing = 0.1;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    const std::string option = argv[i];
+    if (option == "--port")
+      port = std::atoi(argv[i + 1]);
+    else if (option == "--map")
+      map_file = argv[i + 1];
+    else if (option == "--part")
+      mesh_part = argv[i + 1];
+    else if (option == "--grid")
+      grid_resolution = std::strtoul(argv[i + 1], nullptr, 10);
+    else if (option == "--spacing")
+      grid_spacing = std::atof(argv[i + 1]);
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  mesh_client::ReferenceServer server;
+  if (grid_resolution > 0)
+  {
+    server.generateGrid(grid_resolution, grid_spacing);
+  }
+  else if (map_file.empty() || mesh_part.empty() || !server.loadMap(map_file, mesh_part))
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (port < 0 || port > 65535 || !server.start(port))
+    return EXIT_FAILURE;
+
+  std::signal(SIGINT, signalHandler);
+  std::signal(SIGTERM, signalHandler);
+  while (!shutdown_requested)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  server.stop();
+  return EXIT_SUCCESS;
+}
@@ -138,6 +138,18 @@ public:
       const mesh_map::Normal& mesh_normal,
       const float& mesh_cost);
 
+  /**
+   * @brief Moves the plan index forward to the plan position closest to the robot, searching only a window of
+   * positions ahead of the current index
+   * @return The distance between the robot and the closest plan position
+   */
+  float updatePlanProgress();
+
+  /**
+   * @brief Returns the plan position which lies the lookahead distance ahead of the current plan index
+   */
+  mesh_map::Vector lookaheadPosition();
+
   /**
    * @brief reconfigure callback function which is called if a dynamic reconfiguration were triggered.
    */
@@ -161,6 +173,15 @@ private:
   //! the current set plan
   vector<geometry_msgs::PoseStamped> current_plan;
 
+  //! the positions of the current plan
+  std::vector<mesh_map::Vector> plan_positions;
+
+  //! the arc length from the plan's start to each plan position
+  std::vector<float> plan_lengths;
+
+  //! index of the plan position closest to the robot, it only moves forward
+  size_t plan_index;
+
   //! the goal and robot pose
   mesh_map::Vector goal_pos, robot_pos;
 
@@ -0,0 +1,202 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_NAVIGATION__ROLLOUT_CONTROLLER_H
+#define MESH_NAVIGATION__ROLLOUT_CONTROLLER_H
+
+#include <mbf_mesh_core/mesh_controller.h>
+#include <mesh_controller/RolloutControllerConfig.h>
+#include <mesh_map/mesh_map.h>
+
+namespace mesh_controller
+{
+/**
+ * @brief A controller which samples velocity commands within the acceleration limits, rolls out the resulting
+ * trajectories on the mesh surface and selects the command whose trajectory is best aligned with the planner's vector
+ * field while passing the lowest vertex costs. The rollouts are computed in parallel on preallocated buffers.
+ */
+class RolloutController : public mbf_mesh_core::MeshController
+{
+public:
+  //! shared pointer typedef to simplify pointer access of the rollout controller
+  typedef boost::shared_ptr<mesh_controller::RolloutController> Ptr;
+
+  /**
+   * @brief Constructor
+   */
+  RolloutController();
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~RolloutController();
+
+  /**
+   * @brief Given the current position, orientation, and velocity of the robot,
+   * compute the next velocity commands to move the robot towards the goal.
+   * @param pose The current pose of the robot
+   * @param velocity The current velocity of the robot
+   * @param cmd_vel Computed velocity command
+   * @param message Detailed outcome as string message
+   * @return An mbf_msgs/ExePathResult outcome code
+   */
+  virtual uint32_t computeVelocityCommands(const geometry_msgs::PoseStamped& pose,
+                                           const geometry_msgs::TwistStamped& velocity,
+                                           geometry_msgs::TwistStamped& cmd_vel, std::string& message);
+
+  /**
+   * @brief Checks if the robot reached to goal pose
+   * @param dist_tolerance The distance tolerance in which the current pose will be accepted as reached goal
+   * @param angle_tolerance The angle tolerance in which the current pose will be accepted as reached goal
+   * @return true if the goal is reached
+   */
+  virtual bool isGoalReached(double dist_tolerance, double angle_tolerance);
+
+  /**
+   * @brief Sets the current plan to follow, it also sets the vector field
+   * @param plan The plan to follow
+   * @return true if the plan was set successfully, false otherwise
+   */
+  virtual bool setPlan(const std::vector<geometry_msgs::PoseStamped>& plan);
+
+  /**
+   * @brief Requests the controller to cancel
+   * @return True if cancel has been successfully requested, false otherwise
+   */
+  virtual bool cancel();
+
+  /**
+   * @brief Initializes the controller plugin with a name, a tf pointer and a mesh map pointer
+   * @param plugin_name The controller plugin name, defined by the user. It defines the controller namespace
+   * @param tf_ptr A shared pointer to a transformation buffer
+   * @param mesh_map_ptr A shared pointer to the mesh map
+   * @return true if the plugin has been initialized successfully
+   */
+  virtual bool initialize(const std::string& plugin_name, const boost::shared_ptr<tf2_ros::Buffer>& tf_ptr,
+                          const boost::shared_ptr<mesh_map::MeshMap>& mesh_map_ptr);
+
+private:
+  //! a sampled velocity command and the score of its rollout
+  struct Rollout
+  {
+    //! linear velocity
+    float linear;
+
+    //! angular velocity
+    float angular;
+
+    //! score of the trajectory, lower is better
+    float score;
+
+    //! whether the trajectory stays on the passable mesh
+    bool valid;
+
+    //! trajectory positions, preallocated with the number of simulation steps
+    std::vector<mesh_map::Vector> positions;
+  };
+
+  /**
+   * @brief Locates the robot position on the mesh, starting at the current face
+   * @param bary_coords The barycentric coordinates of the robot position on the found face
+   * @return true if the robot could be located
+   */
+  bool locateRobot(std::array<float, 3>& bary_coords);
+
+  /**
+   * @brief Simulates the sampled command of the given rollout on the mesh surface and scores the trajectory
+   * @param rollout The rollout to simulate, its score and positions are updated
+   * @param start_face The face of the robot position
+   */
+  void simulate(Rollout& rollout, const lvr2::FaceHandle& start_face);
+
+  /**
+   * @brief Resizes the rollout buffers to the configured number of samples and simulation steps
+   */
+  void allocateRollouts();
+
+  /**
+   * @brief reconfigure callback function which is called if a dynamic reconfiguration were triggered.
+   */
+  void reconfigureCallback(mesh_controller::RolloutControllerConfig& cfg, uint32_t level);
+
+  /**
+   * Converts the orientation of a geometry_msgs/PoseStamped message to a direction vector
+   */
+  mesh_map::Normal poseToDirectionVector(const geometry_msgs::PoseStamped& pose,
+                                         const tf2::Vector3& axis = tf2::Vector3(1, 0, 0));
+
+  /**
+   * Converts the position of a geometry_msgs/PoseStamped message to a position vector
+   */
+  mesh_map::Vector poseToPositionVector(const geometry_msgs::PoseStamped& pose);
+
+  //! shared pointer to the used mesh map
+  boost::shared_ptr<mesh_map::MeshMap> map_ptr;
+
+  //! the goal and robot pose
+  mesh_map::Vector goal_pos, robot_pos;
+
+  //! the goal's and robot's orientation
+  mesh_map::Normal goal_dir, robot_dir;
+
+  //! The triangle on which the robot is located
+  lvr2::OptionalFaceHandle current_face;
+
+  //! The vector field to the goal.
+  lvr2::DenseVertexMap<mesh_map::Vector> vector_map;
+
+  //! the sampled commands and their trajectories
+  std::vector<Rollout> rollouts;
+
+  //! shared pointer to dynamic reconfigure server
+  boost::shared_ptr<dynamic_reconfigure::Server<mesh_controller::RolloutControllerConfig>> reconfigure_server_ptr;
+
+  //! dynamic reconfigure callback function binding
+  dynamic_reconfigure::Server<mesh_controller::RolloutControllerConfig>::CallbackType config_callback;
+
+  //! current rollout controller configuration
+  RolloutControllerConfig config;
+
+  //! guards the configuration and the rollout buffers
+  std::mutex config_mtx;
+
+  //! flag to handle cancel requests
+  std::atomic_bool cancel_requested;
+};
+
+} /* namespace mesh_controller */
+#endif /* MESH_NAVIGATION__ROLLOUT_CONTROLLER_H */
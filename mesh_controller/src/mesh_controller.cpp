@@ -35,6 +35,8 @@
  *
  */
 
+#include <algorithm>
+#include <limits>
 #include <lvr2/geometry/HalfEdgeMesh.hpp>
 #include <lvr2/util/Meap.hpp>
 #include <mbf_msgs/ExePathResult.h>
@@ -48,13 +50,15 @@
 
 PLUGINLIB_EXPORT_CLASS(mesh_controller::MeshController, mbf_mesh_core::MeshController);
 
-#define DEBUG
-
-#ifdef DEBUG
-#define DEBUG_CALL(method) method
-#else
-#define DEBUG_CALL(method)
-#endif
+// debug output is enabled at runtime by the mesh map's debug_markers parameter
+#define DEBUG_CALL(method)       \
+  do                             \
+  {                              \
+    if (map_ptr->debugEnabled()) \
+    {                            \
+      method;                    \
+    }                            \
+  } while (0)
 
 namespace mesh_controller
 {
@@ -101,8 +105,8 @@ uint32_t MeshController::computeVelocityCommands(const geometry_msgs::PoseStampe
   {
     lvr2::FaceHandle face = current_face.unwrap();
     vertices = mesh.getVertexPositionsOfFace(face);
-    DEBUG_CALL(map_ptr->publishDebugFace(face, mesh_map::color(1, 1, 1), "current_face");)
-    DEBUG_CALL(map_ptr->publishDebugPoint(robot_pos, mesh_map::color(1, 1, 1), "robot_position");)
+    DEBUG_CALL(map_ptr->publishDebugFace(face, mesh_map::color(1, 1, 1), "current_face"));
+    DEBUG_CALL(map_ptr->publishDebugPoint(robot_pos, mesh_map::color(1, 1, 1), "robot_position"));
 
     float dist_to_surface;
     // check whether or not the position matches the current face
@@ -112,10 +116,19 @@ uint32_t MeshController::computeVelocityCommands(const geometry_msgs::PoseStampe
         && dist_to_surface < config.max_search_distance)
     {
       // current position is located inside and close enough to the face
-      DEBUG_CALL(map_ptr->publishDebugPoint(robot_pos, mesh_map::color(0, 0, 1), "current_position");)
+      DEBUG_CALL(map_ptr->publishDebugPoint(robot_pos, mesh_map::color(0, 0, 1), "current_position"));
+    }
+    else if (map_ptr->walkToFace(robot_pos, face, bary_coords, dist_to_surface, config.max_walk_steps)
+             && std::abs(dist_to_surface) < config.max_search_distance)
+    {
+      // the face has been reached by walking across the edges of the current face
+      current_face = face;
+      vertices = mesh.getVertexPositionsOfFace(face);
+      robot_pos = mesh_map::linearCombineBarycentricCoords(vertices, bary_coords);
+      DEBUG_CALL(map_ptr->publishDebugFace(face, mesh_map::color(1, 0.5, 0), "walk_face"));
     }
     else if (auto search_res_opt = map_ptr->searchNeighbourFaces(
-                 robot_pos, face, config.max_search_radius, config.max_search_distance))
+                 robot_pos, current_face.unwrap(), config.max_search_radius, config.max_search_distance))
     {
       // new face has been found out of the neighbour faces of the current face
       // update variables to new face
@@ -124,8 +137,8 @@ uint32_t MeshController::computeVelocityCommands(const geometry_msgs::PoseStampe
       vertices = std::get<1>(search_res);
       bary_coords = std::get<2>(search_res);
       robot_pos = mesh_map::linearCombineBarycentricCoords(vertices, bary_coords);
-      DEBUG_CALL(map_ptr->publishDebugFace(face, mesh_map::color(1, 0.5, 0), "search_neighbour_face");)
-      DEBUG_CALL(map_ptr->publishDebugPoint(robot_pos, mesh_map::color(0, 0, 1), "search_neighbour_pos");)
+      DEBUG_CALL(map_ptr->publishDebugFace(face, mesh_map::color(1, 0.5, 0), "search_neighbour_face"));
+      DEBUG_CALL(map_ptr->publishDebugPoint(robot_pos, mesh_map::color(0, 0, 1), "search_neighbour_pos"));
     }
     else if(auto search_res_opt = map_ptr->searchContainingFace(
         robot_pos, config.max_search_distance))
@@ -148,18 +161,50 @@ uint32_t MeshController::computeVelocityCommands(const geometry_msgs::PoseStampe
   std::array<lvr2::VertexHandle, 3> handles = map_ptr->mesh_ptr->getVerticesOfFace(face);
 
   // update to which position of the plan the robot is closest
+  const float path_distance = updatePlanProgress();
+  if (config.max_path_distance > 0 && path_distance > config.max_path_distance)
+  {
+    message = "The robot is too far away from the plan";
+    ROS_WARN_STREAM(message << ": " << path_distance << "m");
+    return mbf_msgs::ExePathResult::MISSED_PATH;
+  }
 
-  const auto& opt_dir = map_ptr->directionAtPosition(vector_map, handles, bary_coords);
-  if (!opt_dir)
+  // follow the plan's lookahead point if the robot is well aligned with it, otherwise turn towards the vector field
+  mesh_map::Normal mesh_dir;
+  bool aligned = false;
+  if (config.lookahead_distance > 0)
   {
-    DEBUG_CALL(map_ptr->publishDebugFace(face, mesh_map::color(0.3, 0.4, 0), "no_directions");)
-    ROS_ERROR_STREAM("Could not access vector field for the given face!");
-    return mbf_msgs::ExePathResult::FAILURE;
+    const mesh_map::Vector lookahead_dir = lookaheadPosition() - robot_pos;
+    if (lookahead_dir.length2() > 1e-12)
+    {
+      mesh_dir = lookahead_dir.normalized();
+      aligned = acos(std::max(-1.0f, std::min(1.0f, mesh_dir.dot(robot_dir)))) <= config.aligned_angle * M_PI / 180.0;
+    }
+  }
+
+  if (!aligned)
+  {
+    const auto& opt_dir = map_ptr->directionAtPosition(vector_map, handles, bary_coords);
+    if (!opt_dir)
+    {
+      DEBUG_CALL(map_ptr->publishDebugFace(face, mesh_map::color(0.3, 0.4, 0), "no_directions"));
+      ROS_ERROR_STREAM("Could not access vector field for the given face!");
+      return mbf_msgs::ExePathResult::FAILURE;
+    }
+    mesh_dir = opt_dir.get().normalized();
   }
-  mesh_map::Normal mesh_dir = opt_dir.get().normalized();
   float cost = map_ptr->costAtPosition(handles, bary_coords);
   const mesh_map::Normal& mesh_normal = poseToDirectionVector(pose, tf2::Vector3(0,0,1));
   std::array<float, 2> velocities = naiveControl(robot_pos, robot_dir, mesh_dir, mesh_normal, cost);
+
+  // fade down the linear velocity on the remaining part of the plan
+  if (config.arrival_fading > 0)
+  {
+    const float remaining =
+        plan_lengths.back() - plan_lengths[plan_index] + (plan_positions[plan_index] - robot_pos).length();
+    velocities[0] *= std::min(1.0f, remaining / static_cast<float>(config.arrival_fading));
+  }
+
   cmd_vel.twist.linear.x = std::min(config.max_lin_velocity, velocities[0] * config.lin_vel_factor);
   cmd_vel.twist.angular.z = std::min(config.max_ang_velocity, velocities[1] * config.ang_vel_factor);
   cmd_vel.header.stamp = ros::Time::now();
@@ -180,11 +225,29 @@ bool MeshController::isGoalReached(double dist_tolerance, double angle_tolerance
 
 bool MeshController::setPlan(const std::vector<geometry_msgs::PoseStamped>& plan)
 {
+  if (plan.empty())
+    return false;
+
   // copy vector field // TODO just use vector field without copying
   vector_map = map_ptr->getVectorMap();
-  DEBUG_CALL(map_ptr->publishDebugPoint(poseToPositionVector(plan.front()), mesh_map::color(0, 1, 0), "plan_start");)
-  DEBUG_CALL(map_ptr->publishDebugPoint(poseToPositionVector(plan.back()), mesh_map::color(1, 0, 0), "plan_goal");)
+  DEBUG_CALL(map_ptr->publishDebugPoint(poseToPositionVector(plan.front()), mesh_map::color(0, 1, 0), "plan_start"));
+  DEBUG_CALL(map_ptr->publishDebugPoint(poseToPositionVector(plan.back()), mesh_map::color(1, 0, 0), "plan_goal"));
   current_plan = plan;
+
+  // cache the plan positions and their arc length from the start for the progress tracking
+  plan_positions.clear();
+  plan_lengths.clear();
+  plan_positions.reserve(plan.size());
+  plan_lengths.reserve(plan.size());
+  for (const auto& pose : plan)
+  {
+    const mesh_map::Vector position = poseToPositionVector(pose);
+    plan_lengths.push_back(plan_positions.empty() ? 0 :
+                                                    plan_lengths.back() + (position - plan_positions.back()).length());
+    plan_positions.push_back(position);
+  }
+  plan_index = 0;
+
   goal_pos = poseToPositionVector(current_plan.back());
   goal_dir = poseToDirectionVector(current_plan.back());
 
@@ -194,6 +257,32 @@ bool MeshController::setPlan(const std::vector<geometry_msgs::PoseStamped>& plan
   return true;
 }
 
+float MeshController::updatePlanProgress()
+{
+  // the index only moves forward, thus only a window ahead of the last index has to be searched
+  const size_t window_end = std::min(plan_positions.size(), plan_index + config.progress_window + 1);
+  float min_dist = std::numeric_limits<float>::infinity();
+  size_t min_index = plan_index;
+  for (size_t i = plan_index; i < window_end; i++)
+  {
+    const float dist = plan_positions[i].distance2(robot_pos);
+    if (dist < min_dist)
+    {
+      min_dist = dist;
+      min_index = i;
+    }
+  }
+  plan_index = min_index;
+  return std::sqrt(min_dist);
+}
+
+mesh_map::Vector MeshController::lookaheadPosition()
+{
+  const float lookahead_length = plan_lengths[plan_index] + config.lookahead_distance;
+  const auto iter = std::lower_bound(plan_lengths.begin() + plan_index, plan_lengths.end(), lookahead_length);
+  return iter == plan_lengths.end() ? plan_positions.back() : plan_positions[iter - plan_lengths.begin()];
+}
+
 bool MeshController::cancel()
 {
   ROS_INFO_STREAM("The MeshController has been requested to cancel!");
@@ -229,7 +318,12 @@ std::array<float, 2> MeshController::naiveControl(
   float phi = acos(mesh_dir.dot(robot_dir));
   float sign_phi = mesh_dir.cross(robot_dir).dot(mesh_normal);
   // debug output angle between supposed and current angle
-  DEBUG_CALL(std_msgs::Float32 angle32; angle32.data = phi * 180 / M_PI; angle_pub.publish(angle32);)
+  if (map_ptr->debugEnabled())
+  {
+    std_msgs::Float32 angle32;
+    angle32.data = phi * 180 / M_PI;
+    angle_pub.publish(angle32);
+  }
 
   float angular_velocity = copysignf(phi * config.max_ang_velocity / M_PI, -sign_phi);
   const float max_angle = config.max_angle * M_PI / 180.0;
@@ -0,0 +1,294 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mbf_msgs/ExePathResult.h>
+#include <mesh_controller/rollout_controller.h>
+#include <mesh_map/util.h>
+#include <pluginlib/class_list_macros.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+
+PLUGINLIB_EXPORT_CLASS(mesh_controller::RolloutController, mbf_mesh_core::MeshController);
+
+namespace mesh_controller
+{
+RolloutController::RolloutController()
+{
+}
+
+RolloutController::~RolloutController()
+{
+}
+
+uint32_t RolloutController::computeVelocityCommands(const geometry_msgs::PoseStamped& pose,
+                                                    const geometry_msgs::TwistStamped& velocity,
+                                                    geometry_msgs::TwistStamped& cmd_vel, std::string& message)
+{
+  robot_pos = poseToPositionVector(pose);
+  robot_dir = poseToDirectionVector(pose);
+
+  std::lock_guard<std::mutex> lock(config_mtx);
+
+  std::array<float, 3> bary_coords;
+  if (!locateRobot(bary_coords))
+  {
+    message = "The robot position is not located on the mesh";
+    return mbf_msgs::ExePathResult::OUT_OF_MAP;
+  }
+  const lvr2::FaceHandle face = current_face.unwrap();
+
+  // reduce the linear velocity while approaching the goal
+  const float goal_distance = (goal_pos - robot_pos).length();
+  float max_linear = config.max_lin_velocity;
+  if (config.arrival_fading > 0)
+    max_linear *= std::min(1.0f, goal_distance / static_cast<float>(config.arrival_fading));
+
+  // the reachable velocities within one control period
+  const float linear = velocity.twist.linear.x;
+  const float angular = velocity.twist.angular.z;
+  const float max_angular = config.max_ang_velocity;
+  const float lin_step = config.max_lin_acceleration * config.control_period;
+  const float ang_step = config.max_ang_acceleration * config.control_period;
+  const float min_lin = std::max(0.0f, std::min(max_linear, linear - lin_step));
+  const float max_lin = std::min(max_linear, linear + lin_step);
+  const float min_ang = std::max(-max_angular, angular - ang_step);
+  const float max_ang = std::min(max_angular, angular + ang_step);
+
+  const int lin_samples = config.lin_samples;
+  const int ang_samples = config.ang_samples;
+  for (int i = 0; i < lin_samples; i++)
+  {
+    const float lin_ratio = lin_samples > 1 ? static_cast<float>(i) / (lin_samples - 1) : 0.5f;
+    for (int j = 0; j < ang_samples; j++)
+    {
+      const float ang_ratio = ang_samples > 1 ? static_cast<float>(j) / (ang_samples - 1) : 0.5f;
+      Rollout& rollout = rollouts[i * ang_samples + j];
+      rollout.linear = min_lin + lin_ratio * std::max(0.0f, max_lin - min_lin);
+      rollout.angular = min_ang + ang_ratio * std::max(0.0f, max_ang - min_ang);
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < static_cast<int>(rollouts.size()); i++)
+  {
+    simulate(rollouts[i], face);
+  }
+
+  const Rollout* best = nullptr;
+  for (const auto& rollout : rollouts)
+  {
+    if (rollout.valid && (!best || rollout.score < best->score))
+      best = &rollout;
+  }
+
+  if (!best)
+  {
+    message = "All sampled trajectories leave the passable mesh";
+    ROS_WARN_STREAM(message);
+    return mbf_msgs::ExePathResult::NO_VALID_CMD;
+  }
+
+  if (map_ptr->debugEnabled())
+    map_ptr->publishDebugPoint(best->positions.back(), mesh_map::color(0, 1, 1), "rollout_end");
+
+  cmd_vel.twist.linear.x = best->linear;
+  cmd_vel.twist.angular.z = best->angular;
+  cmd_vel.header.stamp = ros::Time::now();
+
+  if (cancel_requested)
+  {
+    return mbf_msgs::ExePathResult::CANCELED;
+  }
+  return mbf_msgs::ExePathResult::SUCCESS;
+}
+
+bool RolloutController::locateRobot(std::array<float, 3>& bary_coords)
+{
+  float dist;
+  if (current_face)
+  {
+    lvr2::FaceHandle face = current_face.unwrap();
+    if (map_ptr->walkToFace(robot_pos, face, bary_coords, dist, config.max_walk_steps) &&
+        std::abs(dist) < config.max_search_distance)
+    {
+      current_face = face;
+      return true;
+    }
+    if (auto search_res_opt = map_ptr->searchNeighbourFaces(robot_pos, current_face.unwrap(), config.max_search_radius,
+                                                            config.max_search_distance))
+    {
+      current_face = std::get<0>(*search_res_opt);
+      bary_coords = std::get<2>(*search_res_opt);
+      return true;
+    }
+  }
+
+  if (auto search_res_opt = map_ptr->searchContainingFace(robot_pos, config.max_search_distance))
+  {
+    current_face = std::get<0>(*search_res_opt);
+    bary_coords = std::get<2>(*search_res_opt);
+    return true;
+  }
+  return false;
+}
+
+void RolloutController::simulate(Rollout& rollout, const lvr2::FaceHandle& start_face)
+{
+  const auto& mesh = map_ptr->mesh();
+  const auto& face_normals = map_ptr->faceNormals();
+  const int steps = static_cast<int>(rollout.positions.size());
+  const float dt = config.sim_time / steps;
+
+  lvr2::FaceHandle face = start_face;
+  mesh_map::Vector pos = robot_pos;
+  const mesh_map::Normal& start_normal = face_normals[face];
+  mesh_map::Vector heading = robot_dir - start_normal * robot_dir.dot(start_normal);
+  if (heading.length2() < 1e-12)
+  {
+    rollout.valid = false;
+    return;
+  }
+  heading.normalize();
+
+  float cost_sum = 0;
+  float misalignment_sum = 0;
+  rollout.valid = false;
+  for (int i = 0; i < steps; i++)
+  {
+    // rotate the heading around the surface normal and move along the surface
+    const mesh_map::Normal& normal = face_normals[face];
+    const float theta = rollout.angular * dt;
+    heading = heading * std::cos(theta) + normal.cross(heading) * std::sin(theta);
+    pos += heading * (rollout.linear * dt);
+
+    std::array<float, 3> bary_coords;
+    float dist;
+    if (!map_ptr->walkToFace(pos, face, bary_coords, dist, config.max_walk_steps))
+      return;
+
+    pos = mesh_map::linearCombineBarycentricCoords(mesh.getVertexPositionsOfFace(face), bary_coords);
+    const auto& handles = mesh.getVerticesOfFace(face);
+    const float cost = map_ptr->costAtPosition(handles, bary_coords);
+    if (!std::isfinite(cost))
+      return;
+
+    // keep the heading tangential to the surface
+    const mesh_map::Normal& face_normal = face_normals[face];
+    heading = (heading - face_normal * heading.dot(face_normal)).normalized();
+
+    const auto& opt_dir = map_ptr->directionAtPosition(vector_map, handles, bary_coords);
+    misalignment_sum += opt_dir ? 1 - heading.dot(opt_dir.get().normalized()) : 2;
+    cost_sum += cost;
+    rollout.positions[i] = pos;
+  }
+
+  rollout.valid = true;
+  rollout.score = config.cost_weight * cost_sum / steps + config.alignment_weight * misalignment_sum / steps +
+                  config.goal_weight * (goal_pos - pos).length() - config.speed_weight * rollout.linear;
+}
+
+bool RolloutController::isGoalReached(double dist_tolerance, double angle_tolerance)
+{
+  float goal_distance = (goal_pos - robot_pos).length();
+  float angle = acos(goal_dir.dot(robot_dir));
+  return goal_distance <= static_cast<float>(dist_tolerance) && angle <= static_cast<float>(angle_tolerance);
+}
+
+bool RolloutController::setPlan(const std::vector<geometry_msgs::PoseStamped>& plan)
+{
+  if (plan.empty())
+    return false;
+
+  vector_map = map_ptr->getVectorMap();
+  goal_pos = poseToPositionVector(plan.back());
+  goal_dir = poseToDirectionVector(plan.back());
+
+  cancel_requested = false;
+  current_face = lvr2::OptionalFaceHandle();
+  return true;
+}
+
+bool RolloutController::cancel()
+{
+  ROS_INFO_STREAM("The RolloutController has been requested to cancel!");
+  cancel_requested = true;
+  return true;
+}
+
+mesh_map::Normal RolloutController::poseToDirectionVector(const geometry_msgs::PoseStamped& pose,
+                                                          const tf2::Vector3& axis)
+{
+  tf2::Stamped<tf2::Transform> transform;
+  fromMsg(pose, transform);
+  tf2::Vector3 v = transform.getBasis() * axis;
+  return mesh_map::Normal(v.x(), v.y(), v.z());
+}
+
+mesh_map::Vector RolloutController::poseToPositionVector(const geometry_msgs::PoseStamped& pose)
+{
+  return mesh_map::Vector(pose.pose.position.x, pose.pose.position.y, pose.pose.position.z);
+}
+
+void RolloutController::allocateRollouts()
+{
+  rollouts.resize(config.lin_samples * config.ang_samples);
+  for (auto& rollout : rollouts)
+  {
+    rollout.positions.resize(config.sim_steps);
+    rollout.valid = false;
+  }
+}
+
+void RolloutController::reconfigureCallback(mesh_controller::RolloutControllerConfig& cfg, uint32_t level)
+{
+  std::lock_guard<std::mutex> lock(config_mtx);
+  config = cfg;
+  allocateRollouts();
+}
+
+bool RolloutController::initialize(const std::string& plugin_name, const boost::shared_ptr<tf2_ros::Buffer>& tf_ptr,
+                                   const boost::shared_ptr<mesh_map::MeshMap>& mesh_map_ptr)
+{
+  ros::NodeHandle private_nh("~/" + plugin_name);
+  map_ptr = mesh_map_ptr;
+  reconfigure_server_ptr = boost::shared_ptr<dynamic_reconfigure::Server<mesh_controller::RolloutControllerConfig>>(
+      new dynamic_reconfigure::Server<mesh_controller::RolloutControllerConfig>(private_nh));
+
+  config_callback = boost::bind(&RolloutController::reconfigureCallback, this, _1, _2);
+  reconfigure_server_ptr->setCallback(config_callback);
+  return true;
+}
+} /* namespace mesh_controller */
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__CLOUD_LAYER_H
+#define MESH_MAP__CLOUD_LAYER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mesh_map/abstract_layer.h>
+#include <ros/callback_queue.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <thread>
+
+namespace mesh_layers
+{
+/**
+ * @brief Base class for layers which are updated from a point cloud stream. The clouds are received in a separate
+ * thread and processed by a worker thread, which always takes the latest cloud, thus clouds arriving faster than they
+ * can be processed are dropped. The clouds are only processed once the layer has been computed and the map is loaded.
+ */
+class CloudLayer : public mesh_map::AbstractLayer
+{
+protected:
+  CloudLayer();
+
+  /**
+   * @brief subscribes to the point cloud topic given by the parameter "cloud_topic" and starts the worker thread,
+   * to be called from the initialization of the layer
+   */
+  void startCloudProcessing();
+
+  /**
+   * @brief unsubscribes and stops the worker thread, to be called from the destructor of the layer before its
+   * members are destroyed
+   */
+  void stopCloudProcessing();
+
+  /**
+   * @brief processes the latest cloud in the worker thread
+   *
+   * @param cloud the point cloud to process
+   */
+  virtual void processCloud(const sensor_msgs::PointCloud2& cloud) = 0;
+
+  /**
+   * @brief called in the worker thread after each cloud and periodically with the period from timeoutPeriod(), e.g.
+   * to expire old observations
+   */
+  virtual void processTimeouts()
+  {
+  }
+
+  /**
+   * @brief the period to call processTimeouts() with if no clouds are received
+   *
+   * @return the period in seconds, zero only calls processTimeouts() after each cloud
+   */
+  virtual double timeoutPeriod()
+  {
+    return 0;
+  }
+
+  /**
+   * @brief transforms the points of the cloud into the map frame and keeps one point per voxel
+   *
+   * @param cloud the point cloud to filter
+   * @param voxel_size the edge length of the voxels
+   * @param points filled with the filtered points in the map frame
+   *
+   * @return true if the cloud has float x, y and z fields and could be transformed into the map frame; else false
+   */
+  bool voxelFilter(const sensor_msgs::PointCloud2& cloud, const float voxel_size, std::vector<mesh_map::Vector>& points);
+
+  // true if the layer has been computed and clouds can be processed
+  std::atomic<bool> ready;
+
+private:
+  /**
+   * @brief stores the received cloud as the latest one and wakes up the worker thread
+   *
+   * @param cloud the received point cloud
+   */
+  void cloudCallback(const sensor_msgs::PointCloud2::ConstPtr& cloud);
+
+  /**
+   * @brief worker thread, processes the latest cloud until the processing is stopped
+   */
+  void processClouds();
+
+  // false if the worker thread should stop
+  bool running;
+  // latest received cloud, which has not been processed yet
+  sensor_msgs::PointCloud2::ConstPtr latest_cloud;
+  // number of clouds which have been superseded before they have been processed
+  size_t dropped_clouds;
+  // guards the latest cloud and the running flag
+  std::mutex cloud_mtx;
+  // signals a new cloud to the worker thread
+  std::condition_variable cloud_cv;
+  // worker thread processing the clouds
+  std::thread worker;
+
+  // separate callback queue, thus clouds are received while the global queue is busy
+  ros::CallbackQueue cloud_queue;
+  // spinner for the cloud callback queue
+  std::unique_ptr<ros::AsyncSpinner> cloud_spinner;
+  // point cloud subscriber
+  ros::Subscriber cloud_sub;
+};
+
+} /* namespace mesh_layers */
+
+#endif  // MESH_MAP__CLOUD_LAYER_H
@@ -0,0 +1,209 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__DECAY_LAYER_H
+#define MESH_MAP__DECAY_LAYER_H
+
+#include <dynamic_reconfigure/server.h>
+#include <mesh_layers/DecayLayerConfig.h>
+#include <mesh_layers/cloud_layer.h>
+#include <mesh_map/ring_buffer.h>
+
+namespace mesh_layers
+{
+/**
+ * @brief Costmap layer for dynamic obstacles, which expire if they are not observed again within their lifetime. The
+ * points of a cloud within the obstacle height band above the surface mark their closest vertices as lethal. Each
+ * observation is appended to a time-ordered ring buffer and the last-seen stamp of the vertex is updated. Since all
+ * observations share the same lifetime, the oldest observation expires first, thus expiring costs O(expired) work
+ * without rescanning the mesh or the marked vertices. Observations of vertices which have been seen again are
+ * skipped. The marked and the expired vertices are reported in batches to the mesh map.
+ */
+class DecayLayer : public CloudLayer
+{
+public:
+  /**
+   * @brief stops the subscriber and the worker thread
+   */
+  virtual ~DecayLayer();
+
+private:
+  /**
+   * @brief observations are transient, thus nothing is read from the map file
+   *
+   * @return false
+   */
+  virtual bool readLayer()
+  {
+    return false;
+  }
+
+  /**
+   * @brief observations are transient, thus nothing is written to the map file
+   *
+   * @return true
+   */
+  virtual bool writeLayer()
+  {
+    return true;
+  }
+
+  /**
+   * @brief delivers the threshold above which vertices are marked lethal
+   *
+   * @return lethal threshold
+   */
+  virtual float threshold()
+  {
+    return 1.0;
+  }
+
+  /**
+   * @brief delivers the default layer value
+   *
+   * @return default value used for this layer
+   */
+  virtual float defaultValue()
+  {
+    return 0;
+  }
+
+  /**
+   * @brief clears all observations
+   *
+   * @return true
+   */
+  virtual bool computeLayer();
+
+  /**
+   * @brief deliver the current costmap
+   *
+   * @return calculated costmap
+   */
+  virtual lvr2::VertexMap<float>& costs()
+  {
+    return decay_costs;
+  }
+
+  /**
+   * @brief deliver set containing all vertices marked as lethal
+   *
+   * @return lethal vertices
+   */
+  virtual std::set<lvr2::VertexHandle>& lethals()
+  {
+    return lethal_vertices;
+  }
+
+  /**
+   * @brief the observations do not depend on other layers
+   */
+  virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal){};
+
+  /**
+   * @brief the layer only depends on the observed point clouds
+   *
+   * @return false
+   */
+  virtual bool dependsOnUpstreamLethals()
+  {
+    return false;
+  }
+
+  /**
+   * @brief initializes this layer plugin, subscribes to the point cloud topic and starts the worker thread
+   *
+   * @param name name of this plugin
+   *
+   * @return true if initialization was successfull; else false
+   */
+  virtual bool initialize(const std::string& name);
+
+  /**
+   * @brief marks the observed vertices of a cloud and notifies the mesh map about the newly marked vertices
+   *
+   * @param cloud the point cloud to process
+   */
+  virtual void processCloud(const sensor_msgs::PointCloud2& cloud);
+
+  /**
+   * @brief expires the vertices which have not been observed within the lifetime and notifies the mesh map about them
+   */
+  virtual void processTimeouts();
+
+  /**
+   * @brief the period to check for expired vertices
+   *
+   * @return the expiry period in seconds
+   */
+  virtual double timeoutPeriod();
+
+  //! an observation of a vertex in the time-ordered ring buffer
+  struct Observation
+  {
+    lvr2::VertexHandle vertex = lvr2::VertexHandle(0);
+    double stamp = 0;
+  };
+
+  // costmap, one for the marked vertices
+  lvr2::DenseVertexMap<float> decay_costs;
+  // set of lethal vertices
+  std::set<lvr2::VertexHandle> lethal_vertices;
+
+  // stamp of the last observation of each vertex, zero if the vertex is not marked, only accessed by the worker thread
+  lvr2::DenseVertexMap<double> last_seen;
+  // observations in the order of their stamps, only accessed by the worker thread
+  mesh_map::RingBuffer<Observation> observations;
+
+  // Server for Reconfiguration
+  boost::shared_ptr<dynamic_reconfigure::Server<mesh_layers::DecayLayerConfig>> reconfigure_server_ptr;
+  dynamic_reconfigure::Server<mesh_layers::DecayLayerConfig>::CallbackType config_callback;
+  // current reconfigure config, guarded by the data mutex
+  DecayLayerConfig config;
+
+  /**
+   * @brief callback for incoming reconfigure configs
+   *
+   * @param cfg new config
+   * @param level level
+   */
+  void reconfigureCallback(mesh_layers::DecayLayerConfig& cfg, uint32_t level);
+};
+
+} /* namespace mesh_layers */
+
+#endif  // MESH_MAP__DECAY_LAYER_H
@@ -121,6 +121,26 @@ class HeightDiffLayer : public mesh_map::AbstractLayer
   {
   }
 
+  /**
+   * @brief the layer only depends on the mesh geometry and can be computed concurrently to the other layers
+   *
+   * @return false
+   */
+  virtual bool dependsOnUpstreamLethals()
+  {
+    return false;
+  }
+
+  /**
+   * @brief mixes the radius into the fingerprint of the stored layer data
+   *
+   * @param fingerprint the fingerprint of the layer data
+   */
+  virtual void fingerprintParameters(mesh_map::Fingerprint& fingerprint)
+  {
+    fingerprint.mix(config.radius);
+  }
+
   /**
    * @brief initializes this layer plugin
    *
@@ -140,6 +140,27 @@ class InflationLayer : public mesh_map::AbstractLayer
   void waveCostInflation(const std::set<lvr2::VertexHandle>& lethals, const float inflation_radius,
                          const float inscribed_radius, const float inscribed_value, const float lethal_value);
 
+  /**
+   * @brief propagates the wave front from the given lethal vertices and updates the distances and the repulsive
+   * vectorfield of the reached vertices
+   *
+   * @param lethals start vertices of the wave front
+   * @param inflation_radius radius of inflation, the wave front stops beyond it
+   * @param region if given, only the vertices of the region are updated
+   */
+  void waveFrontPropagation(const std::set<lvr2::VertexHandle>& lethals, const float inflation_radius,
+                            const lvr2::SparseVertexMap<float>* region = nullptr);
+
+  /**
+   * @brief collects the vertices within the given edge distance around the given vertices and their neighbours
+   *
+   * @param vertices start vertices
+   * @param max_distance max edge distance of the expanded vertices
+   * @param[out] region the vertices of the region with their edge distance to the start vertices
+   */
+  void edgeDistanceRegion(const std::set<lvr2::VertexHandle>& vertices, const float max_distance,
+                          lvr2::SparseVertexMap<float>& region);
+
   /**
    * @brief returns repulsive vector at a given position inside a face
    *
@@ -213,6 +234,29 @@ class InflationLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal);
 
+  /**
+   * @brief updates the set of lethal vertices and re-inflates only around the added and removed vertices
+   *
+   * @param added_lethal vertices to be marked as lethal
+   * @param removed_lethal vertices to be removed from the set of lethal vertices
+   * @param[out] changed_vertices the vertices whose riskiness changed are added
+   *
+   * @return true if the riskiness has been updated locally; false if it has been recomputed completely
+   */
+  virtual bool updateLethalLocally(std::set<lvr2::VertexHandle>& added_lethal,
+                                   std::set<lvr2::VertexHandle>& removed_lethal,
+                                   std::set<lvr2::VertexHandle>& changed_vertices);
+
+  /**
+   * @brief mixes the inflation parameters into the fingerprint of the stored riskiness
+   *
+   * @param fingerprint the fingerprint of the layer data
+   */
+  virtual void fingerprintParameters(mesh_map::Fingerprint& fingerprint)
+  {
+    fingerprint.mix(config.inscribed_radius).mix(config.inflation_radius).mix(config.inscribed_value);
+  }
+
   /**
    * @brief initializes this layer plugin
    *
@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__OBSTACLE_LAYER_H
+#define MESH_MAP__OBSTACLE_LAYER_H
+
+#include <dynamic_reconfigure/server.h>
+#include <mesh_layers/ObstacleLayerConfig.h>
+#include <mesh_layers/cloud_layer.h>
+
+namespace mesh_layers
+{
+/**
+ * @brief Costmap layer which marks obstacles observed in a point cloud stream, e.g. of a lidar. Each cloud is
+ * transformed into the map frame, voxel-downsampled and projected onto the mesh in one batch. Points within the obstacle height band above the
+ * surface hit the closest vertex, points below the band miss it, i.e. observe it as free. The hit/miss score of each
+ * vertex decays over time, vertices with a score above the lethal score are marked as lethal. Only the vertices whose
+ * costs changed are reported to the mesh map.
+ */
+class ObstacleLayer : public CloudLayer
+{
+public:
+  /**
+   * @brief stops the subscriber and the worker thread
+   */
+  virtual ~ObstacleLayer();
+
+private:
+  /**
+   * @brief obstacles are transient, thus nothing is read from the map file
+   *
+   * @return false
+   */
+  virtual bool readLayer()
+  {
+    return false;
+  }
+
+  /**
+   * @brief obstacles are transient, thus nothing is written to the map file
+   *
+   * @return true
+   */
+  virtual bool writeLayer()
+  {
+    return true;
+  }
+
+  /**
+   * @brief delivers the threshold above which vertices are marked lethal
+   *
+   * @return lethal threshold
+   */
+  virtual float threshold();
+
+  /**
+   * @brief delivers the default layer value
+   *
+   * @return default value used for this layer
+   */
+  virtual float defaultValue()
+  {
+    return 0;
+  }
+
+  /**
+   * @brief clears all observed obstacles
+   *
+   * @return true
+   */
+  virtual bool computeLayer();
+
+  /**
+   * @brief deliver the current costmap
+   *
+   * @return calculated costmap
+   */
+  virtual lvr2::VertexMap<float>& costs()
+  {
+    return obstacle_costs;
+  }
+
+  /**
+   * @brief deliver set containing all vertices marked as lethal
+   *
+   * @return lethal vertices
+   */
+  virtual std::set<lvr2::VertexHandle>& lethals()
+  {
+    return lethal_vertices;
+  }
+
+  /**
+   * @brief the obstacles do not depend on other layers
+   */
+  virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal){};
+
+  /**
+   * @brief the layer only depends on the observed point clouds
+   *
+   * @return false
+   */
+  virtual bool dependsOnUpstreamLethals()
+  {
+    return false;
+  }
+
+  /**
+   * @brief initializes this layer plugin, subscribes to the point cloud topic and starts the worker thread
+   *
+   * @param name name of this plugin
+   *
+   * @return true if initialization was successfull; else false
+   */
+  virtual bool initialize(const std::string& name);
+
+  /**
+   * @brief marks the obstacles of a cloud and notifies the mesh map about the changed vertices
+   *
+   * @param cloud the point cloud to process
+   */
+  virtual void processCloud(const sensor_msgs::PointCloud2& cloud);
+
+  // costmap, the normalized scores which have been reported to the mesh map
+  lvr2::DenseVertexMap<float> obstacle_costs;
+  // set of lethal vertices
+  std::set<lvr2::VertexHandle> lethal_vertices;
+
+  // hit/miss score of each vertex, only accessed by the worker thread
+  lvr2::DenseVertexMap<float> scores;
+  // vertices with a positive score, these are decayed with each cloud
+  std::vector<lvr2::VertexHandle> tracked_vertices;
+  // hit and miss flags of the vertices observed in the current cloud
+  std::vector<uint8_t> observations;
+  // stamp of the last processed cloud
+  ros::Time last_stamp;
+
+  // Server for Reconfiguration
+  boost::shared_ptr<dynamic_reconfigure::Server<mesh_layers::ObstacleLayerConfig>> reconfigure_server_ptr;
+  dynamic_reconfigure::Server<mesh_layers::ObstacleLayerConfig>::CallbackType config_callback;
+  // current reconfigure config, guarded by the data mutex
+  ObstacleLayerConfig config;
+
+  /**
+   * @brief callback for incoming reconfigure configs
+   *
+   * @param cfg new config
+   * @param level level
+   */
+  void reconfigureCallback(mesh_layers::ObstacleLayerConfig& cfg, uint32_t level);
+};
+
+} /* namespace mesh_layers */
+
+#endif  // MESH_MAP__OBSTACLE_LAYER_H
@@ -120,6 +120,27 @@ class RidgeLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal){};
 
+  /**
+   * @brief the layer only depends on the mesh geometry and can be computed concurrently to the other layers
+   *
+   * @return false
+   */
+  virtual bool dependsOnUpstreamLethals()
+  {
+    return false;
+  }
+
+  /**
+   * @brief mixes the radius and threshold into the fingerprint of the stored layer data
+   *
+   * @param fingerprint the fingerprint of the layer data
+   */
+  virtual void fingerprintParameters(mesh_map::Fingerprint& fingerprint)
+  {
+    fingerprint.mix(config.radius);
+    fingerprint.mix(config.threshold);
+  }
+
   /**
    * @brief initializes this layer plugin
    *
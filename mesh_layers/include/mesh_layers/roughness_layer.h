@@ -120,6 +120,26 @@ class RoughnessLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal){};
 
+  /**
+   * @brief the layer only depends on the mesh geometry and can be computed concurrently to the other layers
+   *
+   * @return false
+   */
+  virtual bool dependsOnUpstreamLethals()
+  {
+    return false;
+  }
+
+  /**
+   * @brief mixes the radius into the fingerprint of the stored layer data
+   *
+   * @param fingerprint the fingerprint of the layer data
+   */
+  virtual void fingerprintParameters(mesh_map::Fingerprint& fingerprint)
+  {
+    fingerprint.mix(config.radius);
+  }
+
   /**
    * @brief initializes this layer plugin
    *
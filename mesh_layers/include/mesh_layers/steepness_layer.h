@@ -119,6 +119,16 @@ class SteepnessLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal){};
 
+  /**
+   * @brief the layer only depends on the mesh geometry and can be computed concurrently to the other layers
+   *
+   * @return false
+   */
+  virtual bool dependsOnUpstreamLethals()
+  {
+    return false;
+  }
+
   /**
    * @brief initializes this layer plugin
    *
@@ -0,0 +1,195 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "mesh_layers/cloud_layer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sensor_msgs/point_cloud2_iterator.h>
+#include <tf2/LinearMath/Transform.h>
+#include <tf2/exceptions.h>
+#include <unordered_set>
+
+namespace mesh_layers
+{
+CloudLayer::CloudLayer() : ready(false), running(false), dropped_clouds(0)
+{
+}
+
+void CloudLayer::startCloudProcessing()
+{
+  running = true;
+  worker = std::thread(&CloudLayer::processClouds, this);
+
+  const std::string cloud_topic = private_nh.param<std::string>("cloud_topic", "cloud");
+  ros::NodeHandle cloud_nh;
+  cloud_nh.setCallbackQueue(&cloud_queue);
+  cloud_sub = cloud_nh.subscribe(cloud_topic, 1, &CloudLayer::cloudCallback, this, ros::TransportHints().tcpNoDelay());
+  cloud_spinner.reset(new ros::AsyncSpinner(1, &cloud_queue));
+  cloud_spinner->start();
+
+  ROS_INFO_STREAM("The layer \"" << layer_name << "\" subscribed to \"" << cloud_sub.getTopic() << "\".");
+}
+
+void CloudLayer::stopCloudProcessing()
+{
+  cloud_sub.shutdown();
+  if (cloud_spinner)
+    cloud_spinner->stop();
+
+  {
+    std::lock_guard<std::mutex> lock(cloud_mtx);
+    running = false;
+  }
+  cloud_cv.notify_one();
+  if (worker.joinable())
+    worker.join();
+}
+
+void CloudLayer::cloudCallback(const sensor_msgs::PointCloud2::ConstPtr& cloud)
+{
+  std::lock_guard<std::mutex> lock(cloud_mtx);
+  if (latest_cloud)
+    dropped_clouds++;
+  latest_cloud = cloud;
+  cloud_cv.notify_one();
+}
+
+void CloudLayer::processClouds()
+{
+  while (true)
+  {
+    sensor_msgs::PointCloud2::ConstPtr cloud;
+    size_t dropped;
+    {
+      std::unique_lock<std::mutex> lock(cloud_mtx);
+      const auto wakeup = [this]() { return !running || latest_cloud; };
+      const double period = timeoutPeriod();
+      if (period > 0)
+        cloud_cv.wait_for(lock, std::chrono::duration<double>(period), wakeup);
+      else
+        cloud_cv.wait(lock, wakeup);
+      if (!running)
+        return;
+      cloud.swap(latest_cloud);
+      dropped = dropped_clouds;
+      dropped_clouds = 0;
+    }
+
+    // the layer is combined with the other layers once the map is loaded
+    if (!ready || !map_ptr->isLoaded())
+      continue;
+
+    if (dropped > 0)
+      ROS_DEBUG_STREAM("Dropped " << dropped << " superseded clouds in \"" << layer_name << "\".");
+
+    if (cloud)
+      processCloud(*cloud);
+    processTimeouts();
+  }
+}
+
+bool CloudLayer::voxelFilter(const sensor_msgs::PointCloud2& cloud, const float voxel_size,
+                             std::vector<mesh_map::Vector>& points)
+{
+  // the cloud iterators throw if a field is missing and do not check the field's type
+  for (const std::string field : { "x", "y", "z" })
+  {
+    auto iter = std::find_if(cloud.fields.begin(), cloud.fields.end(),
+                             [&field](const sensor_msgs::PointField& f) { return f.name == field; });
+    if (iter == cloud.fields.end() || iter->datatype != sensor_msgs::PointField::FLOAT32 ||
+        iter->offset + sizeof(float) > cloud.point_step)
+    {
+      ROS_WARN_STREAM_THROTTLE(5, "The cloud from \"" << cloud.header.frame_id << "\" has no float field \"" << field
+                                                       << "\" and is dropped.");
+      return false;
+    }
+  }
+  if (cloud.data.size() < static_cast<size_t>(cloud.point_step) * cloud.width * cloud.height)
+  {
+    ROS_WARN_STREAM_THROTTLE(5, "The cloud from \"" << cloud.header.frame_id << "\" is truncated and is dropped.");
+    return false;
+  }
+
+  geometry_msgs::TransformStamped transform;
+  try
+  {
+    transform = map_ptr->tfBuffer().lookupTransform(map_ptr->mapFrame(), cloud.header.frame_id, cloud.header.stamp,
+                                                    ros::Duration(0.1));
+  }
+  catch (const tf2::TransformException& ex)
+  {
+    ROS_WARN_STREAM_THROTTLE(5, "Could not transform the cloud from \"" << cloud.header.frame_id << "\" to \""
+                                                                        << map_ptr->mapFrame() << "\": " << ex.what());
+    return false;
+  }
+
+  const auto& t = transform.transform;
+  const tf2::Transform map_from_cloud(tf2::Quaternion(t.rotation.x, t.rotation.y, t.rotation.z, t.rotation.w),
+                                      tf2::Vector3(t.translation.x, t.translation.y, t.translation.z));
+
+  // the voxel coordinates are packed into 21 bits each, which covers +-10km with a voxel size of 1cm
+  const float inv_voxel_size = 1.0 / voxel_size;
+  auto key = [inv_voxel_size](const tf2::Vector3& p) {
+    const uint64_t x = static_cast<int64_t>(std::floor(p.x() * inv_voxel_size)) & 0x1FFFFF;
+    const uint64_t y = static_cast<int64_t>(std::floor(p.y() * inv_voxel_size)) & 0x1FFFFF;
+    const uint64_t z = static_cast<int64_t>(std::floor(p.z() * inv_voxel_size)) & 0x1FFFFF;
+    return (x << 42) | (y << 21) | z;
+  };
+
+  const size_t num_points = cloud.width * cloud.height;
+  std::unordered_set<uint64_t> voxels;
+  voxels.reserve(num_points / 4);
+  points.clear();
+
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(cloud, "x");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_y(cloud, "y");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(cloud, "z");
+  for (size_t i = 0; i < num_points; i++, ++iter_x, ++iter_y, ++iter_z)
+  {
+    if (!std::isfinite(*iter_x) || !std::isfinite(*iter_y) || !std::isfinite(*iter_z))
+      continue;
+
+    const tf2::Vector3 p = map_from_cloud * tf2::Vector3(*iter_x, *iter_y, *iter_z);
+    if (voxels.insert(key(p)).second)
+      points.emplace_back(p.x(), p.y(), p.z());
+  }
+  return true;
+}
+
+} /* namespace mesh_layers */
@@ -0,0 +1,176 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "mesh_layers/decay_layer.h"
+
+#include <algorithm>
+#include <pluginlib/class_list_macros.h>
+
+PLUGINLIB_EXPORT_CLASS(mesh_layers::DecayLayer, mesh_map::AbstractLayer)
+
+namespace mesh_layers
+{
+DecayLayer::~DecayLayer()
+{
+  stopCloudProcessing();
+}
+
+bool DecayLayer::computeLayer()
+{
+  ROS_INFO_STREAM("Clear observations of \"" << layer_name << "\" (Decay Layer).");
+  decay_costs = lvr2::DenseVertexMap<float>(mesh_ptr->nextVertexIndex(), 0);
+  last_seen = lvr2::DenseVertexMap<double>(mesh_ptr->nextVertexIndex(), 0);
+  observations.clear();
+  lethal_vertices.clear();
+  ready = true;
+  return true;
+}
+
+double DecayLayer::timeoutPeriod()
+{
+  std::lock_guard<std::mutex> lock(data_mtx);
+  return config.expiry_period;
+}
+
+void DecayLayer::processCloud(const sensor_msgs::PointCloud2& cloud)
+{
+  DecayLayerConfig cfg;
+  {
+    std::lock_guard<std::mutex> lock(data_mtx);
+    cfg = config;
+  }
+
+  std::vector<mesh_map::Vector> points;
+  if (!voxelFilter(cloud, cfg.voxel_size, points))
+    return;
+
+  std::vector<lvr2::OptionalFaceHandle> faces;
+  std::vector<std::array<float, 3>> barycentric_coords;
+  std::vector<float> heights;
+  map_ptr->projectPoints(points, cfg.max_obstacle_height, faces, barycentric_coords, heights);
+
+  // the processing time is used as stamp, thus the observations are appended in the order of their stamps
+  const double now = ros::Time::now().toSec();
+
+  std::set<lvr2::VertexHandle> changed_vertices;
+  {
+    std::lock_guard<std::mutex> lock(data_mtx);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+      if (!faces[i] || heights[i] < cfg.min_obstacle_height)
+        continue;
+
+      const auto& coords = barycentric_coords[i];
+      const size_t closest = std::max_element(coords.begin(), coords.end()) - coords.begin();
+      const lvr2::VertexHandle vH = mesh_ptr->getVerticesOfFace(faces[i].unwrap())[closest];
+
+      // each vertex is appended once per cloud, its older observations are skipped when they expire
+      double& stamp = last_seen[vH];
+      if (stamp == now)
+        continue;
+      if (stamp == 0)
+      {
+        decay_costs[vH] = 1.0;
+        lethal_vertices.insert(vH);
+        changed_vertices.insert(vH);
+      }
+      stamp = now;
+
+      Observation observation;
+      observation.vertex = vH;
+      observation.stamp = now;
+      observations.push_back(observation);
+    }
+  }
+
+  if (!changed_vertices.empty())
+    notifyChange(changed_vertices);
+}
+
+void DecayLayer::processTimeouts()
+{
+  const double now = ros::Time::now().toSec();
+
+  std::set<lvr2::VertexHandle> changed_vertices;
+  {
+    std::lock_guard<std::mutex> lock(data_mtx);
+    const double expired = now - config.lifetime;
+    while (!observations.empty() && observations.front().stamp <= expired)
+    {
+      const Observation& observation = observations.front();
+      const lvr2::VertexHandle vH = observation.vertex;
+      if (last_seen[vH] == observation.stamp)
+      {
+        last_seen[vH] = 0;
+        decay_costs[vH] = 0;
+        lethal_vertices.erase(vH);
+        changed_vertices.insert(vH);
+      }
+      observations.pop_front();
+    }
+  }
+
+  if (!changed_vertices.empty())
+  {
+    ROS_DEBUG_STREAM("Expired " << changed_vertices.size() << " vertices in \"" << layer_name << "\", "
+                                << observations.size() << " observations are pending.");
+    notifyChange(changed_vertices);
+  }
+}
+
+void DecayLayer::reconfigureCallback(mesh_layers::DecayLayerConfig& cfg, uint32_t level)
+{
+  ROS_INFO_STREAM("New decay layer config through dynamic reconfigure.");
+
+  // the worker thread takes over the new config with the next cloud or expiry check
+  std::lock_guard<std::mutex> lock(data_mtx);
+  config = cfg;
+}
+
+bool DecayLayer::initialize(const std::string& name)
+{
+  reconfigure_server_ptr = boost::shared_ptr<dynamic_reconfigure::Server<mesh_layers::DecayLayerConfig>>(
+      new dynamic_reconfigure::Server<mesh_layers::DecayLayerConfig>(private_nh));
+
+  config_callback = boost::bind(&DecayLayer::reconfigureCallback, this, _1, _2);
+  reconfigure_server_ptr->setCallback(config_callback);
+
+  startCloudProcessing();
+  return true;
+}
+
+} /* namespace mesh_layers */
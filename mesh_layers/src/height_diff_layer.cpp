@@ -118,13 +118,22 @@ void HeightDiffLayer::reconfigureCallback(mesh_layers::HeightDiffLayerConfig& cf
     return;
   }
 
-  if (config.threshold != cfg.threshold)
+  const bool threshold_changed = config.threshold != cfg.threshold;
+  const bool radius_changed = config.radius != cfg.radius;
+  config = cfg;
+
+  if (radius_changed)
+  {
+    std::lock_guard<std::mutex> lock(data_mtx);
+    computeLayer();
+    notify = true;
+  }
+  else if (threshold_changed)
   {
     computeLethals();
     notify = true;
   }
 
-  config = cfg;
   if (notify)
     notifyChange();
 }
@@ -38,6 +38,7 @@
 #include "mesh_layers/inflation_layer.h"
 
 #include <queue>
+#include <tuple>
 #include <lvr2/util/Meap.hpp>
 #include <pluginlib/class_list_macros.h>
 #include <mesh_map/util.h>
@@ -88,7 +89,9 @@ float InflationLayer::threshold()
 void InflationLayer::updateLethal(std::set<lvr2::VertexHandle>& added_lethal,
                                   std::set<lvr2::VertexHandle>& removed_lethal)
 {
-  lethal_vertices = added_lethal;
+  for (auto vH : removed_lethal)
+    lethal_vertices.erase(vH);
+  lethal_vertices.insert(added_lethal.begin(), added_lethal.end());
 
   ROS_INFO_STREAM("Update lethal for inflation layer.");
   waveCostInflation(lethal_vertices, config.inflation_radius, config.inscribed_radius, config.inscribed_value,
@@ -102,6 +105,123 @@ void InflationLayer::updateLethal(std::set<lvr2::VertexHandle>& added_lethal,
 */
 }
 
+bool InflationLayer::updateLethalLocally(std::set<lvr2::VertexHandle>& added_lethal,
+                                         std::set<lvr2::VertexHandle>& removed_lethal,
+                                         std::set<lvr2::VertexHandle>& changed_vertices)
+{
+  if (!mesh_ptr || distances.numValues() == 0)
+  {
+    updateLethal(added_lethal, removed_lethal);
+    return false;
+  }
+
+  for (auto vH : removed_lethal)
+    lethal_vertices.erase(vH);
+  lethal_vertices.insert(added_lethal.begin(), added_lethal.end());
+
+  std::set<lvr2::VertexHandle> sources(added_lethal);
+  sources.insert(removed_lethal.begin(), removed_lethal.end());
+
+  // The distances can only change within the inflation radius around the changed lethals. The regions are bounded by
+  // edge distances, which overestimate the geodesic distances, thus the distances are updated within twice the
+  // radius and the wave is propagated within four times the radius, to also reach the lethals which are next to the
+  // updated vertices.
+  lvr2::SparseVertexMap<float> update_region, wave_region;
+  edgeDistanceRegion(sources, 2 * config.inflation_radius, update_region);
+  edgeDistanceRegion(sources, 4 * config.inflation_radius, wave_region);
+
+  std::set<lvr2::VertexHandle> region_lethals;
+  for (auto vH : wave_region)
+  {
+    if (lethal_vertices.find(vH) != lethal_vertices.end())
+      region_lethals.insert(vH);
+  }
+
+  // the vertices outside of the update region keep their values, they may be incomplete in the local wave front
+  std::vector<std::tuple<lvr2::VertexHandle, float, lvr2::BaseVector<float>>> kept;
+  for (auto vH : wave_region)
+  {
+    if (!update_region.containsKey(vH))
+      kept.emplace_back(vH, distances[vH], vector_map[vH]);
+    distances[vH] = std::numeric_limits<float>::infinity();
+    vector_map[vH] = lvr2::BaseVector<float>();
+  }
+
+  waveFrontPropagation(region_lethals, config.inflation_radius, &wave_region);
+
+  for (const auto& vertex : kept)
+  {
+    distances[std::get<0>(vertex)] = std::get<1>(vertex);
+    vector_map[std::get<0>(vertex)] = std::get<2>(vertex);
+  }
+
+  for (auto vH : update_region)
+  {
+    const float value = fading(distances[vH]);
+    if (value != riskiness[vH] || sources.find(vH) != sources.end())
+    {
+      riskiness[vH] = value;
+      changed_vertices.insert(vH);
+    }
+  }
+
+  ROS_DEBUG_STREAM("Updated the inflation of " << update_region.numValues() << " vertices around " << sources.size()
+                                               << " changed lethal vertices.");
+  return true;
+}
+
+void InflationLayer::edgeDistanceRegion(const std::set<lvr2::VertexHandle>& vertices, const float max_distance,
+                                        lvr2::SparseVertexMap<float>& region)
+{
+  const auto& mesh = *mesh_ptr;
+  const auto& edge_distances = map_ptr->edgeDistances();
+
+  lvr2::Meap<lvr2::VertexHandle, float> pq;
+  for (auto vH : vertices)
+  {
+    region.insert(vH, 0);
+    pq.insert(vH, 0);
+  }
+
+  // vertices beyond the max distance are part of the region, but not expanded
+  while (!pq.isEmpty())
+  {
+    const auto min = pq.popMin();
+    const lvr2::VertexHandle current_vh = min.key();
+    if (min.value() > max_distance)
+      continue;
+
+    std::vector<lvr2::EdgeHandle> edges;
+    try
+    {
+      mesh.getEdgesOfVertex(current_vh, edges);
+    }
+    catch (lvr2::PanicException exception)
+    {
+      continue;
+    }
+    catch (lvr2::VertexLoopException exception)
+    {
+      continue;
+    }
+
+    for (auto eH : edges)
+    {
+      const std::array<lvr2::VertexHandle, 2> edge_vertices = mesh.getVerticesOfEdge(eH);
+      const lvr2::VertexHandle& nh = edge_vertices[0] == current_vh ? edge_vertices[1] : edge_vertices[0];
+      const float distance = min.value() + edge_distances[eH];
+      auto known = region.get(nh);
+      if (known && *known <= distance)
+        continue;
+      region.insert(nh, distance);
+      if (pq.containsKey(nh))
+        pq.updateValue(nh, distance);
+      else
+        pq.insert(nh, distance);
+    }
+  }
+}
+
 inline float InflationLayer::computeUpdateSethianMethod(const float& d1, const float& d2, const float& a,
                                                         const float& b, const float& dot, const float& F)
 {
@@ -258,165 +378,165 @@ void InflationLayer::waveCostInflation(const std::set<lvr2::VertexHandle>& letha
 {
   if (mesh_ptr)
   {
-    auto const& mesh = *mesh_ptr;
-
     ROS_INFO_STREAM("inflation radius:" << inflation_radius);
     ROS_INFO_STREAM("Init wave inflation.");
 
-    lvr2::DenseVertexMap<bool> seen(mesh_ptr->nextVertexIndex(), false);
     distances = lvr2::DenseVertexMap<float>(mesh_ptr->nextVertexIndex(), std::numeric_limits<float>::infinity());
-    lvr2::DenseVertexMap<lvr2::VertexHandle> predecessors;
-    predecessors.reserve(mesh_ptr->nextVertexIndex());
-
-    vector_map = lvr2::DenseVertexMap<lvr2::BaseVector<float>>(mesh.nextVertexIndex(), lvr2::BaseVector<float>());
-
+    vector_map = lvr2::DenseVertexMap<lvr2::BaseVector<float>>(mesh_ptr->nextVertexIndex(), lvr2::BaseVector<float>());
     direction = lvr2::DenseVertexMap<float>();
 
-    const auto& edge_distances = map_ptr->edgeDistances();
-    const auto& face_normals = map_ptr->faceNormals();
+    ROS_INFO_STREAM("Start inflation wave front propagation");
+    waveFrontPropagation(lethals, inflation_radius);
 
-    lvr2::DenseVertexMap<bool> fixed(mesh.nextVertexIndex(), false);
+    ROS_INFO_STREAM("Finished inflation wave front propagation.");
 
-    // initialize distances with infinity
-    // initialize predecessor of each vertex with itself
-    for (auto const& vH : mesh.vertices())
+    for (auto vH : mesh_ptr->vertices())
     {
-      predecessors.insert(vH, vH);
+      riskiness.insert(vH, fading(distances[vH]));
     }
 
-    lvr2::Meap<lvr2::VertexHandle, float> pq;
-    // Set start distance to zero
-    // add start vertex to priority queue
-    for (auto vH : lethals)
-    {
-      distances[vH] = 0;
-      fixed[vH] = true;
-      pq.insert(vH, 0);
-    }
+    map_ptr->publishVectorField("inflation", vector_map, distances,
+                                std::bind(&InflationLayer::fading, this, std::placeholders::_1));
+  }
+  else
+  {
+    ROS_ERROR_STREAM("Cannot init wave inflation: mesh_ptr points to null");
+  }
+}
 
-    ROS_INFO_STREAM("Start inflation wave front propagation");
+void InflationLayer::waveFrontPropagation(const std::set<lvr2::VertexHandle>& lethals, const float inflation_radius,
+                                          const lvr2::SparseVertexMap<float>* region)
+{
+  auto const& mesh = *mesh_ptr;
+
+  // the predecessors are only set for the vertices reached by the wave front
+  lvr2::DenseVertexMap<lvr2::VertexHandle> predecessors;
+  predecessors.reserve(mesh.nextVertexIndex());
+
+  const auto& edge_distances = map_ptr->edgeDistances();
+  const auto& face_normals = map_ptr->faceNormals();
+
+  lvr2::DenseVertexMap<bool> fixed(mesh.nextVertexIndex(), false);
+
+  // only the vertices in the region are updated, if a region is given
+  auto in_region = [region](const lvr2::VertexHandle& vH) { return !region || region->containsKey(vH); };
+
+  lvr2::Meap<lvr2::VertexHandle, float> pq;
+  // Set start distance to zero
+  // add start vertex to priority queue
+  for (auto vH : lethals)
+  {
+    distances[vH] = 0;
+    fixed[vH] = true;
+    pq.insert(vH, 0);
+  }
+
+  while (!pq.isEmpty())
+  {
+    lvr2::VertexHandle current_vh = pq.popMin().key();
 
-    while (!pq.isEmpty())
+    if (current_vh.idx() >= mesh.nextVertexIndex())
     {
-      lvr2::VertexHandle current_vh = pq.popMin().key();
+      continue;
+    }
 
-      if (current_vh.idx() >= mesh.nextVertexIndex())
-      {
-        continue;
-      }
+    if (map_ptr->invalid[current_vh])
+      continue;
 
-      if (map_ptr->invalid[current_vh])
-        continue;
+    // check if already fixed
+    // if(fixed[current_vh]) continue;
+    fixed[current_vh] = true;
 
-      // check if already fixed
-      // if(fixed[current_vh]) continue;
-      fixed[current_vh] = true;
+    std::vector<lvr2::VertexHandle> neighbours;
+    try
+    {
+      mesh.getNeighboursOfVertex(current_vh, neighbours);
+    }
+    catch (lvr2::PanicException exception)
+    {
+      map_ptr->invalid.insert(current_vh, true);
+      continue;
+    }
+    catch (lvr2::VertexLoopException exception)
+    {
+      map_ptr->invalid.insert(current_vh, true);
+      continue;
+    }
 
-      std::vector<lvr2::VertexHandle> neighbours;
+    for (auto nh : neighbours)
+    {
+      std::vector<lvr2::FaceHandle> faces;
       try
       {
-        mesh.getNeighboursOfVertex(current_vh, neighbours);
+        mesh.getFacesOfVertex(nh, faces);
       }
       catch (lvr2::PanicException exception)
       {
-        map_ptr->invalid.insert(current_vh, true);
-        continue;
-      }
-      catch (lvr2::VertexLoopException exception)
-      {
-        map_ptr->invalid.insert(current_vh, true);
+        map_ptr->invalid.insert(nh, true);
         continue;
       }
 
-      for (auto nh : neighbours)
+      for (auto fh : faces)
       {
-        std::vector<lvr2::FaceHandle> faces;
-        try
-        {
-          mesh.getFacesOfVertex(nh, faces);
-        }
-        catch (lvr2::PanicException exception)
-        {
-          map_ptr->invalid.insert(nh, true);
-          continue;
-        }
+        const auto vertices = mesh.getVerticesOfFace(fh);
+        const lvr2::VertexHandle& a = vertices[0];
+        const lvr2::VertexHandle& b = vertices[1];
+        const lvr2::VertexHandle& c = vertices[2];
 
-        for (auto fh : faces)
+        try
         {
-          const auto vertices = mesh.getVerticesOfFace(fh);
-          const lvr2::VertexHandle& a = vertices[0];
-          const lvr2::VertexHandle& b = vertices[1];
-          const lvr2::VertexHandle& c = vertices[2];
-
-          try
+          if (fixed[a] && fixed[b] && fixed[c])
           {
-            if (fixed[a] && fixed[b] && fixed[c])
-            {
-              // ROS_INFO_STREAM("All fixed!");
-              continue;
-            }
-            else if (fixed[a] && fixed[b] && !fixed[c])
-            {
-              // c is free
-              if (waveFrontUpdate(distances, predecessors, inflation_radius, edge_distances, fh, face_normals[fh], a, b,
-                                  c))
-              {
-                pq.insert(c, distances[c]);
-              }
-              // if(pq.containsKey(c)) pq.updateValue(c, distances[c]);
-            }
-            else if (fixed[a] && !fixed[b] && fixed[c])
-            {
-              // b is free
-              if (waveFrontUpdate(distances, predecessors, inflation_radius, edge_distances, fh, face_normals[fh], c, a,
-                                  b))
-              {
-                pq.insert(b, distances[b]);
-              }
-              // if(pq.containsKey(b)) pq.updateValue(b, distances[b]);
-            }
-            else if (!fixed[a] && fixed[b] && fixed[c])
+            // ROS_INFO_STREAM("All fixed!");
+            continue;
+          }
+          else if (fixed[a] && fixed[b] && !fixed[c])
+          {
+            // c is free
+            if (in_region(c) && waveFrontUpdate(distances, predecessors, inflation_radius, edge_distances, fh,
+                                                 face_normals[fh], a, b, c))
             {
-              // a if free
-              if (waveFrontUpdate(distances, predecessors, inflation_radius, edge_distances, fh, face_normals[fh], b, c,
-                                  a))
-              {
-                pq.insert(a, distances[a]);
-              }
-              // if(pq.containsKey(a)) pq.updateValue(a, distances[a]);
+              pq.insert(c, distances[c]);
             }
-            else
+            // if(pq.containsKey(c)) pq.updateValue(c, distances[c]);
+          }
+          else if (fixed[a] && !fixed[b] && fixed[c])
+          {
+            // b is free
+            if (in_region(b) && waveFrontUpdate(distances, predecessors, inflation_radius, edge_distances, fh,
+                                                 face_normals[fh], c, a, b))
             {
-              // two free vertices -> skip that face
-              // ROS_INFO_STREAM("two vertices are free.");
-              continue;
+              pq.insert(b, distances[b]);
             }
+            // if(pq.containsKey(b)) pq.updateValue(b, distances[b]);
           }
-          catch (lvr2::PanicException exception)
+          else if (!fixed[a] && fixed[b] && fixed[c])
           {
-            map_ptr->invalid.insert(nh, true);
+            // a if free
+            if (in_region(a) && waveFrontUpdate(distances, predecessors, inflation_radius, edge_distances, fh,
+                                                 face_normals[fh], b, c, a))
+            {
+              pq.insert(a, distances[a]);
+            }
+            // if(pq.containsKey(a)) pq.updateValue(a, distances[a]);
           }
-          catch (lvr2::VertexLoopException exception)
+          else
           {
-            map_ptr->invalid.insert(nh, true);
+            // two free vertices -> skip that face
+            // ROS_INFO_STREAM("two vertices are free.");
+            continue;
           }
         }
+        catch (lvr2::PanicException exception)
+        {
+          map_ptr->invalid.insert(nh, true);
+        }
+        catch (lvr2::VertexLoopException exception)
+        {
+          map_ptr->invalid.insert(nh, true);
+        }
       }
     }
-
-    ROS_INFO_STREAM("Finished inflation wave front propagation.");
-
-    for (auto vH : mesh_ptr->vertices())
-    {
-      riskiness.insert(vH, fading(distances[vH]));
-    }
-
-    map_ptr->publishVectorField("inflation", vector_map, distances,
-                                std::bind(&InflationLayer::fading, this, std::placeholders::_1));
-  }
-  else
-  {
-    ROS_ERROR_STREAM("Cannot init wave inflation: mesh_ptr points to null");
   }
 }
 
@@ -471,14 +591,15 @@ lvr2::BaseVector<float> InflationLayer::vectorAt(const lvr2::VertexHandle& vH)
   }
 
   if (distance > config.inflation_radius)
+    return lvr2::BaseVector<float>();
 
-    // Inflation radius
-    if (distance > config.inscribed_radius)
-    {
-      float alpha =
-          (sqrt(distance) - config.inscribed_radius) / (config.inflation_radius - config.inscribed_radius) * M_PI;
-      return vec * config.inscribed_value * (cos(alpha) + 1) / 2.0;
-    }
+  // Inflation radius
+  if (distance > config.inscribed_radius)
+  {
+    float alpha =
+        (sqrt(distance) - config.inscribed_radius) / (config.inflation_radius - config.inscribed_radius) * M_PI;
+    return vec * config.inscribed_value * (cos(alpha) + 1) / 2.0;
+  }
 
   // Inscribed radius
   if (distance > 0)
@@ -636,16 +757,24 @@ void InflationLayer::reconfigureCallback(mesh_layers::InflationLayerConfig& cfg,
     first_config = false;
   }
 
-  if (config.inflation_radius != cfg.inflation_radius)
+  const bool inflation_changed = config.inflation_radius != cfg.inflation_radius ||
+                                 config.inscribed_radius != cfg.inscribed_radius ||
+                                 config.inscribed_value != cfg.inscribed_value;
+  const bool field_changed = config.inscribed_radius != cfg.inscribed_radius ||
+                             config.inflation_radius != cfg.inflation_radius ||
+                             config.lethal_value != cfg.lethal_value || config.inscribed_value != cfg.inscribed_value;
+  config = cfg;
+
+  if (inflation_changed)
   {
     // TODO handle other config params
+    std::lock_guard<std::mutex> lock(data_mtx);
     waveCostInflation(lethal_vertices, config.inflation_radius, config.inscribed_radius, config.inscribed_value,
                       std::numeric_limits<float>::infinity());
     notify = true;
   }
 
-  if (config.inscribed_radius != cfg.inscribed_radius || config.inflation_radius != cfg.inflation_radius ||
-      config.lethal_value != cfg.lethal_value || config.inscribed_value != cfg.inscribed_value)
+  if (field_changed)
   {
     map_ptr->publishVectorField("inflation", vector_map, distances,
                                 std::bind(&mesh_layers::InflationLayer::fading, this, std::placeholders::_1));
@@ -658,7 +787,6 @@ void InflationLayer::reconfigureCallback(mesh_layers::InflationLayerConfig& cfg,
                           ? std::numeric_limits<float>::infinity()
                           : cfg.lethal_value);
   */
-  config = cfg;
 
   if (notify)
     notifyChange();
@@ -0,0 +1,197 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "mesh_layers/obstacle_layer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <pluginlib/class_list_macros.h>
+
+PLUGINLIB_EXPORT_CLASS(mesh_layers::ObstacleLayer, mesh_map::AbstractLayer)
+
+namespace mesh_layers
+{
+//! observation flags of a vertex within one cloud
+constexpr uint8_t HIT = 1;
+constexpr uint8_t MISS = 2;
+
+ObstacleLayer::~ObstacleLayer()
+{
+  stopCloudProcessing();
+}
+
+float ObstacleLayer::threshold()
+{
+  return config.lethal_score / config.max_score;
+}
+
+bool ObstacleLayer::computeLayer()
+{
+  ROS_INFO_STREAM("Clear obstacles of \"" << layer_name << "\" (Obstacle Layer).");
+  obstacle_costs = lvr2::DenseVertexMap<float>(mesh_ptr->nextVertexIndex(), 0);
+  scores = lvr2::DenseVertexMap<float>(mesh_ptr->nextVertexIndex(), 0);
+  observations.assign(mesh_ptr->nextVertexIndex(), 0);
+  tracked_vertices.clear();
+  lethal_vertices.clear();
+  last_stamp = ros::Time();
+  ready = true;
+  return true;
+}
+
+void ObstacleLayer::processCloud(const sensor_msgs::PointCloud2& cloud)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  ObstacleLayerConfig cfg;
+  {
+    std::lock_guard<std::mutex> lock(data_mtx);
+    cfg = config;
+  }
+
+  std::vector<mesh_map::Vector> points;
+  if (!voxelFilter(cloud, cfg.voxel_size, points))
+    return;
+
+  std::vector<lvr2::OptionalFaceHandle> faces;
+  std::vector<std::array<float, 3>> barycentric_coords;
+  std::vector<float> heights;
+  map_ptr->projectPoints(points, cfg.max_obstacle_height, faces, barycentric_coords, heights);
+
+  // each vertex is counted once per cloud, a hit outweighs a miss, thus dense ground returns do not clear obstacles
+  std::vector<lvr2::VertexHandle> observed_vertices;
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    if (!faces[i])
+      continue;
+
+    const auto& coords = barycentric_coords[i];
+    const size_t closest = std::max_element(coords.begin(), coords.end()) - coords.begin();
+    const lvr2::VertexHandle vH = mesh_ptr->getVerticesOfFace(faces[i].unwrap())[closest];
+
+    uint8_t& observation = observations[vH.idx()];
+    if (!observation)
+      observed_vertices.push_back(vH);
+    observation |= heights[i] >= cfg.min_obstacle_height ? HIT : MISS;
+  }
+
+  const double dt = last_stamp.isZero() ? 0 : std::max(0.0, (cloud.header.stamp - last_stamp).toSec());
+  last_stamp = std::max(last_stamp, cloud.header.stamp);
+  const float decay = cfg.decay_time > 0 ? std::exp(-dt / cfg.decay_time) : 1.0;
+
+  std::set<lvr2::VertexHandle> changed_vertices;
+  {
+    std::lock_guard<std::mutex> lock(data_mtx);
+
+    for (auto vH : tracked_vertices)
+      scores[vH] *= decay;
+
+    for (auto vH : observed_vertices)
+    {
+      const uint8_t observation = observations[vH.idx()];
+      observations[vH.idx()] = 0;
+
+      float& score = scores[vH];
+      if (observation & HIT)
+      {
+        if (score == 0)
+          tracked_vertices.push_back(vH);
+        score = std::min<float>(score + cfg.hit_weight, cfg.max_score);
+      }
+      else
+      {
+        score = std::max<float>(score - cfg.miss_weight, 0);
+      }
+    }
+
+    // only report costs which changed noticeably, scores which decayed below the resolution are dropped
+    size_t num_tracked = 0;
+    for (auto vH : tracked_vertices)
+    {
+      float& score = scores[vH];
+      if (score < cfg.cost_resolution * cfg.max_score)
+        score = 0;
+
+      const float cost = score / cfg.max_score;
+      if (std::fabs(cost - obstacle_costs[vH]) >= cfg.cost_resolution || (score == 0 && obstacle_costs[vH] != 0))
+      {
+        obstacle_costs[vH] = cost;
+        changed_vertices.insert(vH);
+      }
+
+      const bool lethal = score >= cfg.lethal_score;
+      if (lethal ? lethal_vertices.insert(vH).second : lethal_vertices.erase(vH) > 0)
+        changed_vertices.insert(vH);
+
+      if (score > 0)
+        tracked_vertices[num_tracked++] = vH;
+    }
+    tracked_vertices.resize(num_tracked);
+  }
+
+  ROS_DEBUG_STREAM("Processed " << cloud.width * cloud.height << " points, " << points.size() << " voxels, "
+                                << observed_vertices.size() << " observed, " << tracked_vertices.size()
+                                << " tracked and " << changed_vertices.size() << " changed vertices in "
+                                << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                                << "s.");
+
+  if (!changed_vertices.empty())
+    notifyChange(changed_vertices);
+}
+
+void ObstacleLayer::reconfigureCallback(mesh_layers::ObstacleLayerConfig& cfg, uint32_t level)
+{
+  ROS_INFO_STREAM("New obstacle layer config through dynamic reconfigure.");
+
+  // the worker thread takes over the new config with the next cloud
+  std::lock_guard<std::mutex> lock(data_mtx);
+  config = cfg;
+}
+
+bool ObstacleLayer::initialize(const std::string& name)
+{
+  reconfigure_server_ptr = boost::shared_ptr<dynamic_reconfigure::Server<mesh_layers::ObstacleLayerConfig>>(
+      new dynamic_reconfigure::Server<mesh_layers::ObstacleLayerConfig>(private_nh));
+
+  config_callback = boost::bind(&ObstacleLayer::reconfigureCallback, this, _1, _2);
+  reconfigure_server_ptr->setCallback(config_callback);
+
+  startCloudProcessing();
+  return true;
+}
+
+} /* namespace mesh_layers */
@@ -198,22 +198,20 @@ void RidgeLayer::reconfigureCallback(mesh_layers::RidgeLayerConfig& cfg, uint32_
     return;
   }
 
-  if (config.threshold != cfg.threshold)
-  {
-    computeLethals();
-    notify = true;
-  }
+  // the layer is computed with the new config, the ridge values also depend on the threshold
+  const bool threshold_changed = config.threshold != cfg.threshold;
+  const bool radius_changed = config.radius != cfg.radius;
+  config = cfg;
 
-  if (config.radius != cfg.radius)
+  if (threshold_changed || radius_changed)
   {
+    std::lock_guard<std::mutex> lock(data_mtx);
     computeLayer();
     notify = true;
   }
 
   if (notify)
     notifyChange();
-
-  config = cfg;
 }
 
 bool RidgeLayer::initialize(const std::string& name)
@@ -149,15 +149,20 @@ void RoughnessLayer::reconfigureCallback(mesh_layers::RoughnessLayerConfig &cfg,
     return;
   }
 
-  if(config.threshold != cfg.threshold)
-  {
+  const bool threshold_changed = config.threshold != cfg.threshold;
+  const bool radius_changed = config.radius != cfg.radius;
+  config = cfg;
+
+  if (radius_changed) {
+    std::lock_guard<std::mutex> lock(data_mtx);
+    computeLayer();
+    notify = true;
+  } else if (threshold_changed) {
     computeLethals();
     notify = true;
   }
 
   if(notify) notifyChange();
-
-  config = cfg;
 }
 
 bool RoughnessLayer::initialize(const std::string &name) {
@@ -177,7 +177,10 @@ void SteepnessLayer::reconfigureCallback(mesh_layers::SteepnessLayerConfig& cfg,
     return;
   }
 
-  if (config.threshold != cfg.threshold)
+  const bool threshold_changed = config.threshold != cfg.threshold;
+  config = cfg;
+
+  if (threshold_changed)
   {
     computeLethals();
     notify = true;
@@ -185,8 +188,6 @@ void SteepnessLayer::reconfigureCallback(mesh_layers::SteepnessLayerConfig& cfg,
 
   if (notify)
     notifyChange();
-
-  config = cfg;
 }
 
 bool SteepnessLayer::initialize(const std::string& name)
@@ -39,6 +39,8 @@
 #include <lvr2/io/AttributeMeshIOBase.hpp>
 #include <mesh_map/MeshMapConfig.h>
 #include <mesh_map/mesh_map.h>
+#include <mesh_map/util.h>
+#include <mutex>
 #include <boost/optional.hpp>
 
 #ifndef MESH_MAP__ABSTRACT_LAYER_H
@@ -113,6 +115,46 @@ public:
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal,
                             std::set<lvr2::VertexHandle>& removed_lethal) = 0;
 
+  /**
+   * @brief Called by the mesh map if only a few "lethal" obstacle vertices of the previous layers changed, e.g. by
+   * sensor data. Layers which can update their costs locally around the changed vertices override this method, the
+   * default calls updateLethal() and requests a recombination of all costs.
+   * @param added_lethal    The "lethal" obstacle vertex handles which are new with respect to the previous call.
+   * @param removed_lethal  Old "lethal" obstacle vertex handles, i.e. vertices which are no "lethal" obstacles anymore.
+   * @param changed_vertices The vertices whose costs changed so far, the layer adds the vertices whose costs or
+   * "lethal" state it changed.
+   * @return true, if only the costs of the changed vertices have been updated; false, if the costs of the layer have
+   * been recomputed completely.
+   */
+  virtual bool updateLethalLocally(std::set<lvr2::VertexHandle>& added_lethal,
+                                   std::set<lvr2::VertexHandle>& removed_lethal,
+                                   std::set<lvr2::VertexHandle>& changed_vertices)
+  {
+    updateLethal(added_lethal, removed_lethal);
+    return false;
+  }
+
+  /**
+   * @brief Declares whether the layer costs depend on the "lethal" obstacles of the previous layers, which are passed
+   * with updateLethal(). The mesh map reads or computes such a layer after all previous layers are completed, all other
+   * layers are read or computed concurrently. Layers which only depend on the geometry should return false.
+   * @return true, if the layer depends on the lethal vertices of the previous layers. Default is true.
+   */
+  virtual bool dependsOnUpstreamLethals()
+  {
+    return true;
+  }
+
+  /**
+   * @brief Mixes the parameters the layer data depends on into the fingerprint the layer data is stored with. Stored
+   * layer data is only read if it has been computed with the same parameters. Parameters which only affect the lethal
+   * vertices, e.g. a threshold, should not be mixed in, since the lethals are computed from the read layer data.
+   * @param fingerprint The fingerprint of the layer data
+   */
+  virtual void fingerprintParameters(Fingerprint& fingerprint)
+  {
+  }
+
   /**
    * @brief Optional method if the layer computes vectors. Computes a vector within a triangle using barycentric coordinates.
    * @param vertices The three triangle vertices.
@@ -171,7 +213,26 @@ public:
     this->notify(layer_name);
   }
 
+  /**
+   * @brief Notifies the mesh map that only the cost values or the "lethal" state of the given vertices changed. The
+   * mesh map then only updates the combined costs of these vertices, which allows layers to change at a high rate.
+   * The data mutex must not be locked while notifying.
+   * @param changed_vertices The vertices whose cost values or "lethal" state changed
+   */
+  void notifyChange(const std::set<lvr2::VertexHandle>& changed_vertices);
+
+  /**
+   * @brief Returns the mutex which guards the layer data, it is locked while the layer data is written in the background
+   */
+  std::mutex& dataMutex()
+  {
+    return data_mtx;
+  }
+
 protected:
+  //! guards the layer data, lock it while the layer data is modified after the initialization, e.g. on a reconfigure
+  std::mutex data_mtx;
+
   std::string layer_name;
   std::shared_ptr<lvr2::AttributeMeshIOBase> mesh_io_ptr;
   std::shared_ptr<lvr2::HalfEdgeMesh<Vector>> mesh_ptr;
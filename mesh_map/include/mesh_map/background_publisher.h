@@ -0,0 +1,154 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__BACKGROUND_PUBLISHER_H
+#define MESH_MAP__BACKGROUND_PUBLISHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ros/ros.h>
+#include <string>
+#include <thread>
+
+namespace mesh_map
+{
+/**
+ * @brief Builds, serialises and publishes large messages on a background thread. Only the latest message per key is
+ * kept, superseded messages are dropped without being built. Each key is published at most with the configured rate
+ * and all publications share the configured bandwidth budget, thus callers only pay for queueing a snapshot of their
+ * data, independent of the connected subscribers.
+ */
+class BackgroundPublisher
+{
+public:
+  /**
+   * @brief Builds and publishes a message, returns the number of serialised bytes
+   */
+  using PublishFunction = std::function<size_t()>;
+
+  /**
+   * @brief Constructor, starts the publishing thread
+   */
+  BackgroundPublisher();
+
+  /**
+   * @brief Destructor, stops the publishing thread, pending messages are dropped
+   */
+  ~BackgroundPublisher();
+
+  /**
+   * @brief Sets the maximum rate in Hz with which the messages of a key are published
+   */
+  void setRate(const double rate);
+
+  /**
+   * @brief Sets the bandwidth budget in bytes per second shared by all publications, zero disables the limit
+   */
+  void setBandwidth(const double bytes_per_second);
+
+  /**
+   * @brief Queues the publication for the key, it replaces a pending publication of the same key
+   * @param key The key, e.g. the topic and the layer name
+   * @param publish Builds and publishes the message on the background thread
+   */
+  void publish(const std::string& key, PublishFunction&& publish);
+
+  /**
+   * @brief Queues the message built by the given function for the publisher
+   * @param key The key, e.g. the topic and the layer name
+   * @param pub The publisher
+   * @param build Builds the message on the background thread
+   */
+  template <typename MessageT>
+  void publish(const std::string& key, const ros::Publisher& pub, std::function<MessageT()>&& build)
+  {
+    publish(key, [pub, build = std::move(build)]() {
+      const MessageT msg = build();
+      pub.publish(msg);
+      return static_cast<size_t>(ros::serialization::serializationLength(msg));
+    });
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  //! the latest publication of a key
+  struct Entry
+  {
+    //! the pending publication, empty if there is none
+    PublishFunction publish;
+
+    //! the order in which the pending publications have been queued
+    uint64_t sequence = 0;
+
+    //! the time of the last publication of the key
+    Clock::time_point last_publication;
+  };
+
+  /**
+   * @brief Publishes the pending entries within the rate and bandwidth limits until the publisher is destroyed
+   */
+  void run();
+
+  //! guards all following members
+  std::mutex mtx;
+
+  //! notifies the publishing thread about queued publications, changed limits and the shutdown
+  std::condition_variable cv;
+
+  std::map<std::string, Entry> entries;
+  uint64_t sequence;
+
+  //! the minimum time between two publications of a key
+  Clock::duration period;
+
+  //! the bandwidth budget in bytes per second, zero if unlimited
+  double bandwidth;
+
+  //! the next publication has to wait until the budget used by the previous ones has been refilled
+  Clock::time_point budget_time;
+
+  bool shutdown;
+  std::thread publish_thread;
+};
+
+}  // namespace mesh_map
+
+#endif  // MESH_MAP__BACKGROUND_PUBLISHER_H
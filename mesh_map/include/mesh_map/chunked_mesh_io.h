@@ -0,0 +1,258 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__CHUNKED_MESH_IO_H
+#define MESH_MAP__CHUNKED_MESH_IO_H
+
+#include <array>
+#include <lvr2/io/AttributeMeshIOBase.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mesh_map
+{
+/**
+ * @brief Out-of-core access to a map which has been partitioned into spatial chunks, see partition(). Each chunk
+ * contains the faces whose centroids lie in its cell of the xy-grid plus a halo of the neighbouring faces, thus local
+ * computations near the cell borders have the complete neighbourhood. Only the chunks of the region set with
+ * setRegion() are read from the wrapped mesh io and stitched, the region is exposed as a regular mesh through the
+ * AttributeMeshIOBase interface. The stitched region stays in memory as a whole, the memory budget only bounds the
+ * chunks which are cached to stitch further attribute channels of the region on demand. Added channels, e.g. computed
+ * layers and their fingerprints, are written to the wrapped mesh io in groups keyed by the region's fingerprint, thus
+ * they never overwrite the channels of the complete map or of other regions and are found again for the same region.
+ */
+class ChunkedMeshIO : public lvr2::AttributeMeshIOBase
+{
+public:
+  /**
+   * @brief Constructor
+   * @param io The mesh io of the partitioned map, e.g. the HDF5 map file
+   * @param memory_budget The maximum memory in bytes used by the cached chunks
+   */
+  ChunkedMeshIO(std::shared_ptr<lvr2::AttributeMeshIOBase> io, const size_t memory_budget);
+
+  /**
+   * @brief Partitions the mesh of the given mesh io into chunks and stores them together with the chunk index
+   * @param io The mesh io of the map, the chunks are added to it
+   * @param chunk_size The edge length of the chunks' cells in the xy-plane
+   * @param halo The distance to the cell up to which neighbouring faces are added to a chunk
+   * @param channels The vertex or face attribute channels which are partitioned with the geometry
+   * @return true if the chunks and the index have been stored successfully
+   */
+  static bool partition(lvr2::AttributeMeshIOBase& io, const float chunk_size, const float halo,
+                        const std::vector<std::string>& channels);
+
+  /**
+   * @brief Reads the chunk index of the map
+   * @return false if the map has not been partitioned
+   */
+  bool open();
+
+  /**
+   * @brief Returns the number of chunks of the map
+   */
+  size_t numChunks();
+
+  /**
+   * @brief Returns the chunks whose cells overlap the given box in the xy-plane
+   */
+  std::vector<uint32_t> chunksInBox(const float min_x, const float min_y, const float max_x, const float max_y);
+
+  /**
+   * @brief Stitches the chunks of the given box, the stitched mesh is returned by getVertices(), getIndices() and
+   * getChannel() afterwards. The geometry which has been added for the previous region is dropped, the channels stored
+   * for it are kept in the wrapped mesh io.
+   * @return true if the region contains at least one face
+   */
+  bool setRegion(const float min_x, const float min_y, const float max_x, const float max_y);
+
+  /**
+   * @brief Returns the memory in bytes used by the cached chunks
+   */
+  size_t memoryUsage();
+
+  lvr2::FloatChannelOptional getVertices();
+
+  lvr2::IndexChannelOptional getIndices();
+
+  bool addVertices(const lvr2::FloatChannel& channel_ptr);
+
+  bool addIndices(const lvr2::IndexChannel& channel_ptr);
+
+  bool getChannel(const std::string group, const std::string name, lvr2::FloatChannelOptional& channel);
+
+  bool getChannel(const std::string group, const std::string name, lvr2::IndexChannelOptional& channel);
+
+  bool getChannel(const std::string group, const std::string name, lvr2::UCharChannelOptional& channel);
+
+  bool addChannel(const std::string group, const std::string name, const lvr2::FloatChannel& channel);
+
+  bool addChannel(const std::string group, const std::string name, const lvr2::IndexChannel& channel);
+
+  bool addChannel(const std::string group, const std::string name, const lvr2::UCharChannel& channel);
+
+  //! the group of the chunks and the chunk index in the map
+  static const std::string CHANNEL_GROUP;
+
+  //! the version of the stored chunk format
+  static const uint32_t FORMAT_VERSION;
+
+  //! the prefix of the groups in which the added channels of the regions are stored, followed by the region's key
+  static const std::string REGION_PREFIX;
+
+private:
+  /**
+   * @brief The mesh stitched from chunks, the vertices and faces are merged by their global ids
+   */
+  struct StitchedMesh
+  {
+    lvr2::FloatChannelOptional vertices;
+    lvr2::IndexChannelOptional indices;
+
+    //! the global vertex ids of the vertices, i.e. their indices in the complete map
+    std::vector<lvr2::Index> vertex_ids;
+
+    //! the global face ids of the faces, i.e. their indices in the complete map
+    std::vector<lvr2::Index> face_ids;
+
+    //! the stitched vertex or face attribute channels
+    std::map<std::string, lvr2::FloatChannel> channels;
+  };
+
+  //! a loaded chunk, the attribute channels are loaded on demand
+  struct Chunk
+  {
+    lvr2::IndexChannelOptional vertex_ids;
+    lvr2::FloatChannelOptional vertices;
+    lvr2::IndexChannelOptional face_ids;
+    lvr2::IndexChannelOptional indices;
+
+    //! the loaded vertex and face attribute channels, prefixed with "v_" and "f_"
+    std::map<std::string, lvr2::FloatChannel> channels;
+
+    //! the attribute channels which are not contained in the chunk
+    std::vector<std::string> missing;
+
+    size_t bytes = 0;
+    uint64_t last_use = 0;
+    bool failed = false;
+  };
+
+  //! the chunks of a stitched mesh with the mapping of their vertices and faces to the stitched ones
+  struct Stitching
+  {
+    std::vector<uint32_t> chunks;
+    std::vector<std::vector<lvr2::Index>> vertex_maps;
+    std::vector<std::vector<lvr2::Index>> face_maps;
+    StitchedMesh mesh;
+
+    //! the number of edges of the stitched mesh
+    size_t num_edges = 0;
+
+    //! the fingerprint of the stitched mesh's global ids and geometry
+    uint32_t fingerprint = 0;
+  };
+
+  /**
+   * @brief Returns the chunks overlapping the box, the lock is held
+   */
+  std::vector<uint32_t> chunksInBoxLocked(const float min_x, const float min_y, const float max_x, const float max_y);
+
+  /**
+   * @brief Returns the chunk, its geometry is loaded if it is not loaded yet, the lock is held
+   */
+  Chunk& loadChunk(const uint32_t id);
+
+  /**
+   * @brief Returns the vertex or face attribute channel of the chunk, loads it if it is not loaded yet
+   * @param id The chunk id
+   * @param name The channel name
+   * @param per_vertex Is set to true for vertex and to false for face attribute channels
+   * @return the channel or null if the chunk does not contain the channel
+   */
+  const lvr2::FloatChannel* loadChunkChannel(const uint32_t id, const std::string& name, bool& per_vertex);
+
+  /**
+   * @brief Stitches the geometry of the given chunks, the lock is held
+   */
+  bool stitch(const std::vector<uint32_t>& chunks, Stitching& stitching);
+
+  /**
+   * @brief Stitches the attribute channel of the chunks, the lock is held
+   * @return false if none of the chunks contains the channel
+   */
+  bool stitchChannel(Stitching& stitching, const std::string& name);
+
+  /**
+   * @brief Returns the group in which the added channels of the given group are stored for the region, the lock is held
+   */
+  std::string regionGroup(const std::string& group) const;
+
+  /**
+   * @brief Evicts the least recently used chunks until the memory budget is met, the lock is held
+   */
+  void evict();
+
+  //! the mesh io of the partitioned map
+  std::shared_ptr<lvr2::AttributeMeshIOBase> io_ptr;
+
+  const size_t memory_budget;
+
+  //! guards all following members
+  std::mutex mtx;
+
+  //! the cells of the chunks in the xy-plane, min x, min y, max x, max y
+  std::vector<std::array<float, 4>> chunk_cells;
+
+  std::map<uint32_t, Chunk> loaded_chunks;
+  size_t memory_usage;
+  uint64_t use_counter;
+
+  //! the region exposed through the mesh io interface
+  std::unique_ptr<Stitching> region;
+
+  //! the geometry which has been added through the mesh io interface
+  lvr2::FloatChannelOptional added_vertices;
+  lvr2::IndexChannelOptional added_indices;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__CHUNKED_MESH_IO_H
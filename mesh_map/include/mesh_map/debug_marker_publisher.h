@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__DEBUG_MARKER_PUBLISHER_H
+#define MESH_MAP__DEBUG_MARKER_PUBLISHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <ros/ros.h>
+#include <thread>
+#include <visualization_msgs/Marker.h>
+
+namespace mesh_map
+{
+/**
+ * @brief Collects debug markers and publishes them rate-limited as one visualization_msgs/MarkerArray from a
+ * background thread. Only the latest marker per namespace and id is kept between two publications, thus callers on
+ * time critical paths only pay for a map insertion, and nothing if the publisher is disabled.
+ */
+class DebugMarkerPublisher
+{
+public:
+  /**
+   * @brief Constructor, advertises the marker array topic and starts the publishing thread
+   * @param nh The node handle to advertise the topic with
+   * @param topic The topic name
+   */
+  DebugMarkerPublisher(ros::NodeHandle& nh, const std::string& topic);
+
+  /**
+   * @brief Destructor, stops the publishing thread
+   */
+  ~DebugMarkerPublisher();
+
+  /**
+   * @brief Returns true if markers are collected and published. Callers should check it before building markers.
+   */
+  bool enabled() const
+  {
+    return is_enabled;
+  }
+
+  /**
+   * @brief Enables or disables the publisher, disabling drops all pending markers
+   */
+  void setEnabled(const bool enabled);
+
+  /**
+   * @brief Sets the maximum rate in Hz with which marker arrays are published
+   */
+  void setRate(const double rate);
+
+  /**
+   * @brief Queues the marker for the next publication, it replaces a pending marker with the same namespace and id
+   * @param marker The marker to publish
+   */
+  void add(visualization_msgs::Marker&& marker);
+
+private:
+  /**
+   * @brief Publishes the pending markers at the configured rate until the publisher is destroyed
+   */
+  void run();
+
+  //! the marker array publisher
+  ros::Publisher marker_array_pub;
+
+  //! pending markers by namespace and id
+  std::map<std::pair<std::string, int32_t>, visualization_msgs::Marker> pending;
+
+  //! guards the pending markers and the period
+  std::mutex pending_mtx;
+
+  //! notifies the publishing thread on shutdown
+  std::condition_variable shutdown_cv;
+
+  //! the time between two publications
+  std::chrono::milliseconds period;
+
+  //! whether markers are collected
+  std::atomic<bool> is_enabled;
+
+  //! stops the publishing thread
+  bool shutdown;
+
+  //! the publishing thread
+  std::thread publish_thread;
+};
+
+}  // namespace mesh_map
+
+#endif  // MESH_MAP__DEBUG_MARKER_PUBLISHER_H
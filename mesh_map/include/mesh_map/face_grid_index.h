@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__FACE_GRID_INDEX_H
+#define MESH_MAP__FACE_GRID_INDEX_H
+
+#include <array>
+#include <boost/optional.hpp>
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/HalfEdgeMesh.hpp>
+#include <tuple>
+#include <vector>
+
+namespace mesh_map
+{
+/**
+ * @brief Uniform 2.5D grid in the xy plane, which maps each grid cell to the triangles overlapping it. Each triangle
+ * is stored with its z interval, thus overlapping surfaces, e.g. bridges, are told apart by a z hint. Locating the
+ * triangle of a position only tests the few triangles of its cell, which makes the index well suited for terrain
+ * meshes with little overhang. The cells are stored in a compressed row layout, which is built in parallel.
+ */
+class FaceGridIndex
+{
+public:
+  typedef lvr2::BaseVector<float> Vector;
+
+  /**
+   * @brief Builds the index of all triangles of the mesh
+   * @param mesh The mesh to index, it has to outlive the index and must not be modified
+   * @param cell_size The edge length of the grid cells, it is enlarged if the grid would get too many cells
+   */
+  FaceGridIndex(const lvr2::HalfEdgeMesh<Vector>& mesh, const float cell_size);
+
+  /**
+   * @brief Locates the triangle which contains the given position in the xy plane and whose surface is closest to
+   * the z hint
+   * @param x The x coordinate of the query position
+   * @param y The y coordinate of the query position
+   * @param z_hint The z coordinate of the query position, which selects between overlapping surfaces
+   * @param max_dist The maximum vertical distance of the surface to the z hint
+   * @return Optional tuple of the triangle and the barycentric coordinates of the position within it
+   */
+  boost::optional<std::tuple<lvr2::FaceHandle, std::array<float, 3>>> locate(const float x, const float y,
+                                                                              const float z_hint,
+                                                                              const float max_dist) const;
+
+  /**
+   * @brief Returns the edge length of the grid cells
+   */
+  float cellSize() const
+  {
+    return cell_size;
+  }
+
+  /**
+   * @brief Returns the number of grid cells
+   */
+  size_t numCells() const
+  {
+    return num_x * num_y;
+  }
+
+  /**
+   * @brief Returns the memory used by the index in bytes
+   */
+  size_t memoryUsage() const;
+
+private:
+  //! the indexed mesh
+  const lvr2::HalfEdgeMesh<Vector>& mesh;
+
+  //! edge length of the grid cells
+  float cell_size;
+
+  //! minimum x and y coordinates of the grid
+  float min_x, min_y;
+
+  //! number of cells in x and y direction
+  size_t num_x, num_y;
+
+  //! the triangles of cell i are stored in cell_faces[cell_offsets[i]] to cell_faces[cell_offsets[i + 1] - 1]
+  std::vector<size_t> cell_offsets;
+
+  //! the triangle indices of all cells
+  std::vector<uint32_t> cell_faces;
+
+  //! z interval of each triangle, empty for invalid triangles
+  std::vector<std::array<float, 2>> face_z;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__FACE_GRID_INDEX_H
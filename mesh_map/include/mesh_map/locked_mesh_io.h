@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__LOCKED_MESH_IO_H
+#define MESH_MAP__LOCKED_MESH_IO_H
+
+#include <lvr2/io/AttributeMeshIOBase.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace mesh_map
+{
+/**
+ * @brief Serialises all channel accesses to the wrapped mesh io, e.g. the HDF5 file or the mesh client. Neither of
+ * them is thread safe, but the layer plugins are initialised concurrently and read or write their attributes through
+ * the shared mesh io.
+ */
+class LockedMeshIO : public lvr2::AttributeMeshIOBase
+{
+public:
+  /**
+   * @brief Constructor
+   * @param io The wrapped mesh io
+   */
+  explicit LockedMeshIO(std::shared_ptr<lvr2::AttributeMeshIOBase> io);
+
+  /**
+   * @brief Returns the wrapped mesh io, accesses to it are not serialised
+   */
+  const std::shared_ptr<lvr2::AttributeMeshIOBase>& wrapped() const
+  {
+    return io_ptr;
+  }
+
+  lvr2::FloatChannelOptional getVertices();
+
+  lvr2::IndexChannelOptional getIndices();
+
+  bool addVertices(const lvr2::FloatChannel& channel_ptr);
+
+  bool addIndices(const lvr2::IndexChannel& channel_ptr);
+
+  bool getChannel(const std::string group, const std::string name, lvr2::FloatChannelOptional& channel);
+
+  bool getChannel(const std::string group, const std::string name, lvr2::IndexChannelOptional& channel);
+
+  bool getChannel(const std::string group, const std::string name, lvr2::UCharChannelOptional& channel);
+
+  bool addChannel(const std::string group, const std::string name, const lvr2::FloatChannel& channel);
+
+  bool addChannel(const std::string group, const std::string name, const lvr2::IndexChannel& channel);
+
+  bool addChannel(const std::string group, const std::string name, const lvr2::UCharChannel& channel);
+
+private:
+  //! the wrapped mesh io
+  std::shared_ptr<lvr2::AttributeMeshIOBase> io_ptr;
+
+  //! guards all accesses to the wrapped mesh io
+  std::mutex mtx;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__LOCKED_MESH_IO_H
@@ -45,6 +45,11 @@
 #include <lvr2/io/HDF5IO.hpp>
 #include <mesh_map/MeshMapConfig.h>
 #include <mesh_map/abstract_layer.h>
+#include <mesh_map/background_publisher.h>
+#include <mesh_map/chunked_mesh_io.h>
+#include <mesh_map/debug_marker_publisher.h>
+#include <mesh_map/face_grid_index.h>
+#include <mesh_map/vertex_costs_delta.h>
 #include <mesh_msgs/MeshVertexCosts.h>
 #include <mesh_msgs/MeshVertexColors.h>
 #include <mutex>
@@ -52,6 +57,7 @@
 #include <std_msgs/ColorRGBA.h>
 #include <tf2_ros/buffer.h>
 #include <tuple>
+#include <visualization_msgs/Marker.h>
 #include "nanoflann.hpp"
 #include "nanoflann_mesh_adaptor.h"
 
@@ -115,6 +121,33 @@ public:
   boost::optional<std::tuple<lvr2::FaceHandle, std::array<mesh_map::Vector, 3>,
     std::array<float, 3>>> searchContainingFace(Vector& position, const float& max_dist);
 
+  /**
+   * @brief Locates the triangle below or above the given xy position, whose surface is closest to the z hint. Uses the
+   * face grid index if it is enabled with the parameter "face_grid_cell_size", otherwise searchContainingFace().
+   * @param x The x coordinate of the query position
+   * @param y The y coordinate of the query position
+   * @param z_hint The z coordinate of the query position, which selects between overlapping surfaces
+   * @param max_dist The maximum distance of the surface to the z hint
+   * @return optional tuple of the corresponding triangle and the barycentric coordinates of the position within it
+   */
+  boost::optional<std::tuple<lvr2::FaceHandle, std::array<float, 3>>> locateFace(const float x, const float y,
+                                                                                  const float z_hint,
+                                                                                  const float max_dist);
+
+  /**
+   * @brief Projects a batch of points onto the mesh, the points are processed concurrently. For each point the
+   * triangles around the closest vertex are searched for the one with the smallest distance, which contains the
+   * point's projection.
+   * @param points The query positions in the map frame
+   * @param max_dist The maximum distance of a point to its triangle
+   * @param faces Filled with the triangle of each point, the optional is invalid if no triangle has been found
+   * @param barycentric_coords Filled with the barycentric coordinates of each point's projection
+   * @param heights Filled with the signed distance of each point to its triangle, positive along the triangle normal
+   */
+  void projectPoints(const std::vector<Vector>& points, const float max_dist,
+                     std::vector<lvr2::OptionalFaceHandle>& faces,
+                     std::vector<std::array<float, 3>>& barycentric_coords, std::vector<float>& heights);
+
   /**
    * @brief reconfigure callback function which is called if a dynamic reconfiguration were triggered.
    */
@@ -178,6 +211,15 @@ public:
    */
   void layerChanged(const std::string& layer_name);
 
+  /**
+   * @brief Callback function which is called from inside a layer plugin if the cost values of some vertices change.
+   * Only the combined costs and edge weights of these vertices are updated. The following layers are updated
+   * completely if the "lethal" vertices changed and one of them depends on them.
+   * @param layer_name the name of the layer.
+   * @param changed_vertices the vertices whose cost values or "lethal" state changed.
+   */
+  void layerChanged(const std::string& layer_name, const std::set<lvr2::VertexHandle>& changed_vertices);
+
   /**
    * @brief Compute all contours and returns the corresponding vertices to use these as lethal vertices.
    * @param min_contour_size The minimum contour size, i.e. the number of vertices per contour.
@@ -278,6 +320,22 @@ public:
     return vertex_costs;
   }
 
+  /**
+   * @brief Returns true if the map has been loaded and its layers have been initialized
+   */
+  bool isLoaded()
+  {
+    return map_loaded;
+  }
+
+  /**
+   * @brief Returns the transformation buffer
+   */
+  tf2_ros::Buffer& tfBuffer()
+  {
+    return tf_buffer;
+  }
+
   /**
    * @brief Returns the map frame / coordinate system id
    */
@@ -310,6 +368,15 @@ public:
     return edge_weights;
   }
 
+  /**
+   * @brief Returns a counter which is incremented each time the combined costs and edge weights are recomputed.
+   * Allows planners to detect whether derived data, e.g. a precomputed graph, is outdated.
+   */
+  uint64_t costVersion()
+  {
+    return cost_version;
+  }
+
   /**
    * @brief Returns the mesh's vertex distances
    */
@@ -331,6 +398,19 @@ public:
   searchNeighbourFaces(const Vector& pos, const lvr2::FaceHandle& face,
                        const float& max_radius, const float& max_dist);
 
+  /**
+   * Walks from the given face across shared edges towards the face containing the given position, using the
+   * precomputed face neighbours. The walk does not allocate memory and is bounded by the given number of steps.
+   * @param pos         The position to locate
+   * @param face        The face to start the walk at, set to the reached face
+   * @param bary_coords The barycentric coordinates of the position's projection onto the reached face
+   * @param dist        The signed distance of the position to the reached face
+   * @param max_steps   The maximum number of crossed edges
+   * @return true if a face containing the position's projection has been reached
+   */
+  bool walkToFace(const Vector& pos, lvr2::FaceHandle& face, std::array<float, 3>& bary_coords, float& dist,
+                  const size_t max_steps);
+
   /**
    * Finds the next position given a position vector and its corresponding face
    * handle by following the direction For: look ahead when using mesh gradient
@@ -342,11 +422,66 @@ public:
    */
   bool meshAhead(Vector& vec, lvr2::FaceHandle& face, const float& step_width);
 
+  /**
+   * Finds the next position given a position vector and its corresponding face
+   * handle by following the given vector field instead of the stored one.
+   * @param vec   direction vector from which the next step vector is calculated
+   * @param face  face of the direction vector
+   * @param step_width The step length to go ahead on the mesh surface
+   * @param vector_map The vector field to follow
+   * @return      new vector (also updates the ahead_face handle to correspond
+   * to the new vector)
+   */
+  bool meshAhead(Vector& vec, lvr2::FaceHandle& face, const float& step_width,
+                 const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map);
+
+  /**
+   * Moves the position along the interpolated vector field up to the next edge crossing of its face, but at most
+   * the given step width. If an edge is crossed, the face is set to the neighbour across that edge, thus tracing a
+   * path costs one step per crossed face and no neighbour searches.
+   * @param vec   the position which is moved ahead
+   * @param face  face of the position, updated if an edge is crossed
+   * @param step_width The maximum step length on the mesh surface
+   * @param vector_map The vector field to follow
+   * @return true if the position has been moved ahead
+   */
+  bool meshAheadExact(Vector& vec, lvr2::FaceHandle& face, const float& step_width,
+                      const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map);
+
+  /**
+   * Computes the direction of the given vector field combined with the materialised vector field of all layers
+   * @param vector_map The vector field to use
+   * @param vertices The triangle's vertices
+   * @param barycentric_coords The barycentric coordinates of the query position
+   * @return An optional normalized direction, it is valid if the vector field is defined at the position
+   */
+  boost::optional<Vector> combinedDirectionAtPosition(const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map,
+                                                      const std::array<lvr2::VertexHandle, 3>& vertices,
+                                                      const std::array<float, 3>& barycentric_coords);
+
+  /**
+   * @brief Returns the neighbours of each face, the k-th entry is the neighbour across the edge opposite to the
+   * face's k-th vertex. The entry is invalid at the mesh's border.
+   */
+  const lvr2::DenseFaceMap<std::array<lvr2::OptionalFaceHandle, 3>>& faceNeighbours()
+  {
+    return face_neighbours;
+  }
+
   /**
    * @brief Stores the given vector map
    */
   void setVectorMap(lvr2::DenseVertexMap<mesh_map::Vector>& vector_map);
 
+  /**
+   * @brief Returns true if debug markers are published, callers on time critical paths should check it before
+   * publishing debug markers.
+   */
+  bool debugEnabled() const
+  {
+    return debug_marker_pub && debug_marker_pub->enabled();
+  }
+
   /**
    * @brief Publishes a position as marker. Used for debug purposes.
    * @param pos The position to publish as marker
@@ -386,10 +521,107 @@ public:
                           const bool publish_face_vectors = false);
 
   /**
-   * @brief Publishes the vector field as visualisation_msgs/Marker
+   * @brief Publishes the combined vector field of all layers as visualisation_msgs/Marker
    */
   void publishCombinedVectorField();
 
+  /**
+   * @brief Re-evaluates the vectors of the given layer at all vertices and updates the combined layer vector field
+   * where the vectors have changed
+   * @param layer_name The name of the layer
+   */
+  void updateLayerVectors(const std::string& layer_name);
+
+  /**
+   * @brief Re-evaluates the vectors of the given layer at the changed vertices only and updates the combined layer
+   * vector field where the vectors have changed
+   * @param layer_name The name of the layer
+   * @param changed_vertices The vertices at which the layer's vectors may have changed
+   */
+  void updateLayerVectors(const std::string& layer_name, const std::set<lvr2::VertexHandle>& changed_vertices);
+
+  /**
+   * @brief Computes the fingerprint of the layer data from the layer type, its parameters, the mesh and, if the layer
+   * depends on them, the lethal vertices of the previous layers
+   * @param index The index of the layer in the layer list
+   * @return The fingerprint the layer data is stored with
+   */
+  uint32_t layerFingerprint(const size_t index);
+
+  /**
+   * @brief Checks whether the layer data has been stored with the given fingerprint
+   * @param layer_name The name of the layer
+   * @param fingerprint The fingerprint of the current layer data, see layerFingerprint()
+   * @return true if the stored layer data matches the fingerprint and can be read
+   */
+  bool layerStored(const std::string& layer_name, const uint32_t fingerprint);
+
+  /**
+   * @brief Writes the layer data and its fingerprint in the background, if it has not been stored with the same
+   * fingerprint yet
+   * @param index The index of the layer in the layer list
+   * @param fingerprint The fingerprint of the current layer data, see layerFingerprint()
+   */
+  void persistLayer(const size_t index, const uint32_t fingerprint);
+
+  /**
+   * @brief Updates the lethals and costs of all layers following the changed layer and recombines the costs, expects
+   * the layer mutex to be locked
+   * @param layer_name The name of the changed layer
+   * @param persist Whether the changed and the following layers are stored in the map
+   */
+  void updateLayers(const std::string& layer_name, const bool persist);
+
+  /**
+   * @brief Returns the given vertices which are "lethal" in any of the first layers, expects the layer mutex to be
+   * locked
+   * @param vertices The vertices to check
+   * @param num_layers The number of layers to check, starting with the first layer
+   * @return The subset of the given vertices which are "lethal"
+   */
+  std::set<lvr2::VertexHandle> lethalVertices(const std::set<lvr2::VertexHandle>& vertices, const size_t num_layers);
+
+  /**
+   * @brief Computes the weight of the edge from its length and the combined costs of its vertices
+   * @param eH The edge to update in the edge weights
+   */
+  void updateEdgeWeight(const lvr2::EdgeHandle& eH);
+
+  /**
+   * @brief Publishes the cost layer in full on the vertex_costs topic, or its changes on the vertex_costs_delta topic
+   * if the delta publication is enabled
+   * @param costs The cost map to publish
+   * @param default_value The cost of vertices which are not contained in the cost map
+   * @param name The name of the cost map
+   */
+  void publishLayerCosts(const lvr2::VertexMap<float>& costs, const float default_value, const std::string& name);
+
+  /**
+   * @brief Builds the vector field marker, see publishVectorField()
+   */
+  visualization_msgs::Marker vectorFieldMarker(const std::string& name,
+                                               const lvr2::DenseVertexMap<lvr2::BaseVector<float>>& vector_map,
+                                               const lvr2::DenseVertexMap<float>& values,
+                                               const std::function<float(float)>& cost_function,
+                                               const bool publish_face_vectors);
+
+  /**
+   * @brief Returns the sum of all layer vectors at each vertex
+   */
+  const lvr2::DenseVertexMap<mesh_map::Vector>& layerVertexVectors()
+  {
+    return layer_vertex_vectors;
+  }
+
+  /**
+   * @brief Returns the chunks of the partitioned map file, e.g. to query the chunks overlapping a box. Null if the map is
+   * not loaded in chunks.
+   */
+  const std::shared_ptr<ChunkedMeshIO>& chunkedMap()
+  {
+    return chunked_io_ptr;
+  }
+
   /**
    * @brief returns a shared pointer to the specified layer
    */
@@ -401,24 +633,53 @@ public:
   lvr2::DenseVertexMap<bool> invalid;
 
 private:
+  /**
+   * @brief Re-evaluates the vectors of the given layer at the given vertices and updates the combined layer vector
+   * field where the vectors have changed
+   * @param layer_name The name of the layer
+   * @param vertices The vertices to re-evaluate
+   */
+  void updateLayerVectors(const std::string& layer_name, const std::vector<lvr2::VertexHandle>& vertices);
+
   //! plugin class loader for for the layer plugins
   pluginlib::ClassLoader<mesh_map::AbstractLayer> layer_loader;
 
   //! mapping from name to layer instance
   std::map<std::string, mesh_map::AbstractLayer::Ptr> layer_names;
 
+  //! mapping from name to the plugin type of the layer
+  std::map<std::string, std::string> layer_types;
+
+  //! the fingerprints the layers have been stored with or are being stored with in the background
+  std::map<std::string, uint32_t> persisted_fingerprints;
+
+  //! fingerprint of the mesh geometry, it is part of all layer fingerprints
+  uint32_t mesh_fingerprint;
+
   //! vector of name and layer instances
   std::vector<std::pair<std::string, mesh_map::AbstractLayer::Ptr>> layers;
 
+  //! the materialised vertex vectors of each layer
+  std::map<std::string, lvr2::DenseVertexMap<mesh_map::Vector>> layer_vectors;
+
+  //! combined vertex vectors of all layers
+  lvr2::DenseVertexMap<mesh_map::Vector> layer_vertex_vectors;
+
   //! each layer maps to a set of impassable indices
   std::map<std::string, std::set<lvr2::VertexHandle>> lethal_indices;
 
   //! all impassable vertices
   std::set<lvr2::VertexHandle> lethals;
 
+  //! the upstream lethals each layer which depends on them has been updated with, indexed like the layers
+  std::vector<std::set<lvr2::VertexHandle>> upstream_lethals;
+
   //! global frame / coordinate system id
   std::string global_frame;
 
+  //! the robot frame, the vector field can be limited to its neighbourhood
+  std::string robot_frame;
+
   //! server url
   std::string srv_url;
 
@@ -428,12 +689,34 @@ private:
   //! login password to connect to the server
   std::string srv_password;
 
+  //! directory of the persistent channel cache for the server, empty to disable it
+  std::string srv_cache_directory;
+
+  //! whether the compact, quantized channel encodings are requested from the server
+  bool srv_compact_encoding;
+
   std::string mesh_layer;
 
   float min_roughness;
   float max_roughness;
   float min_height_diff;
   float max_height_diff;
+
+  //! whether only the chunks of the bounding box are loaded from the partitioned map file
+  bool chunked_map;
+
+  //! memory budget for the loaded chunks of the partitioned map file in MB
+  int chunk_memory_budget;
+
+  //! pages the chunks of the partitioned map file, null if the chunked mode is disabled
+  std::shared_ptr<ChunkedMeshIO> chunked_io_ptr;
+
+  //! edge length of the face grid cells, 0 disables the face grid index
+  float face_grid_cell_size;
+
+  //! 2.5D grid index to locate triangles by their xy position, null if it is disabled
+  std::unique_ptr<FaceGridIndex> face_grid_ptr;
+
   float bb_min_x;
   float bb_min_y;
   float bb_min_z;
@@ -447,6 +730,9 @@ private:
   //! combined layer costs
   lvr2::DenseVertexMap<float> vertex_costs;
 
+  //! weighting factor of each layer, in the order of the layers, used when the costs are combined
+  std::vector<float> layer_factors;
+
   //! stored vector map to share between planner and controller
   lvr2::DenseVertexMap<mesh_map::Vector> vector_map;
 
@@ -456,23 +742,44 @@ private:
   //! edge weights
   lvr2::DenseEdgeMap<float> edge_weights;
 
+  //! incremented each time the combined costs and edge weights have been updated
+  std::atomic<uint64_t> cost_version;
+
   //! triangle normals
   lvr2::DenseFaceMap<Normal> face_normals;
 
   //! vertex normals
   lvr2::DenseVertexMap<Normal> vertex_normals;
 
+  //! neighbours of each face across the edges opposite to its vertices
+  lvr2::DenseFaceMap<std::array<lvr2::OptionalFaceHandle, 3>> face_neighbours;
+
   //! publisher for vertex costs
   ros::Publisher vertex_costs_pub;
 
+  //! publisher for the changes of the vertex costs
+  std::unique_ptr<VertexCostsDeltaPublisher> vertex_costs_delta_pub;
+
+  //! whether the vertex costs are published as deltas
+  std::atomic<bool> publish_cost_deltas;
+
+  //! whether computed layers are stored with their fingerprint in the map
+  std::atomic<bool> persist_layers;
+
+  //! the number of vectors per square metre in the published vector fields, zero publishes all vectors
+  std::atomic<float> vector_field_density;
+
+  //! the radius around the robot the published vector fields are limited to, zero publishes the whole map
+  std::atomic<float> vector_field_radius;
+
   //! publisher for vertex colors
   ros::Publisher vertex_colors_pub;
 
   //! publisher for the mesh geometry
   ros::Publisher mesh_geometry_pub;
 
-  //! publisher for the debug markers
-  ros::Publisher marker_pub;
+  //! rate-limited publisher for the debug markers
+  std::unique_ptr<DebugMarkerPublisher> debug_marker_pub;
 
   //! publisher for the stored vector field
   ros::Publisher vector_field_pub;
@@ -487,7 +794,7 @@ private:
   bool first_config;
 
   //! indicates whether the map has been loaded
-  bool map_loaded;
+  std::atomic<bool> map_loaded;
 
   //! current mesh map configuration
   MeshMapConfig config;
@@ -514,6 +821,12 @@ private:
 
   //! k-d tree to query mesh vertices in logarithmic time
   std::unique_ptr<KDTree> kd_tree_ptr;
+
+  //! writes the computed layers to the map in the background, only the latest pending write of a layer is kept
+  std::unique_ptr<BackgroundPublisher> layer_writer;
+
+  //! builds and publishes the large messages in the background, declared last to be stopped first on destruction
+  std::unique_ptr<BackgroundPublisher> background_pub;
 };
 
 } /* namespace mesh_map */
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__RING_BUFFER_H
+#define MESH_MAP__RING_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace mesh_map
+{
+/**
+ * @brief First-in first-out queue in a contiguous ring of elements. The capacity is a power of two and is doubled if
+ * the ring is full, thus a queue with a steady size does not allocate.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /**
+   * @brief Creates an empty ring
+   * @param capacity The initial capacity, rounded up to a power of two
+   */
+  explicit RingBuffer(const size_t capacity = 1024) : head(0), count(0)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    ring.resize(size);
+  }
+
+  /**
+   * @brief Appends an element to the back of the queue
+   */
+  void push_back(const T& element)
+  {
+    if (count == ring.size())
+      grow();
+    ring[(head + count) & (ring.size() - 1)] = element;
+    count++;
+  }
+
+  /**
+   * @brief Returns the oldest element, the queue must not be empty
+   */
+  const T& front() const
+  {
+    return ring[head];
+  }
+
+  /**
+   * @brief Removes the oldest element, the queue must not be empty
+   */
+  void pop_front()
+  {
+    head = (head + 1) & (ring.size() - 1);
+    count--;
+  }
+
+  /**
+   * @brief Returns the number of queued elements
+   */
+  size_t size() const
+  {
+    return count;
+  }
+
+  /**
+   * @brief Returns true if no element is queued
+   */
+  bool empty() const
+  {
+    return count == 0;
+  }
+
+  /**
+   * @brief Removes all elements, the capacity is kept
+   */
+  void clear()
+  {
+    head = 0;
+    count = 0;
+  }
+
+private:
+  /**
+   * @brief Doubles the capacity and moves the elements to the beginning of the ring
+   */
+  void grow()
+  {
+    std::vector<T> grown(ring.size() * 2);
+    for (size_t i = 0; i < count; i++)
+      grown[i] = ring[(head + i) & (ring.size() - 1)];
+    ring.swap(grown);
+    head = 0;
+  }
+
+  //! the elements, the size is a power of two
+  std::vector<T> ring;
+
+  //! index of the oldest element
+  size_t head;
+
+  //! number of queued elements
+  size_t count;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__RING_BUFFER_H
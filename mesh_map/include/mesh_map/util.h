@@ -45,6 +45,7 @@
 #include <lvr2/geometry/BaseVector.hpp>
 #include <lvr2/geometry/Normal.hpp>
 #include <std_msgs/ColorRGBA.h>
+#include <string>
 
 namespace mesh_map
 {
@@ -206,6 +207,49 @@ std_msgs::ColorRGBA getRainbowColor(const float value);
  */
 void getRainbowColor(float value, float& r, float& g, float& b);
 
+/**
+ * @brief Incremental FNV-1a hash to fingerprint the data which stored results depend on, e.g. the layer parameters and
+ * the mesh, thus stored results which have been computed for other inputs are detected.
+ */
+class Fingerprint
+{
+public:
+  Fingerprint() : hash(2166136261u)
+  {
+  }
+
+  /**
+   * @brief Mixes the given value into the fingerprint
+   */
+  Fingerprint& mix(const uint32_t value);
+
+  /**
+   * @brief Mixes the bit pattern of the given value into the fingerprint
+   */
+  Fingerprint& mix(const float value);
+
+  /**
+   * @brief Mixes the bit pattern of the given value into the fingerprint
+   */
+  Fingerprint& mix(const double value);
+
+  /**
+   * @brief Mixes the characters and the length of the given string into the fingerprint
+   */
+  Fingerprint& mix(const std::string& value);
+
+  /**
+   * @brief Returns the fingerprint of all values mixed in so far
+   */
+  uint32_t value() const
+  {
+    return hash;
+  }
+
+private:
+  uint32_t hash;
+};
+
 } /* namespace mesh_map */
 
 #endif  // MESH_MAP__UTIL_H
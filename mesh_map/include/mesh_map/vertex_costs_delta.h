@@ -0,0 +1,182 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__VERTEX_COSTS_DELTA_H
+#define MESH_MAP__VERTEX_COSTS_DELTA_H
+
+#include <lvr2/attrmaps/AttrMaps.hpp>
+#include <map>
+#include <mesh_map/VertexCostsDelta.h>
+#include <mesh_msgs/MeshVertexCostsStamped.h>
+#include <mutex>
+#include <ros/ros.h>
+#include <string>
+#include <vector>
+
+namespace mesh_map
+{
+/**
+ * @brief Publishes vertex cost layers as mesh_map/VertexCostsDelta messages. Only the vertex ranges which changed
+ * since the last publication of a layer are sent together with a sequence number. Keyframes with all costs are sent
+ * periodically, if most of the costs changed, and directly to each new subscriber, so late subscribers can
+ * resynchronise.
+ */
+class VertexCostsDeltaPublisher
+{
+public:
+  /**
+   * @brief Advertises the delta topic
+   * @param nh The node handle to advertise the topic with
+   * @param topic The topic name
+   */
+  VertexCostsDeltaPublisher(ros::NodeHandle& nh, const std::string& topic);
+
+  /**
+   * @brief Sets the interval between two keyframes of a layer, zero sends keyframes only on demand
+   */
+  void setKeyframeInterval(const double seconds);
+
+  /**
+   * @brief Publishes the changes of the cost layer since its last publication
+   * @param costs The costs of the layer
+   * @param num_vertices The number of vertices of the mesh
+   * @param default_value The cost of vertices which are not contained in the cost map
+   * @param name The name of the layer
+   * @param frame_id The frame of the mesh
+   * @param uuid The uuid of the mesh
+   * @return The number of published bytes
+   */
+  size_t publish(const lvr2::VertexMap<float>& costs, const size_t num_vertices, const float default_value,
+                 const std::string& name, const std::string& frame_id, const std::string& uuid);
+
+  /**
+   * @brief Publishes the changes of the cost layer since its last publication
+   * @param costs The costs of all vertices
+   * @param name The name of the layer
+   * @param frame_id The frame of the mesh
+   * @param uuid The uuid of the mesh
+   * @return The number of published bytes
+   */
+  size_t publish(std::vector<float>&& costs, const std::string& name, const std::string& frame_id,
+                 const std::string& uuid);
+
+private:
+  //! the last published state of a layer
+  struct LayerState
+  {
+    std::vector<float> costs;
+    uint64_t sequence = 0;
+    ros::WallTime last_keyframe;
+    std::string frame_id;
+    std::string uuid;
+  };
+
+  /**
+   * @brief Builds a keyframe of the layer's current state
+   */
+  static mesh_map::VertexCostsDelta keyframe(const std::string& name, const LayerState& state);
+
+  /**
+   * @brief Sends keyframes of all layers to a new subscriber
+   */
+  void connectCallback(const ros::SingleSubscriberPublisher& subscriber);
+
+  //! vertex ranges with a smaller gap between them are merged, a range costs two indices
+  static constexpr size_t MERGE_GAP = 2;
+
+  //! guards the layer states, the connect callback is called from the spinner threads
+  std::mutex mtx;
+
+  std::map<std::string, LayerState> layers;
+  ros::WallDuration keyframe_interval;
+  ros::Publisher pub;
+};
+
+/**
+ * @brief Reassembles the cost layers from mesh_map/VertexCostsDelta messages. A layer is synchronised after a keyframe
+ * and stays synchronised as long as no delta is missed.
+ */
+class VertexCostsReassembler
+{
+public:
+  /**
+   * @brief Applies the delta or keyframe to the state of its layer
+   * @return false if the message could not be applied, e.g. because a previous delta has been missed. The layer stays
+   * unsynchronised until the next keyframe.
+   */
+  bool apply(const mesh_map::VertexCostsDelta& msg);
+
+  /**
+   * @brief Compares a keyframe against the reassembled state of its layer before it is applied
+   * @param msg The keyframe
+   * @param mismatches The number of vertices whose reassembled cost differs from the keyframe
+   * @return false if the layer is not synchronised or the message is no keyframe of the same size
+   */
+  bool validate(const mesh_map::VertexCostsDelta& msg, size_t& mismatches) const;
+
+  /**
+   * @brief Returns true if the layer has been reassembled and no delta has been missed since
+   */
+  bool synchronised(const std::string& name) const;
+
+  /**
+   * @brief Returns the reassembled costs of the layer, null if it is not synchronised
+   */
+  const std::vector<float>* costs(const std::string& name) const;
+
+  /**
+   * @brief Converts the reassembled layer to a mesh_msgs/MeshVertexCostsStamped message
+   * @return false if the layer is not synchronised
+   */
+  bool toVertexCostsStamped(const std::string& name, mesh_msgs::MeshVertexCostsStamped& msg) const;
+
+private:
+  struct LayerState
+  {
+    std::vector<float> costs;
+    uint64_t sequence = 0;
+    bool synchronised = false;
+    std_msgs::Header header;
+    std::string uuid;
+  };
+
+  std::map<std::string, LayerState> layers;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__VERTEX_COSTS_DELTA_H
@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <algorithm>
+#include <mesh_map/background_publisher.h>
+
+namespace mesh_map
+{
+BackgroundPublisher::BackgroundPublisher()
+  : sequence(0)
+  , period(std::chrono::milliseconds(200))
+  , bandwidth(0)
+  , budget_time(Clock::now())
+  , shutdown(false)
+  , publish_thread(&BackgroundPublisher::run, this)
+{
+}
+
+BackgroundPublisher::~BackgroundPublisher()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    shutdown = true;
+  }
+  cv.notify_all();
+  publish_thread.join();
+}
+
+void BackgroundPublisher::setRate(const double rate)
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(rate, 0.01)));
+  }
+  cv.notify_all();
+}
+
+void BackgroundPublisher::setBandwidth(const double bytes_per_second)
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    bandwidth = std::max(bytes_per_second, 0.0);
+    budget_time = std::min(budget_time, Clock::now());
+  }
+  cv.notify_all();
+}
+
+void BackgroundPublisher::publish(const std::string& key, PublishFunction&& publish)
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    Entry& entry = entries[key];
+    // a superseded publication keeps its place in the queue
+    if (!entry.publish)
+      entry.sequence = sequence++;
+    entry.publish = std::move(publish);
+  }
+  cv.notify_all();
+}
+
+void BackgroundPublisher::run()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+  while (!shutdown)
+  {
+    // the pending entry which may be published first is next, entries queued earlier take precedence
+    auto next = entries.end();
+    Clock::time_point ready;
+    for (auto iter = entries.begin(); iter != entries.end(); iter++)
+    {
+      if (!iter->second.publish)
+        continue;
+      const Clock::time_point entry_ready = std::max(iter->second.last_publication + period, budget_time);
+      if (next == entries.end() || entry_ready < ready ||
+          (entry_ready == ready && iter->second.sequence < next->second.sequence))
+      {
+        next = iter;
+        ready = entry_ready;
+      }
+    }
+    if (next == entries.end())
+    {
+      cv.wait(lock);
+      continue;
+    }
+    if (Clock::now() < ready)
+    {
+      cv.wait_until(lock, ready);
+      continue;
+    }
+
+    PublishFunction publish;
+    publish.swap(next->second.publish);
+    next->second.last_publication = Clock::now();
+    lock.unlock();
+
+    const size_t bytes = publish();
+
+    lock.lock();
+    if (bandwidth > 0)
+    {
+      const auto transfer_time =
+          std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(bytes / bandwidth));
+      budget_time = std::max(budget_time, Clock::now()) + transfer_time;
+    }
+  }
+}
+
+}  // namespace mesh_map
@@ -0,0 +1,633 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mesh_map/chunked_mesh_io.h>
+#include <mesh_map/util.h>
+#include <ros/ros.h>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace mesh_map
+{
+const std::string ChunkedMeshIO::CHANNEL_GROUP = "chunks";
+const uint32_t ChunkedMeshIO::FORMAT_VERSION = 1;
+const std::string ChunkedMeshIO::REGION_PREFIX = "region_";
+
+namespace
+{
+//! the attribute groups searched for the channels which are partitioned
+const std::vector<std::string> CHANNEL_GROUPS = { "vertex_attributes", "face_attributes", "channels" };
+
+/**
+ * @brief Returns the prefix of the chunk's channel names
+ */
+std::string chunkPrefix(const uint32_t id)
+{
+  return "c" + std::to_string(id) + "_";
+}
+
+/**
+ * @brief Returns the memory used by the channel's data
+ */
+template <typename T>
+size_t channelBytes(const lvr2::Channel<T>& channel)
+{
+  return channel.numElements() * channel.width() * sizeof(T);
+}
+
+/**
+ * @brief Gathers the values of the given elements of the channel
+ */
+lvr2::FloatChannel gather(const lvr2::FloatChannel& channel, const std::vector<lvr2::Index>& elements)
+{
+  const size_t width = channel.width();
+  lvr2::FloatChannel gathered(elements.size(), width);
+  const float* data = channel.dataPtr().get();
+  for (size_t i = 0; i < elements.size(); i++)
+  {
+    std::copy(data + elements[i] * width, data + (elements[i] + 1) * width, gathered.dataPtr().get() + i * width);
+  }
+  return gathered;
+}
+}  // namespace
+
+ChunkedMeshIO::ChunkedMeshIO(std::shared_ptr<lvr2::AttributeMeshIOBase> io, const size_t memory_budget)
+  : io_ptr(std::move(io)), memory_budget(memory_budget), memory_usage(0), use_counter(0)
+{
+}
+
+bool ChunkedMeshIO::partition(lvr2::AttributeMeshIOBase& io, const float chunk_size, const float halo,
+                              const std::vector<std::string>& channels)
+{
+  if (chunk_size <= 0 || halo < 0)
+  {
+    ROS_ERROR_STREAM("The chunk size has to be positive and the halo must not be negative!");
+    return false;
+  }
+
+  auto vertices_opt = io.getVertices();
+  auto indices_opt = io.getIndices();
+  if (!vertices_opt || !indices_opt || vertices_opt->width() != 3 || indices_opt->width() != 3)
+  {
+    ROS_ERROR_STREAM("Could not read the mesh which should be partitioned!");
+    return false;
+  }
+  const size_t num_vertices = vertices_opt->numElements();
+  const size_t num_faces = indices_opt->numElements();
+  const float* vertices = vertices_opt->dataPtr().get();
+  const lvr2::Index* indices = indices_opt->dataPtr().get();
+
+  // the attribute channels are partitioned like the vertices or like the faces, depending on their number of elements
+  std::vector<std::pair<std::string, lvr2::FloatChannel>> vertex_channels, face_channels;
+  for (const auto& name : channels)
+  {
+    lvr2::FloatChannelOptional channel_opt;
+    for (const auto& group : CHANNEL_GROUPS)
+    {
+      try
+      {
+        if (io.getChannel(group, name, channel_opt) && channel_opt)
+          break;
+      }
+      catch (const std::exception& e)
+      {
+        ROS_DEBUG_STREAM("Could not read the channel \"" << group << "/" << name << "\": " << e.what());
+      }
+      channel_opt.reset();
+    }
+
+    if (!channel_opt)
+      ROS_WARN_STREAM("The channel \"" << name << "\" is not contained in the map, it is not partitioned.");
+    else if (channel_opt->numElements() == num_vertices)
+      vertex_channels.emplace_back(name, *channel_opt);
+    else if (channel_opt->numElements() == num_faces)
+      face_channels.emplace_back(name, *channel_opt);
+    else
+      ROS_WARN_STREAM("The channel \"" << name << "\" is neither a vertex nor a face channel, it is not partitioned.");
+  }
+
+  // each face is added to all cells whose area extended by the halo contains the face's centroid
+  typedef std::pair<int32_t, int32_t> Cell;
+  std::map<Cell, std::vector<lvr2::Index>> cells;
+  for (size_t f = 0; f < num_faces; f++)
+  {
+    float x = 0, y = 0;
+    for (size_t k = 0; k < 3; k++)
+    {
+      x += vertices[3 * indices[3 * f + k]] / 3;
+      y += vertices[3 * indices[3 * f + k] + 1] / 3;
+    }
+    const int32_t min_col = std::floor((x - halo) / chunk_size);
+    const int32_t max_col = std::floor((x + halo) / chunk_size);
+    const int32_t min_row = std::floor((y - halo) / chunk_size);
+    const int32_t max_row = std::floor((y + halo) / chunk_size);
+    for (int32_t col = min_col; col <= max_col; col++)
+    {
+      for (int32_t row = min_row; row <= max_row; row++)
+        cells[Cell(col, row)].push_back(f);
+    }
+  }
+
+  // the previous index is invalidated first, thus a partially written partitioning is never opened
+  lvr2::IndexChannel info(1, 4);
+  std::fill(info.dataPtr().get(), info.dataPtr().get() + 4, 0);
+  if (!io.addChannel(CHANNEL_GROUP, "index_info", info))
+  {
+    ROS_ERROR_STREAM("Could not write the chunk index!");
+    return false;
+  }
+
+  lvr2::FloatChannel chunk_cells(cells.size(), 4);
+  uint32_t id = 0;
+  for (const auto& cell : cells)
+  {
+    const std::vector<lvr2::Index>& faces = cell.second;
+
+    std::unordered_map<lvr2::Index, lvr2::Index> local_indices;
+    std::vector<lvr2::Index> vertex_ids;
+    lvr2::IndexChannel face_ids(faces.size(), 1);
+    lvr2::IndexChannel face_indices(faces.size(), 3);
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+      face_ids.dataPtr()[i] = faces[i];
+      for (size_t k = 0; k < 3; k++)
+      {
+        const lvr2::Index vertex = indices[3 * faces[i] + k];
+        auto inserted = local_indices.emplace(vertex, vertex_ids.size());
+        if (inserted.second)
+          vertex_ids.push_back(vertex);
+        face_indices.dataPtr()[3 * i + k] = inserted.first->second;
+      }
+    }
+
+    lvr2::IndexChannel vertex_id_channel(vertex_ids.size(), 1);
+    std::copy(vertex_ids.begin(), vertex_ids.end(), vertex_id_channel.dataPtr().get());
+
+    const std::string prefix = chunkPrefix(id);
+    bool success = io.addChannel(CHANNEL_GROUP, prefix + "vertex_ids", vertex_id_channel) &&
+                   io.addChannel(CHANNEL_GROUP, prefix + "vertices", gather(*vertices_opt, vertex_ids)) &&
+                   io.addChannel(CHANNEL_GROUP, prefix + "face_ids", face_ids) &&
+                   io.addChannel(CHANNEL_GROUP, prefix + "face_indices", face_indices);
+    for (const auto& channel : vertex_channels)
+    {
+      success = success && io.addChannel(CHANNEL_GROUP, prefix + "v_" + channel.first, gather(channel.second, vertex_ids));
+    }
+    for (const auto& channel : face_channels)
+    {
+      success = success && io.addChannel(CHANNEL_GROUP, prefix + "f_" + channel.first, gather(channel.second, faces));
+    }
+    if (!success)
+    {
+      ROS_ERROR_STREAM("Could not write the chunk " << id << "!");
+      return false;
+    }
+
+    chunk_cells.dataPtr()[4 * id] = cell.first.first * chunk_size;
+    chunk_cells.dataPtr()[4 * id + 1] = cell.first.second * chunk_size;
+    chunk_cells.dataPtr()[4 * id + 2] = (cell.first.first + 1) * chunk_size;
+    chunk_cells.dataPtr()[4 * id + 3] = (cell.first.second + 1) * chunk_size;
+    id++;
+  }
+
+  lvr2::FloatChannel params(1, 2);
+  params.dataPtr()[0] = chunk_size;
+  params.dataPtr()[1] = halo;
+
+  info.dataPtr()[0] = FORMAT_VERSION;
+  info.dataPtr()[1] = cells.size();
+  info.dataPtr()[2] = num_vertices;
+  info.dataPtr()[3] = num_faces;
+  if (!io.addChannel(CHANNEL_GROUP, "index_params", params) || !io.addChannel(CHANNEL_GROUP, "index_cells", chunk_cells) ||
+      !io.addChannel(CHANNEL_GROUP, "index_info", info))
+  {
+    ROS_ERROR_STREAM("Could not write the chunk index!");
+    return false;
+  }
+
+  ROS_INFO_STREAM("Partitioned the mesh with " << num_vertices << " vertices and " << num_faces << " faces into "
+                                               << cells.size() << " chunks.");
+  return true;
+}
+
+bool ChunkedMeshIO::open()
+{
+  lvr2::IndexChannelOptional info_opt;
+  lvr2::FloatChannelOptional cells_opt;
+  try
+  {
+    if (!io_ptr->getChannel(CHANNEL_GROUP, "index_info", info_opt) || !info_opt || info_opt->numElements() != 1 ||
+        info_opt->width() != 4 || info_opt->dataPtr()[0] != FORMAT_VERSION)
+      return false;
+    if (!io_ptr->getChannel(CHANNEL_GROUP, "index_cells", cells_opt) || !cells_opt ||
+        cells_opt->numElements() != info_opt->dataPtr()[1] || cells_opt->width() != 4)
+      return false;
+  }
+  catch (const std::exception& e)
+  {
+    ROS_ERROR_STREAM("Could not read the chunk index: " << e.what());
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  chunk_cells.resize(cells_opt->numElements());
+  for (size_t i = 0; i < chunk_cells.size(); i++)
+  {
+    std::copy(cells_opt->dataPtr().get() + 4 * i, cells_opt->dataPtr().get() + 4 * (i + 1), chunk_cells[i].begin());
+  }
+  ROS_INFO_STREAM("The map has been partitioned into " << chunk_cells.size() << " chunks, it consists of "
+                                                       << info_opt->dataPtr()[2] << " vertices and "
+                                                       << info_opt->dataPtr()[3] << " faces.");
+  return true;
+}
+
+size_t ChunkedMeshIO::numChunks()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return chunk_cells.size();
+}
+
+std::vector<uint32_t> ChunkedMeshIO::chunksInBox(const float min_x, const float min_y, const float max_x,
+                                                 const float max_y)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return chunksInBoxLocked(min_x, min_y, max_x, max_y);
+}
+
+std::vector<uint32_t> ChunkedMeshIO::chunksInBoxLocked(const float min_x, const float min_y, const float max_x,
+                                                       const float max_y)
+{
+  std::vector<uint32_t> chunks;
+  for (uint32_t id = 0; id < chunk_cells.size(); id++)
+  {
+    const auto& cell = chunk_cells[id];
+    if (cell[0] <= max_x && cell[2] >= min_x && cell[1] <= max_y && cell[3] >= min_y)
+      chunks.push_back(id);
+  }
+  return chunks;
+}
+
+bool ChunkedMeshIO::setRegion(const float min_x, const float min_y, const float max_x, const float max_y)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  std::unique_ptr<Stitching> stitching(new Stitching());
+  const bool success = stitch(chunksInBoxLocked(min_x, min_y, max_x, max_y), *stitching);
+  ROS_INFO_STREAM("Stitched the region of " << stitching->chunks.size() << " chunks with "
+                                            << stitching->mesh.vertex_ids.size() << " vertices and "
+                                            << stitching->mesh.face_ids.size() << " faces.");
+
+  // the added geometry belongs to the previous region
+  region = std::move(stitching);
+  added_vertices.reset();
+  added_indices.reset();
+  evict();
+  return success;
+}
+
+size_t ChunkedMeshIO::memoryUsage()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return memory_usage;
+}
+
+ChunkedMeshIO::Chunk& ChunkedMeshIO::loadChunk(const uint32_t id)
+{
+  auto iter = loaded_chunks.find(id);
+  if (iter == loaded_chunks.end())
+  {
+    iter = loaded_chunks.emplace(id, Chunk()).first;
+    Chunk& chunk = iter->second;
+    const std::string prefix = chunkPrefix(id);
+    try
+    {
+      chunk.failed = !io_ptr->getChannel(CHANNEL_GROUP, prefix + "vertex_ids", chunk.vertex_ids) ||
+                     !io_ptr->getChannel(CHANNEL_GROUP, prefix + "vertices", chunk.vertices) ||
+                     !io_ptr->getChannel(CHANNEL_GROUP, prefix + "face_ids", chunk.face_ids) ||
+                     !io_ptr->getChannel(CHANNEL_GROUP, prefix + "face_indices", chunk.indices);
+    }
+    catch (const std::exception& e)
+    {
+      ROS_ERROR_STREAM("Could not read the chunk " << id << ": " << e.what());
+      chunk.failed = true;
+    }
+
+    chunk.failed = chunk.failed || !chunk.vertex_ids || !chunk.vertices || !chunk.face_ids || !chunk.indices ||
+                   chunk.vertices->numElements() != chunk.vertex_ids->numElements() ||
+                   chunk.indices->numElements() != chunk.face_ids->numElements() || chunk.vertices->width() != 3 ||
+                   chunk.indices->width() != 3;
+    if (chunk.failed)
+    {
+      ROS_ERROR_STREAM("Could not load the chunk " << id << "!");
+    }
+    else
+    {
+      chunk.bytes = channelBytes(*chunk.vertex_ids) + channelBytes(*chunk.vertices) + channelBytes(*chunk.face_ids) +
+                    channelBytes(*chunk.indices);
+      memory_usage += chunk.bytes;
+    }
+  }
+  iter->second.last_use = ++use_counter;
+  return iter->second;
+}
+
+const lvr2::FloatChannel* ChunkedMeshIO::loadChunkChannel(const uint32_t id, const std::string& name, bool& per_vertex)
+{
+  Chunk& chunk = loadChunk(id);
+  if (chunk.failed)
+    return nullptr;
+
+  for (const bool vertex_channel : { true, false })
+  {
+    auto iter = chunk.channels.find((vertex_channel ? "v_" : "f_") + name);
+    if (iter != chunk.channels.end())
+    {
+      per_vertex = vertex_channel;
+      return &iter->second;
+    }
+  }
+  if (std::find(chunk.missing.begin(), chunk.missing.end(), name) != chunk.missing.end())
+    return nullptr;
+
+  for (const bool vertex_channel : { true, false })
+  {
+    const std::string channel_name = (vertex_channel ? "v_" : "f_") + name;
+    const size_t num_elements =
+        vertex_channel ? chunk.vertex_ids->numElements() : chunk.face_ids->numElements();
+    lvr2::FloatChannelOptional channel_opt;
+    try
+    {
+      if (!io_ptr->getChannel(CHANNEL_GROUP, chunkPrefix(id) + channel_name, channel_opt) || !channel_opt ||
+          channel_opt->numElements() != num_elements)
+        continue;
+    }
+    catch (const std::exception& e)
+    {
+      continue;
+    }
+    per_vertex = vertex_channel;
+    chunk.bytes += channelBytes(*channel_opt);
+    memory_usage += channelBytes(*channel_opt);
+    return &chunk.channels.emplace(channel_name, *channel_opt).first->second;
+  }
+  chunk.missing.push_back(name);
+  return nullptr;
+}
+
+bool ChunkedMeshIO::stitch(const std::vector<uint32_t>& chunks, Stitching& stitching)
+{
+  stitching.chunks = chunks;
+  stitching.vertex_maps.assign(chunks.size(), {});
+  stitching.face_maps.assign(chunks.size(), {});
+  StitchedMesh& mesh = stitching.mesh;
+
+  // vertices and faces are contained in several chunks due to the halo, they are merged by their global ids
+  std::unordered_map<lvr2::Index, lvr2::Index> vertex_lookup, face_lookup;
+  std::vector<float> vertices;
+  std::vector<lvr2::Index> indices;
+  for (size_t c = 0; c < chunks.size(); c++)
+  {
+    const Chunk& chunk = loadChunk(chunks[c]);
+    if (chunk.failed)
+      continue;
+
+    const lvr2::Index* vertex_ids = chunk.vertex_ids->dataPtr().get();
+    const float* chunk_vertices = chunk.vertices->dataPtr().get();
+    auto& vertex_map = stitching.vertex_maps[c];
+    vertex_map.resize(chunk.vertex_ids->numElements());
+    for (size_t i = 0; i < vertex_map.size(); i++)
+    {
+      auto inserted = vertex_lookup.emplace(vertex_ids[i], mesh.vertex_ids.size());
+      if (inserted.second)
+      {
+        mesh.vertex_ids.push_back(vertex_ids[i]);
+        vertices.insert(vertices.end(), chunk_vertices + 3 * i, chunk_vertices + 3 * (i + 1));
+      }
+      vertex_map[i] = inserted.first->second;
+    }
+
+    const lvr2::Index* face_ids = chunk.face_ids->dataPtr().get();
+    const lvr2::Index* chunk_indices = chunk.indices->dataPtr().get();
+    auto& face_map = stitching.face_maps[c];
+    face_map.resize(chunk.face_ids->numElements());
+    for (size_t i = 0; i < face_map.size(); i++)
+    {
+      auto inserted = face_lookup.emplace(face_ids[i], mesh.face_ids.size());
+      if (inserted.second)
+      {
+        mesh.face_ids.push_back(face_ids[i]);
+        for (size_t k = 0; k < 3; k++)
+          indices.push_back(vertex_map[chunk_indices[3 * i + k]]);
+      }
+      face_map[i] = inserted.first->second;
+    }
+  }
+
+  // the stored channels of the region are keyed by its fingerprint, edge channels are checked against the edge count
+  Fingerprint fingerprint;
+  fingerprint.mix(static_cast<uint32_t>(mesh.vertex_ids.size())).mix(static_cast<uint32_t>(mesh.face_ids.size()));
+  for (size_t i = 0; i < mesh.vertex_ids.size(); i++)
+    fingerprint.mix(mesh.vertex_ids[i]).mix(vertices[3 * i]).mix(vertices[3 * i + 1]).mix(vertices[3 * i + 2]);
+  for (const lvr2::Index face_id : mesh.face_ids)
+    fingerprint.mix(face_id);
+  stitching.fingerprint = fingerprint.value();
+
+  std::unordered_set<uint64_t> edges;
+  edges.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i += 3)
+  {
+    for (size_t k = 0; k < 3; k++)
+    {
+      const uint64_t a = indices[i + k];
+      const uint64_t b = indices[i + (k + 1) % 3];
+      edges.insert(a < b ? (a << 32) | b : (b << 32) | a);
+    }
+  }
+  stitching.num_edges = edges.size();
+
+  mesh.vertices = lvr2::FloatChannel(mesh.vertex_ids.size(), 3);
+  std::copy(vertices.begin(), vertices.end(), mesh.vertices->dataPtr().get());
+  mesh.indices = lvr2::IndexChannel(mesh.face_ids.size(), 3);
+  std::copy(indices.begin(), indices.end(), mesh.indices->dataPtr().get());
+  mesh.channels.clear();
+  return !mesh.face_ids.empty();
+}
+
+bool ChunkedMeshIO::stitchChannel(Stitching& stitching, const std::string& name)
+{
+  if (stitching.mesh.channels.find(name) != stitching.mesh.channels.end())
+    return true;
+
+  lvr2::FloatChannelOptional stitched;
+  bool stitched_per_vertex = false;
+  for (size_t c = 0; c < stitching.chunks.size(); c++)
+  {
+    bool per_vertex;
+    const lvr2::FloatChannel* channel = loadChunkChannel(stitching.chunks[c], name, per_vertex);
+    if (!channel)
+      continue;
+
+    if (!stitched)
+    {
+      // the elements of chunks which do not contain the channel remain NaN
+      const size_t num_elements = per_vertex ? stitching.mesh.vertex_ids.size() : stitching.mesh.face_ids.size();
+      stitched = lvr2::FloatChannel(num_elements, channel->width());
+      std::fill(stitched->dataPtr().get(), stitched->dataPtr().get() + num_elements * channel->width(),
+                std::numeric_limits<float>::quiet_NaN());
+      stitched_per_vertex = per_vertex;
+    }
+    else if (per_vertex != stitched_per_vertex || channel->width() != stitched->width())
+    {
+      continue;
+    }
+
+    const size_t width = channel->width();
+    const auto& element_map = per_vertex ? stitching.vertex_maps[c] : stitching.face_maps[c];
+    const float* data = channel->dataPtr().get();
+    for (size_t i = 0; i < element_map.size(); i++)
+    {
+      std::copy(data + i * width, data + (i + 1) * width, stitched->dataPtr().get() + element_map[i] * width);
+    }
+  }
+
+  if (!stitched)
+    return false;
+  stitching.mesh.channels.emplace(name, *stitched);
+  return true;
+}
+
+void ChunkedMeshIO::evict()
+{
+  while (memory_usage > memory_budget && !loaded_chunks.empty())
+  {
+    auto lru = std::min_element(loaded_chunks.begin(), loaded_chunks.end(), [](const auto& a, const auto& b) {
+      return a.second.last_use < b.second.last_use;
+    });
+    memory_usage -= lru->second.bytes;
+    loaded_chunks.erase(lru);
+  }
+}
+
+lvr2::FloatChannelOptional ChunkedMeshIO::getVertices()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  if (added_vertices || !region)
+    return added_vertices;
+  return region->mesh.vertices;
+}
+
+lvr2::IndexChannelOptional ChunkedMeshIO::getIndices()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  if (added_indices || !region)
+    return added_indices;
+  return region->mesh.indices;
+}
+
+bool ChunkedMeshIO::addVertices(const lvr2::FloatChannel& channel_ptr)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  added_vertices = channel_ptr;
+  return true;
+}
+
+bool ChunkedMeshIO::addIndices(const lvr2::IndexChannel& channel_ptr)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  added_indices = channel_ptr;
+  return true;
+}
+
+std::string ChunkedMeshIO::regionGroup(const std::string& group) const
+{
+  return REGION_PREFIX + std::to_string(region->fingerprint) + "_" + group;
+}
+
+bool ChunkedMeshIO::getChannel(const std::string group, const std::string name, lvr2::FloatChannelOptional& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!region)
+    return false;
+
+  // the channels added for the region take precedence, they are vertex, face or edge attributes
+  lvr2::FloatChannelOptional stored;
+  if (io_ptr->getChannel(regionGroup(group), name, stored) && stored &&
+      (stored->numElements() == region->mesh.vertex_ids.size() ||
+       stored->numElements() == region->mesh.face_ids.size() || stored->numElements() == region->num_edges))
+  {
+    channel = stored;
+    return true;
+  }
+  if (!stitchChannel(*region, name))
+    return false;
+  channel = region->mesh.channels.at(name);
+  evict();
+  return true;
+}
+
+bool ChunkedMeshIO::getChannel(const std::string group, const std::string name, lvr2::IndexChannelOptional& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return region && io_ptr->getChannel(regionGroup(group), name, channel);
+}
+
+bool ChunkedMeshIO::getChannel(const std::string group, const std::string name, lvr2::UCharChannelOptional& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return region && io_ptr->getChannel(regionGroup(group), name, channel);
+}
+
+bool ChunkedMeshIO::addChannel(const std::string group, const std::string name, const lvr2::FloatChannel& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return region && io_ptr->addChannel(regionGroup(group), name, channel);
+}
+
+bool ChunkedMeshIO::addChannel(const std::string group, const std::string name, const lvr2::IndexChannel& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return region && io_ptr->addChannel(regionGroup(group), name, channel);
+}
+
+bool ChunkedMeshIO::addChannel(const std::string group, const std::string name, const lvr2::UCharChannel& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return region && io_ptr->addChannel(regionGroup(group), name, channel);
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <algorithm>
+#include <mesh_map/debug_marker_publisher.h>
+#include <visualization_msgs/MarkerArray.h>
+
+namespace mesh_map
+{
+DebugMarkerPublisher::DebugMarkerPublisher(ros::NodeHandle& nh, const std::string& topic)
+  : marker_array_pub(nh.advertise<visualization_msgs::MarkerArray>(topic, 1, true))
+  , period(100)
+  , is_enabled(false)
+  , shutdown(false)
+  , publish_thread(&DebugMarkerPublisher::run, this)
+{
+}
+
+DebugMarkerPublisher::~DebugMarkerPublisher()
+{
+  {
+    std::lock_guard<std::mutex> lock(pending_mtx);
+    shutdown = true;
+  }
+  shutdown_cv.notify_all();
+  publish_thread.join();
+}
+
+void DebugMarkerPublisher::setEnabled(const bool enabled)
+{
+  is_enabled = enabled;
+  if (!enabled)
+  {
+    std::lock_guard<std::mutex> lock(pending_mtx);
+    pending.clear();
+  }
+}
+
+void DebugMarkerPublisher::setRate(const double rate)
+{
+  std::lock_guard<std::mutex> lock(pending_mtx);
+  period = std::chrono::milliseconds(static_cast<int64_t>(1000.0 / std::max(rate, 0.1)));
+}
+
+void DebugMarkerPublisher::add(visualization_msgs::Marker&& marker)
+{
+  if (!is_enabled)
+    return;
+
+  std::lock_guard<std::mutex> lock(pending_mtx);
+  const auto key = std::make_pair(marker.ns, marker.id);
+  pending[key] = std::move(marker);
+}
+
+void DebugMarkerPublisher::run()
+{
+  std::unique_lock<std::mutex> lock(pending_mtx);
+  while (!shutdown)
+  {
+    shutdown_cv.wait_for(lock, period, [this]() { return shutdown; });
+    if (shutdown || pending.empty())
+      continue;
+
+    // take the pending markers and serialise them without blocking the callers
+    std::map<std::pair<std::string, int32_t>, visualization_msgs::Marker> markers;
+    markers.swap(pending);
+    lock.unlock();
+
+    visualization_msgs::MarkerArray marker_array;
+    marker_array.markers.reserve(markers.size());
+    for (auto& marker : markers)
+    {
+      marker_array.markers.push_back(std::move(marker.second));
+    }
+    marker_array_pub.publish(marker_array);
+
+    lock.lock();
+  }
+}
+
+}  // namespace mesh_map
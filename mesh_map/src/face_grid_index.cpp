@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/face_grid_index.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <ros/ros.h>
+
+namespace mesh_map
+{
+//! upper bound for the number of grid cells, the cell size is enlarged beyond
+constexpr size_t kMaxGridCells = 1 << 26;
+
+FaceGridIndex::FaceGridIndex(const lvr2::HalfEdgeMesh<Vector>& mesh, const float cell_size)
+  : mesh(mesh), cell_size(cell_size), min_x(0), min_y(0), num_x(1), num_y(1)
+{
+  float max_x = -std::numeric_limits<float>::infinity();
+  float max_y = -std::numeric_limits<float>::infinity();
+  min_x = min_y = std::numeric_limits<float>::infinity();
+  for (auto vH : mesh.vertices())
+  {
+    const auto& position = mesh.getVertexPosition(vH);
+    min_x = std::min(min_x, position.x);
+    min_y = std::min(min_y, position.y);
+    max_x = std::max(max_x, position.x);
+    max_y = std::max(max_y, position.y);
+  }
+  if (!(min_x <= max_x && min_y <= max_y))
+    min_x = min_y = max_x = max_y = 0;
+
+  while (true)
+  {
+    num_x = static_cast<size_t>(std::floor((max_x - min_x) / this->cell_size)) + 1;
+    num_y = static_cast<size_t>(std::floor((max_y - min_y) / this->cell_size)) + 1;
+    if (num_x * num_y <= kMaxGridCells)
+      break;
+    this->cell_size *= 2;
+  }
+  if (this->cell_size != cell_size)
+    ROS_WARN_STREAM("Enlarged the face grid cells from " << cell_size << "m to " << this->cell_size << "m.");
+
+  // each triangle is inserted into all cells overlapped by its bounding box
+  const long num_faces = mesh.nextFaceIndex();
+  face_z.assign(num_faces, { std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() });
+  std::vector<std::array<size_t, 4>> face_cells(num_faces, { 1, 1, 0, 0 });
+  std::vector<size_t> cell_counts(num_x * num_y + 1, 0);
+
+#pragma omp parallel for schedule(static)
+  for (long i = 0; i < num_faces; i++)
+  {
+    const lvr2::FaceHandle fH(i);
+    if (!mesh.containsFace(fH))
+      continue;
+
+    const auto& vertices = mesh.getVertexPositionsOfFace(fH);
+    float face_min_x = vertices[0].x, face_min_y = vertices[0].y, face_max_x = vertices[0].x,
+          face_max_y = vertices[0].y;
+    face_z[i] = { vertices[0].z, vertices[0].z };
+    for (size_t j = 1; j < 3; j++)
+    {
+      face_min_x = std::min(face_min_x, vertices[j].x);
+      face_min_y = std::min(face_min_y, vertices[j].y);
+      face_max_x = std::max(face_max_x, vertices[j].x);
+      face_max_y = std::max(face_max_y, vertices[j].y);
+      face_z[i][0] = std::min(face_z[i][0], vertices[j].z);
+      face_z[i][1] = std::max(face_z[i][1], vertices[j].z);
+    }
+
+    auto& cells = face_cells[i];
+    cells[0] = static_cast<size_t>((face_min_x - min_x) / this->cell_size);
+    cells[1] = static_cast<size_t>((face_min_y - min_y) / this->cell_size);
+    cells[2] = std::min(num_x - 1, static_cast<size_t>((face_max_x - min_x) / this->cell_size));
+    cells[3] = std::min(num_y - 1, static_cast<size_t>((face_max_y - min_y) / this->cell_size));
+    for (size_t cy = cells[1]; cy <= cells[3]; cy++)
+    {
+      for (size_t cx = cells[0]; cx <= cells[2]; cx++)
+      {
+#pragma omp atomic
+        cell_counts[cy * num_x + cx + 1]++;
+      }
+    }
+  }
+
+  cell_offsets.resize(cell_counts.size());
+  std::partial_sum(cell_counts.begin(), cell_counts.end(), cell_offsets.begin());
+  cell_faces.resize(cell_offsets.back());
+
+  // the counts are reused as insertion cursors
+  std::copy(cell_offsets.begin(), cell_offsets.end() - 1, cell_counts.begin());
+#pragma omp parallel for schedule(static)
+  for (long i = 0; i < num_faces; i++)
+  {
+    const auto& cells = face_cells[i];
+    for (size_t cy = cells[1]; cy <= cells[3]; cy++)
+    {
+      for (size_t cx = cells[0]; cx <= cells[2]; cx++)
+      {
+        size_t slot;
+#pragma omp atomic capture
+        slot = cell_counts[cy * num_x + cx]++;
+        cell_faces[slot] = i;
+      }
+    }
+  }
+
+  // the insertion order depends on the scheduling, sorting keeps the lookups deterministic
+#pragma omp parallel for schedule(dynamic, 1024)
+  for (long c = 0; c < static_cast<long>(num_x * num_y); c++)
+  {
+    std::sort(cell_faces.begin() + cell_offsets[c], cell_faces.begin() + cell_offsets[c + 1]);
+  }
+
+  ROS_INFO_STREAM("Built the face grid with " << num_x << "x" << num_y << " cells of " << this->cell_size << "m and "
+                                              << cell_faces.size() << " entries, using "
+                                              << memoryUsage() / (1024 * 1024) << "MB.");
+}
+
+boost::optional<std::tuple<lvr2::FaceHandle, std::array<float, 3>>>
+FaceGridIndex::locate(const float x, const float y, const float z_hint, const float max_dist) const
+{
+  const float gx = (x - min_x) / cell_size;
+  const float gy = (y - min_y) / cell_size;
+  if (!(gx >= 0 && gy >= 0 && gx < static_cast<float>(num_x) && gy < static_cast<float>(num_y)))
+    return boost::none;
+
+  const size_t cell = static_cast<size_t>(gy) * num_x + static_cast<size_t>(gx);
+  const float EPSILON = 1e-5;
+
+  boost::optional<std::tuple<lvr2::FaceHandle, std::array<float, 3>>> result;
+  float min_dist = max_dist;
+  for (size_t k = cell_offsets[cell]; k < cell_offsets[cell + 1]; k++)
+  {
+    const uint32_t face = cell_faces[k];
+    if (z_hint < face_z[face][0] - min_dist || z_hint > face_z[face][1] + min_dist)
+      continue;
+
+    // barycentric coordinates of the position in the xy projection of the triangle
+    const lvr2::FaceHandle fH(face);
+    const auto& v = mesh.getVertexPositionsOfFace(fH);
+    const float det = (v[1].y - v[2].y) * (v[0].x - v[2].x) + (v[2].x - v[1].x) * (v[0].y - v[2].y);
+    if (std::fabs(det) < std::numeric_limits<float>::epsilon())
+      continue;  // vertical triangle
+
+    const float alpha = ((v[1].y - v[2].y) * (x - v[2].x) + (v[2].x - v[1].x) * (y - v[2].y)) / det;
+    const float beta = ((v[2].y - v[0].y) * (x - v[2].x) + (v[0].x - v[2].x) * (y - v[2].y)) / det;
+    const float gamma = 1 - alpha - beta;
+    if (alpha < -EPSILON || beta < -EPSILON || gamma < -EPSILON)
+      continue;
+
+    const float dist = std::fabs(alpha * v[0].z + beta * v[1].z + gamma * v[2].z - z_hint);
+    if (dist <= min_dist)
+    {
+      min_dist = dist;
+      result = std::make_tuple(fH, std::array<float, 3>{ alpha, beta, gamma });
+    }
+  }
+  return result;
+}
+
+size_t FaceGridIndex::memoryUsage() const
+{
+  return cell_offsets.size() * sizeof(size_t) + cell_faces.size() * sizeof(uint32_t) +
+         face_z.size() * sizeof(std::array<float, 2>);
+}
+
+} /* namespace mesh_map */
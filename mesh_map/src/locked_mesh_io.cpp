@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/locked_mesh_io.h>
+
+namespace mesh_map
+{
+LockedMeshIO::LockedMeshIO(std::shared_ptr<lvr2::AttributeMeshIOBase> io) : io_ptr(std::move(io))
+{
+}
+
+lvr2::FloatChannelOptional LockedMeshIO::getVertices()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->getVertices();
+}
+
+lvr2::IndexChannelOptional LockedMeshIO::getIndices()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->getIndices();
+}
+
+bool LockedMeshIO::addVertices(const lvr2::FloatChannel& channel_ptr)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->addVertices(channel_ptr);
+}
+
+bool LockedMeshIO::addIndices(const lvr2::IndexChannel& channel_ptr)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->addIndices(channel_ptr);
+}
+
+bool LockedMeshIO::getChannel(const std::string group, const std::string name, lvr2::FloatChannelOptional& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->getChannel(group, name, channel);
+}
+
+bool LockedMeshIO::getChannel(const std::string group, const std::string name, lvr2::IndexChannelOptional& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->getChannel(group, name, channel);
+}
+
+bool LockedMeshIO::getChannel(const std::string group, const std::string name, lvr2::UCharChannelOptional& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->getChannel(group, name, channel);
+}
+
+bool LockedMeshIO::addChannel(const std::string group, const std::string name, const lvr2::FloatChannel& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->addChannel(group, name, channel);
+}
+
+bool LockedMeshIO::addChannel(const std::string group, const std::string name, const lvr2::IndexChannel& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->addChannel(group, name, channel);
+}
+
+bool LockedMeshIO::addChannel(const std::string group, const std::string name, const lvr2::UCharChannel& channel)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return io_ptr->addChannel(group, name, channel);
+}
+
+} /* namespace mesh_map */
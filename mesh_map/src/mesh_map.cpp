@@ -37,9 +37,12 @@
 #include <XmlRpcException.h>
 #include <algorithm>
 #include <boost/uuid/random_generator.hpp>
+#include <chrono>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <functional>
+#include <future>
+#include <iterator>
 #include <geometry_msgs/PointStamped.h>
 #include <geometry_msgs/Vector3.h>
 #include <visualization_msgs/MarkerArray.h>
@@ -49,12 +52,14 @@
 #include <lvr2/algorithm/GeometryAlgorithms.hpp>
 #include <lvr2/algorithm/NormalAlgorithms.hpp>
 #include <lvr2/io/hdf5/MeshIO.hpp>
+#include <mesh_map/locked_mesh_io.h>
 #include <mesh_map/mesh_map.h>
 #include <mesh_map/util.h>
 #include <mesh_msgs/MeshGeometryStamped.h>
 #include <mesh_msgs_conversions/conversions.h>
 #include <mutex>
 #include <ros/ros.h>
+#include <unordered_map>
 #include <visualization_msgs/Marker.h>
 
 namespace mesh_map
@@ -63,17 +68,28 @@ using HDF5MeshIO = lvr2::Hdf5IO<lvr2::hdf5features::ArrayIO, lvr2::hdf5features:
                                 lvr2::hdf5features::VariantChannelIO, lvr2::hdf5features::MeshIO>;
 
 MeshMap::MeshMap(tf2_ros::Buffer& tf_listener)
-  : tf_buffer(tf_buffer)
+  : tf_buffer(tf_listener)
   , private_nh("~/mesh_map/")
   , first_config(true)
   , map_loaded(false)
   , layer_loader("mesh_map", "mesh_map::AbstractLayer")
   , mesh_ptr(new lvr2::HalfEdgeMesh<Vector>())
+  , cost_version(0)
+  , mesh_fingerprint(0)
+  , publish_cost_deltas(false)
+  , persist_layers(true)
+  , vector_field_density(0)
+  , vector_field_radius(0)
 {
   private_nh.param<std::string>("server_url", srv_url, "");
   private_nh.param<std::string>("server_username", srv_username, "");
   private_nh.param<std::string>("server_password", srv_password, "");
   private_nh.param<std::string>("mesh_layer", mesh_layer, "mesh0");
+  private_nh.param<std::string>("server_cache_directory", srv_cache_directory, "");
+  private_nh.param<bool>("server_compact_encoding", srv_compact_encoding, false);
+  private_nh.param<bool>("chunked_map", chunked_map, false);
+  private_nh.param<int>("chunk_memory_budget", chunk_memory_budget, 1024);
+  private_nh.param<float>("face_grid_cell_size", face_grid_cell_size, 0);
   private_nh.param<float>("min_roughness", min_roughness, 0);
   private_nh.param<float>("max_roughness", max_roughness, 0);
   private_nh.param<float>("min_height_diff", min_height_diff, 0);
@@ -88,11 +104,16 @@ MeshMap::MeshMap(tf2_ros::Buffer& tf_listener)
   private_nh.param<std::string>("mesh_file", mesh_file, "");
   private_nh.param<std::string>("mesh_part", mesh_part, "");
   private_nh.param<std::string>("global_frame", global_frame, "map");
+  // the robot frame of the navigation server
+  ros::NodeHandle("~").param<std::string>("robot_frame", robot_frame, "base_link");
   ROS_INFO_STREAM("mesh file is set to: " << mesh_file);
 
-  marker_pub = private_nh.advertise<visualization_msgs::Marker>("marker", 100, true);
+  debug_marker_pub.reset(new DebugMarkerPublisher(private_nh, "debug_markers"));
   mesh_geometry_pub = private_nh.advertise<mesh_msgs::MeshGeometryStamped>("mesh", 1, true);
   vertex_costs_pub = private_nh.advertise<mesh_msgs::MeshVertexCostsStamped>("vertex_costs", 1, false);
+  vertex_costs_delta_pub.reset(new VertexCostsDeltaPublisher(private_nh, "vertex_costs_delta"));
+  layer_writer.reset(new BackgroundPublisher());
+  background_pub.reset(new BackgroundPublisher());
   vertex_colors_pub = private_nh.advertise<mesh_msgs::MeshVertexColorsStamped>("vertex_colors", 1, true);
   vector_field_pub = private_nh.advertise<visualization_msgs::Marker>("vector_field", 1, true);
   reconfigure_server_ptr = boost::shared_ptr<dynamic_reconfigure::Server<mesh_map::MeshMapConfig>>(
@@ -118,6 +139,11 @@ bool MeshMap::readMap()
     mesh_client_ptr->setBoundingBox(bb_min_x, bb_min_y, bb_min_z, bb_max_x, bb_max_y, bb_max_z);
     mesh_client_ptr->addFilter("roughness", min_roughness, max_roughness);
     mesh_client_ptr->addFilter("height_diff", min_height_diff, max_height_diff);
+    mesh_client_ptr->setCacheDirectory(srv_cache_directory);
+    mesh_client_ptr->setCompactEncoding(srv_compact_encoding);
+
+    // request the mesh geometry and normals concurrently, they are consumed below while reading the map
+    mesh_client_ptr->prefetchChannels({ "vertices", "face_indices", "face_normals", "vertex_normals" });
   }
   else if (!mesh_file.empty() && !mesh_part.empty())
   {
@@ -126,6 +152,23 @@ bool MeshMap::readMap()
     hdf_5_mesh_io->open(mesh_file);
     hdf_5_mesh_io->setMeshName(mesh_part);
     mesh_io_ptr = std::shared_ptr<lvr2::AttributeMeshIOBase>(hdf_5_mesh_io);
+
+    if (chunked_map)
+    {
+      // only the chunks of the bounding box are loaded, the computed layers are stored apart for the region
+      chunked_io_ptr = std::make_shared<ChunkedMeshIO>(mesh_io_ptr, static_cast<size_t>(chunk_memory_budget) << 20);
+      if (!chunked_io_ptr->open())
+      {
+        ROS_ERROR_STREAM("The map file \"" << mesh_file << "\" has not been partitioned, use mesh_map_partition!");
+        return false;
+      }
+      if (!chunked_io_ptr->setRegion(bb_min_x, bb_min_y, bb_max_x, bb_max_y))
+      {
+        ROS_ERROR_STREAM("The bounding box of the chunked map does not contain any faces!");
+        return false;
+      }
+      mesh_io_ptr = chunked_io_ptr;
+    }
   }
   else
   {
@@ -133,6 +176,9 @@ bool MeshMap::readMap()
     return false;
   }
 
+  // the layer plugins are initialised concurrently and share the mesh io
+  mesh_io_ptr = std::make_shared<LockedMeshIO>(mesh_io_ptr);
+
   if (server)
   {
     ROS_INFO_STREAM("Start reading the mesh from the server '" << srv_url);
@@ -155,6 +201,23 @@ bool MeshMap::readMap()
     kd_tree_ptr = std::make_unique<KDTree>(3,*adaptor_ptr, nanoflann::KDTreeSingleIndexAdaptorParams(10));
     kd_tree_ptr->buildIndex();
     ROS_INFO_STREAM("The k-d tree has been build successfully!");
+
+    if (face_grid_cell_size > 0)
+      face_grid_ptr = std::make_unique<FaceGridIndex>(*mesh_ptr, face_grid_cell_size);
+
+    Fingerprint fingerprint;
+    fingerprint.mix(static_cast<uint32_t>(mesh_ptr->nextVertexIndex()));
+    for (auto vH : mesh_ptr->vertices())
+    {
+      const auto& position = mesh_ptr->getVertexPosition(vH);
+      fingerprint.mix(vH.idx()).mix(position.x).mix(position.y).mix(position.z);
+    }
+    for (auto fH : mesh_ptr->faces())
+    {
+      for (auto vH : mesh_ptr->getVerticesOfFace(fH))
+        fingerprint.mix(vH.idx());
+    }
+    mesh_fingerprint = fingerprint.value();
   }
   else
   {
@@ -214,7 +277,36 @@ bool MeshMap::readMap()
     }
   }
 
-  mesh_geometry_pub.publish(mesh_msgs_conversions::toMeshGeometryStamped<float>(*mesh_ptr, global_frame, uuid_str, vertex_normals));
+  // the geometry and the normals are not changed after loading the map
+  background_pub->publish<mesh_msgs::MeshGeometryStamped>("mesh", mesh_geometry_pub, [this]() {
+    return mesh_msgs_conversions::toMeshGeometryStamped<float>(*mesh_ptr, global_frame, uuid_str, vertex_normals);
+  });
+
+  ROS_INFO_STREAM("Computing face neighbours...");
+  face_neighbours = lvr2::DenseFaceMap<std::array<lvr2::OptionalFaceHandle, 3>>(
+      mesh_ptr->nextFaceIndex(), std::array<lvr2::OptionalFaceHandle, 3>());
+  for (auto fH : mesh_ptr->faces())
+  {
+    const auto vertices = mesh_ptr->getVerticesOfFace(fH);
+    for (size_t k = 0; k < 3; k++)
+    {
+      try
+      {
+        const auto eH = mesh_ptr->getEdgeBetween(vertices[(k + 1) % 3], vertices[(k + 2) % 3]);
+        if (!eH)
+          continue;
+        for (const auto& neighbour : mesh_ptr->getFacesOfEdge(eH.unwrap()))
+        {
+          if (neighbour && neighbour.unwrap() != fH)
+            face_neighbours[fH][k] = neighbour;
+        }
+      }
+      catch (lvr2::PanicException exception)
+      {
+        // leave the neighbour invalid, i.e. handle it like a border edge
+      }
+    }
+  }
 
   ROS_INFO_STREAM("Try to read edge distances from map file...");
   auto edge_distances_opt = mesh_io_ptr->getAttributeMap<lvr2::DenseEdgeMap<float>>("edge_distances");
@@ -309,6 +401,7 @@ bool MeshMap::loadLayerPlugins()
 
         layers.push_back(elem);
         layer_names.insert(elem);
+        layer_types[name] = type;
 
         ROS_INFO_STREAM("The layer plugin with the type \""
                         << type << "\" has been loaded successfully under the name \"" << name << "\".");
@@ -335,7 +428,130 @@ bool MeshMap::loadLayerPlugins()
 void MeshMap::layerChanged(const std::string& layer_name)
 {
   std::lock_guard<std::mutex> lock(layer_mtx);
+  updateLayers(layer_name, true);
+}
+
+void MeshMap::layerChanged(const std::string& layer_name, const std::set<lvr2::VertexHandle>& changed_vertices)
+{
+  // the initial combination of the costs includes all changes which happened before
+  if (!map_loaded || changed_vertices.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock(layer_mtx);
+
+  auto layer_iter = std::find_if(layers.begin(), layers.end(),
+                                 [&layer_name](const auto& layer) { return layer.first == layer_name; });
+  if (layer_iter == layers.end())
+    return;
+
+  // the following layers which depend on the lethals are updated with the lethal changes around the changed vertices
+  // and report the vertices whose costs they have changed in turn
+  std::set<lvr2::VertexHandle> changed(changed_vertices);
+  std::vector<size_t> updated_layers;
+  for (size_t i = layer_iter - layers.begin() + 1; i < layers.size(); i++)
+  {
+    const auto& layer = layers[i].second;
+    if (!layer->dependsOnUpstreamLethals())
+      continue;
+
+    const std::set<lvr2::VertexHandle> changed_lethals = lethalVertices(changed, i);
+    auto& layer_upstream = upstream_lethals[i];
+    std::set<lvr2::VertexHandle> added, removed;
+    for (auto vH : changed)
+    {
+      const bool lethal = changed_lethals.find(vH) != changed_lethals.end();
+      const bool was_lethal = layer_upstream.find(vH) != layer_upstream.end();
+      if (lethal && !was_lethal)
+        added.insert(vH);
+      else if (!lethal && was_lethal)
+        removed.insert(vH);
+    }
+    if (added.empty() && removed.empty())
+      continue;
+
+    for (auto vH : removed)
+      layer_upstream.erase(vH);
+    layer_upstream.insert(added.begin(), added.end());
 
+    bool updated_locally;
+    {
+      std::lock_guard<std::mutex> data_lock(layer->dataMutex());
+      updated_locally = layer->updateLethalLocally(added, removed, changed);
+    }
+    if (!updated_locally)
+    {
+      // the layer has been recomputed completely, thus all following layers and all costs are renewed, they are not
+      // stored since the change is transient
+      updateLayers(layers[i].first, false);
+      return;
+    }
+    updated_layers.push_back(i);
+  }
+
+  // the combined lethal state can only change for the changed vertices
+  const std::set<lvr2::VertexHandle> changed_lethals = lethalVertices(changed, layers.size());
+  for (auto vH : changed)
+  {
+    if (changed_lethals.find(vH) != changed_lethals.end())
+      lethals.insert(vH);
+    else
+      lethals.erase(vH);
+  }
+
+  // sum up the weighted layer costs of the changed vertices only
+  std::vector<lvr2::VertexHandle> vertices(changed.begin(), changed.end());
+  std::vector<float> combined(vertices.size(), 0);
+  for (size_t i = 0; i < layers.size(); i++)
+  {
+    const auto& layer = layers[i].second;
+    std::lock_guard<std::mutex> data_lock(layer->dataMutex());
+    const auto& costs = layer->costs();
+    const float default_value = layer->defaultValue();
+    for (size_t j = 0; j < vertices.size(); j++)
+    {
+      const float cost = costs.containsKey(vertices[j]) ? costs[vertices[j]] : default_value;
+      combined[j] += layer_factors[i] * cost;
+    }
+  }
+
+  for (size_t j = 0; j < vertices.size(); j++)
+  {
+    const lvr2::VertexHandle& vH = vertices[j];
+    vertex_costs[vH] = lethals.find(vH) != lethals.end() ? std::numeric_limits<float>::infinity() : combined[j];
+    for (auto eH : mesh_ptr->getEdgesOfVertex(vH))
+      updateEdgeWeight(eH);
+  }
+  cost_version++;
+
+  updated_layers.insert(updated_layers.begin(), layer_iter - layers.begin());
+  for (auto i : updated_layers)
+  {
+    updateLayerVectors(layers[i].first, changed);
+    std::lock_guard<std::mutex> data_lock(layers[i].second->dataMutex());
+    publishLayerCosts(layers[i].second->costs(), layers[i].second->defaultValue(), layers[i].first);
+  }
+  publishLayerCosts(vertex_costs, 0, "Combined Costs");
+}
+
+std::set<lvr2::VertexHandle> MeshMap::lethalVertices(const std::set<lvr2::VertexHandle>& vertices,
+                                                     const size_t num_layers)
+{
+  std::set<lvr2::VertexHandle> lethal_vertices;
+  for (size_t i = 0; i < num_layers && i < layers.size(); i++)
+  {
+    std::lock_guard<std::mutex> data_lock(layers[i].second->dataMutex());
+    const auto& layer_lethals = layers[i].second->lethals();
+    for (auto vH : vertices)
+    {
+      if (layer_lethals.find(vH) != layer_lethals.end())
+        lethal_vertices.insert(vH);
+    }
+  }
+  return lethal_vertices;
+}
+
+void MeshMap::updateLayers(const std::string& layer_name, const bool persist)
+{
   ROS_INFO_STREAM("Layer \"" << layer_name << "\" changed.");
 
   lethals.clear();
@@ -346,16 +562,16 @@ void MeshMap::layerChanged(const std::string& layer_name)
   auto layer_iter = layers.begin();
   for (; layer_iter != layers.end(); layer_iter++)
   {
+    std::lock_guard<std::mutex> data_lock(layer_iter->second->dataMutex());
     lethals.insert(layer_iter->second->lethals().begin(), layer_iter->second->lethals().end());
     // TODO merge with std::set_merge
     if (layer_iter->first == layer_name)
+    {
+      publishLayerCosts(layer_iter->second->costs(), layer_iter->second->defaultValue(), layer_iter->first);
       break;
+    }
   }
 
-  vertex_costs_pub.publish(mesh_msgs_conversions::toVertexCostsStamped(layer_iter->second->costs(), mesh_ptr->numVertices(),
-                                                         layer_iter->second->defaultValue(), layer_iter->first,
-                                                         global_frame, uuid_str));
-
   if (layer_iter != layers.end())
     layer_iter++;
 
@@ -363,19 +579,43 @@ void MeshMap::layerChanged(const std::string& layer_name)
 
   for (; layer_iter != layers.end(); layer_iter++)
   {
-    layer_iter->second->updateLethal(lethals, lethals);
+    std::lock_guard<std::mutex> data_lock(layer_iter->second->dataMutex());
+    if (layer_iter->second->dependsOnUpstreamLethals())
+    {
+      // pass the difference to the lethals the layer has been updated with before
+      auto& layer_upstream = upstream_lethals[layer_iter - layers.begin()];
+      std::set<lvr2::VertexHandle> added, removed;
+      std::set_difference(lethals.begin(), lethals.end(), layer_upstream.begin(), layer_upstream.end(),
+                          std::inserter(added, added.end()));
+      std::set_difference(layer_upstream.begin(), layer_upstream.end(), lethals.begin(), lethals.end(),
+                          std::inserter(removed, removed.end()));
+      if (!added.empty() || !removed.empty())
+      {
+        layer_upstream = lethals;
+        layer_iter->second->updateLethal(added, removed);
+      }
+    }
 
     lethals.insert(layer_iter->second->lethals().begin(), layer_iter->second->lethals().end());
 
-    vertex_costs_pub.publish(mesh_msgs_conversions::toVertexCostsStamped(layer_iter->second->costs(), mesh_ptr->numVertices(),
-                                                           layer_iter->second->defaultValue(), layer_iter->first,
-                                                           global_frame, uuid_str));
+    publishLayerCosts(layer_iter->second->costs(), layer_iter->second->defaultValue(), layer_iter->first);
   }
 
   ROS_INFO_STREAM("Found " << lethals.size() << " lethal vertices");
   ROS_INFO_STREAM("Combine layer costs...");
 
   combineVertexCosts();
+
+  // the changed layer and all following layers may have updated their vectors and their data
+  for (auto iter = std::find_if(layers.begin(), layers.end(),
+                                [&layer_name](const auto& layer) { return layer.first == layer_name; });
+       iter != layers.end(); iter++)
+  {
+    updateLayerVectors(iter->first);
+    const size_t index = iter - layers.begin();
+    if (persist)
+      persistLayer(index, layerFingerprint(index));
+  }
   // TODO new lethals old lethals -> renew potential field! around this areas
 }
 
@@ -386,6 +626,10 @@ bool MeshMap::initLayerPlugins()
 
   std::shared_ptr<mesh_map::MeshMap> map(this);
 
+  layer_vectors.clear();
+  layer_vertex_vectors = lvr2::DenseVertexMap<mesh_map::Vector>(mesh_ptr->nextVertexIndex(), mesh_map::Vector());
+  upstream_lethals.assign(layers.size(), std::set<lvr2::VertexHandle>());
+
   for (auto& layer : layers)
   {
     auto& layer_plugin = layer.second;
@@ -398,20 +642,223 @@ bool MeshMap::initLayerPlugins()
       ROS_ERROR_STREAM("Could not initialize the layer plugin with the name \"" << layer_name << "\"!");
       return false;
     }
+  }
+
+  // Each layer is a node of the dependency graph: layers which depend on the lethals of the previous layers have an
+  // edge to all previous layers, all other layers have no incoming edges. Every layer is read or computed in its own
+  // task, which waits for the tasks of its dependencies, thus the independent layers are processed concurrently.
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::shared_future<void>> tasks;
+  std::vector<uint32_t> fingerprints(layers.size(), 0);
+  std::vector<char> computed(layers.size(), false);
+  tasks.reserve(layers.size());
+  for (size_t i = 0; i < layers.size(); i++)
+  {
+    const AbstractLayer::Ptr layer_plugin = layers[i].second;
+    const std::string layer_name = layers[i].first;
+
+    std::vector<std::shared_future<void>> dependencies;
+    std::vector<AbstractLayer::Ptr> upstream;
+    if (layer_plugin->dependsOnUpstreamLethals())
+    {
+      dependencies = tasks;
+      for (size_t j = 0; j < i; j++)
+        upstream.push_back(layers[j].second);
+    }
+
+    tasks.push_back(std::async(std::launch::async, [this, i, layer_plugin, layer_name, dependencies, upstream, start,
+                                                    &fingerprints, &computed]() {
+      for (const auto& dependency : dependencies)
+        dependency.wait();
+
+      if (!upstream.empty())
+      {
+        for (const auto& upstream_layer : upstream)
+          upstream_lethals[i].insert(upstream_layer->lethals().begin(), upstream_layer->lethals().end());
+        std::set<lvr2::VertexHandle> added(upstream_lethals[i]), empty;
+        layer_plugin->updateLethal(added, empty);
+      }
 
-    std::set<lvr2::VertexHandle> empty;
-    layer_plugin->updateLethal(lethals, empty);
-    if (!layer_plugin->readLayer())
+      // stored layer data is only read if it has been computed with the same parameters for the same mesh
+      fingerprints[i] = layerFingerprint(i);
+      if (!layerStored(layer_name, fingerprints[i]) || !layer_plugin->readLayer())
+      {
+        layer_plugin->computeLayer();
+        computed[i] = true;
+      }
+
+      ROS_INFO_STREAM("Layer \"" << layer_name << "\" is ready after "
+                                 << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                                 << "s.");
+    }));
+  }
+
+  // merge the lethals and vectors in the order of the layers, the later layers are processed meanwhile
+  bool success = true;
+  for (size_t i = 0; i < layers.size(); i++)
+  {
+    const auto& layer_plugin = layers[i].second;
+    const auto& layer_name = layers[i].first;
+
+    try
+    {
+      tasks[i].get();
+    }
+    catch (const std::exception& e)
     {
-      layer_plugin->computeLayer();
+      ROS_ERROR_STREAM("Could not read or compute the layer \"" << layer_name << "\": " << e.what());
+      success = false;
+      continue;
     }
 
+    if (computed[i])
+      persistLayer(i, fingerprints[i]);
+    else
+      persisted_fingerprints[layer_name] = fingerprints[i];
+
     lethal_indices[layer_name].insert(layer_plugin->lethals().begin(), layer_plugin->lethals().end());
     lethals.insert(layer_plugin->lethals().begin(), layer_plugin->lethals().end());
+
+    updateLayerVectors(layer_name);
+  }
+  return success;
+}
+
+uint32_t MeshMap::layerFingerprint(const size_t index)
+{
+  const auto& layer_name = layers[index].first;
+  const auto& layer_plugin = layers[index].second;
+
+  Fingerprint fingerprint;
+  fingerprint.mix(layer_types[layer_name]).mix(mesh_fingerprint);
+  layer_plugin->fingerprintParameters(fingerprint);
+
+  if (layer_plugin->dependsOnUpstreamLethals())
+  {
+    std::set<lvr2::VertexHandle> upstream_lethals;
+    for (size_t i = 0; i < index; i++)
+    {
+      std::lock_guard<std::mutex> data_lock(layers[i].second->dataMutex());
+      upstream_lethals.insert(layers[i].second->lethals().begin(), layers[i].second->lethals().end());
+    }
+    fingerprint.mix(static_cast<uint32_t>(upstream_lethals.size()));
+    for (auto vH : upstream_lethals)
+      fingerprint.mix(vH.idx());
+  }
+  return fingerprint.value();
+}
+
+bool MeshMap::layerStored(const std::string& layer_name, const uint32_t fingerprint)
+{
+  lvr2::IndexChannelOptional fingerprint_opt;
+  if (!mesh_io_ptr->getChannel("layer_fingerprints", layer_name + "_fingerprint", fingerprint_opt) ||
+      !fingerprint_opt || fingerprint_opt->numElements() != 1 || fingerprint_opt->width() != 1)
+  {
+    ROS_INFO_STREAM("The layer \"" << layer_name << "\" has not been stored with a fingerprint.");
+    return false;
+  }
+  if (fingerprint_opt->dataPtr()[0] != fingerprint)
+  {
+    ROS_INFO_STREAM("The layer \"" << layer_name << "\" has been stored with other parameters or for another mesh.");
+    return false;
   }
   return true;
 }
 
+void MeshMap::persistLayer(const size_t index, const uint32_t fingerprint)
+{
+  const std::string layer_name = layers[index].first;
+  const AbstractLayer::Ptr layer_plugin = layers[index].second;
+
+  auto persisted_iter = persisted_fingerprints.find(layer_name);
+  if (!persist_layers || (persisted_iter != persisted_fingerprints.end() && persisted_iter->second == fingerprint))
+    return;
+  persisted_fingerprints[layer_name] = fingerprint;
+
+  layer_writer->publish(layer_name, [io = mesh_io_ptr, layer_plugin, layer_name, fingerprint]() -> size_t {
+    std::lock_guard<std::mutex> lock(layer_plugin->dataMutex());
+
+    // the previous fingerprint is invalidated first, thus partially written layer data is never read
+    lvr2::IndexChannel channel(1, 1);
+    channel.dataPtr()[0] = 0;
+    if (!io->addChannel("layer_fingerprints", layer_name + "_fingerprint", channel) || !layer_plugin->writeLayer())
+    {
+      ROS_WARN_STREAM("Could not store the layer \"" << layer_name << "\" in the map.");
+      return 0;
+    }
+    channel.dataPtr()[0] = fingerprint;
+    if (!io->addChannel("layer_fingerprints", layer_name + "_fingerprint", channel))
+    {
+      ROS_WARN_STREAM("Could not store the fingerprint of the layer \"" << layer_name << "\" in the map.");
+      return 0;
+    }
+    ROS_INFO_STREAM("Stored the layer \"" << layer_name << "\" in the map.");
+    return layer_plugin->costs().numValues() * sizeof(float);
+  });
+}
+
+void MeshMap::updateLayerVectors(const std::string& layer_name)
+{
+  std::vector<lvr2::VertexHandle> vertices;
+  vertices.reserve(mesh_ptr->numVertices());
+  for (auto vH : mesh_ptr->vertices())
+    vertices.push_back(vH);
+  updateLayerVectors(layer_name, vertices);
+}
+
+void MeshMap::updateLayerVectors(const std::string& layer_name, const std::set<lvr2::VertexHandle>& changed_vertices)
+{
+  updateLayerVectors(layer_name, std::vector<lvr2::VertexHandle>(changed_vertices.begin(), changed_vertices.end()));
+}
+
+void MeshMap::updateLayerVectors(const std::string& layer_name, const std::vector<lvr2::VertexHandle>& vertices)
+{
+  auto layer_iter = layer_names.find(layer_name);
+  if (layer_iter == layer_names.end())
+    return;
+
+  const AbstractLayer::Ptr& layer = layer_iter->second;
+  auto vectors_iter = layer_vectors.find(layer_name);
+
+  // layers without a vector map do not contribute, only the previous contribution has to be removed
+  auto opt_vec_map = layer->vectorMap();
+  if (!opt_vec_map && vectors_iter == layer_vectors.end())
+    return;
+
+  if (vectors_iter == layer_vectors.end())
+  {
+    vectors_iter = layer_vectors
+                       .emplace(layer_name, lvr2::DenseVertexMap<mesh_map::Vector>(mesh_ptr->nextVertexIndex(),
+                                                                                   mesh_map::Vector()))
+                       .first;
+  }
+  auto& vectors = vectors_iter->second;
+
+  // a removed vector map has to be cleared at all vertices, not only at the given ones
+  if (!opt_vec_map)
+  {
+    for (auto vH : mesh_ptr->vertices())
+      layer_vertex_vectors[vH] -= vectors[vH];
+    layer_vectors.erase(vectors_iter);
+    ROS_INFO_STREAM("Removed the vertex vectors of layer \"" << layer_name << "\".");
+    return;
+  }
+
+  size_t changed_vertices = 0;
+  for (auto vH : vertices)
+  {
+    const mesh_map::Vector vec = layer->vectorAt(vH);
+    if (vec == vectors[vH])
+      continue;
+
+    layer_vertex_vectors[vH] += vec - vectors[vH];
+    vectors[vH] = vec;
+    changed_vertices++;
+  }
+
+  ROS_INFO_STREAM("Updated " << changed_vertices << " vertex vectors of layer \"" << layer_name << "\".");
+}
+
 void MeshMap::combineVertexCosts()
 {
   ROS_INFO_STREAM("Combining costs...");
@@ -420,15 +867,21 @@ void MeshMap::combineVertexCosts()
   float combined_max = std::numeric_limits<float>::min();
 
   vertex_costs = lvr2::DenseVertexMap<float>(mesh_ptr->nextVertexIndex(), 0);
+  // the factors are re-read on every combination, the incremental updates use the ones of the last combination
+  layer_factors.clear();
+  layer_factors.reserve(layers.size());
 
   bool hasNaN = false;
-  for (auto layer : layers)
+  for (const auto& layer : layers)
   {
+    // the layers may update their costs concurrently, e.g. from sensor data
+    std::lock_guard<std::mutex> data_lock(layer.second->dataMutex());
     const auto& costs = layer.second->costs();
     float min, max;
     mesh_map::getMinMax(costs, min, max);
     const float norm = max - min;
     const float factor = private_nh.param<float>(layer.first + "/factor", 1.0);
+    layer_factors.push_back(factor);
     const float norm_factor = factor / norm;
     ROS_INFO_STREAM("Layer \"" << layer.first << "\" max value: " << max << " min value: " << min << " norm: " << norm
                                << " factor: " << factor << " norm factor: " << norm_factor);
@@ -458,44 +911,50 @@ void MeshMap::combineVertexCosts()
     vertex_costs[vH] = std::numeric_limits<float>::infinity();
   }
 
-  vertex_costs_pub.publish(mesh_msgs_conversions::toVertexCostsStamped(vertex_costs, "Combined Costs", global_frame, uuid_str));
+  publishLayerCosts(vertex_costs, 0, "Combined Costs");
 
   hasNaN = false;
 
   ROS_INFO_STREAM("Layer weighting factor is: " << config.layer_factor);
   for (auto eH : mesh_ptr->edges())
   {
-    // Get both Vertices of the current Edge
-    std::array<lvr2::VertexHandle, 2> eH_vHs = mesh_ptr->getVerticesOfEdge(eH);
-    const lvr2::VertexHandle& vH1 = eH_vHs[0];
-    const lvr2::VertexHandle& vH2 = eH_vHs[1];
-    // Get the Riskiness for the current Edge (the maximum value from both
-    // Vertices)
-    if (config.layer_factor != 0)
-    {
-      if (std::isinf(vertex_costs[vH1]) || std::isinf(vertex_costs[vH2]))
-      {
-        edge_weights[eH] = edge_distances[eH];
-        // edge_weights[eH] = std::numeric_limits<float>::infinity();
-      }
-      else
-      {
-        float cost_diff = std::fabs(vertex_costs[vH1] - vertex_costs[vH2]);
+    updateEdgeWeight(eH);
+  }
 
-        float vertex_factor = config.layer_factor * cost_diff;
-        if (std::isnan(vertex_factor))
-          ROS_INFO_STREAM("NaN: v1:" << vertex_costs[vH1] << " v2:" << vertex_costs[vH2]
-                                     << " vertex_factor:" << vertex_factor << " cost_diff:" << cost_diff);
-        edge_weights[eH] = edge_distances[eH] * (1 + vertex_factor);
-      }
+  cost_version++;
+  ROS_INFO("Successfully combined costs!");
+}
+
+void MeshMap::updateEdgeWeight(const lvr2::EdgeHandle& eH)
+{
+  // Get both Vertices of the current Edge
+  std::array<lvr2::VertexHandle, 2> eH_vHs = mesh_ptr->getVerticesOfEdge(eH);
+  const lvr2::VertexHandle& vH1 = eH_vHs[0];
+  const lvr2::VertexHandle& vH2 = eH_vHs[1];
+  // Get the Riskiness for the current Edge (the maximum value from both
+  // Vertices)
+  if (config.layer_factor != 0)
+  {
+    if (std::isinf(vertex_costs[vH1]) || std::isinf(vertex_costs[vH2]))
+    {
+      edge_weights[eH] = edge_distances[eH];
+      // edge_weights[eH] = std::numeric_limits<float>::infinity();
     }
     else
     {
-      edge_weights[eH] = edge_distances[eH];
+      float cost_diff = std::fabs(vertex_costs[vH1] - vertex_costs[vH2]);
+
+      float vertex_factor = config.layer_factor * cost_diff;
+      if (std::isnan(vertex_factor))
+        ROS_INFO_STREAM("NaN: v1:" << vertex_costs[vH1] << " v2:" << vertex_costs[vH2]
+                                   << " vertex_factor:" << vertex_factor << " cost_diff:" << cost_diff);
+      edge_weights[eH] = edge_distances[eH] * (1 + vertex_factor);
     }
   }
-
-  ROS_INFO("Successfully combined costs!");
+  else
+  {
+    edge_weights[eH] = edge_distances[eH];
+  }
 }
 
 void MeshMap::findLethalByContours(const int& min_contour_size, std::set<lvr2::VertexHandle>& lethals)
@@ -646,6 +1105,9 @@ float MeshMap::costAtPosition(const lvr2::DenseVertexMap<float>& costs,
 
 void MeshMap::publishDebugPoint(const Vector pos, const std_msgs::ColorRGBA& color, const std::string& name)
 {
+  if (!debugEnabled())
+    return;
+
   visualization_msgs::Marker marker;
   marker.header.frame_id = mapFrame();
   marker.header.stamp = ros::Time();
@@ -665,12 +1127,15 @@ void MeshMap::publishDebugPoint(const Vector pos, const std_msgs::ColorRGBA& col
   p.position.z = pos.z;
   marker.pose = p;
   marker.color = color;
-  marker_pub.publish(marker);
+  debug_marker_pub->add(std::move(marker));
 }
 
 void MeshMap::publishDebugFace(const lvr2::FaceHandle& face_handle, const std_msgs::ColorRGBA& color,
                                const std::string& name)
 {
+  if (!debugEnabled())
+    return;
+
   const auto& vertices = mesh_ptr->getVerticesOfFace(face_handle);
   visualization_msgs::Marker marker;
   marker.header.frame_id = mapFrame();
@@ -695,7 +1160,7 @@ void MeshMap::publishDebugFace(const lvr2::FaceHandle& face_handle, const std_ms
     marker.points.push_back(p);
     marker.colors.push_back(color);
   }
-  marker_pub.publish(marker);
+  debug_marker_pub->add(std::move(marker));
 }
 
 void MeshMap::publishVectorField(const std::string& name,
@@ -707,60 +1172,29 @@ void MeshMap::publishVectorField(const std::string& name,
 
 void MeshMap::publishCombinedVectorField()
 {
-  lvr2::DenseVertexMap<Vector> vertex_vectors;
-  lvr2::DenseFaceMap<Vector> face_vectors;
-
-  vertex_vectors.reserve(mesh_ptr->nextVertexIndex());
-  face_vectors.reserve(mesh_ptr->nextFaceIndex());
-
-  for (auto layer_iter : layer_names)
-  {
-    lvr2::DenseFaceMap<uint8_t> vector_field_faces(mesh_ptr->nextFaceIndex(), 0);
-    AbstractLayer::Ptr layer = layer_iter.second;
-    auto opt_vec_map = layer->vectorMap();
-    if (!opt_vec_map)
-      continue;
-
-    const auto& vecs = opt_vec_map.get();
-    for (auto vH : vecs)
-    {
-      auto opt_val = vertex_vectors.get(vH);
-      vertex_vectors.insert(vH, opt_val ? opt_val.get() + vecs[vH] : vecs[vH]);
-      for (auto fH : mesh_ptr->getFacesOfVertex(vH))
-        vector_field_faces[fH]++;
-    }
-
-    for (auto fH : vector_field_faces)
-    {
-      if (vector_field_faces[fH] != 3)
-        continue;
-
-      const auto& vertices = mesh_ptr->getVertexPositionsOfFace(fH);
-      const auto& vertex_handles = mesh_ptr->getVerticesOfFace(fH);
-      mesh_map::Vector center = (vertices[0] + vertices[1] + vertices[2]) / 3;
-      std::array<float, 3> barycentric_coords;
-      float dist;
-      if (mesh_map::projectedBarycentricCoords(center, vertices, barycentric_coords, dist))
-      {
-        auto opt_val = face_vectors.get(fH);
-        auto vec_at = layer->vectorAt(vertex_handles, barycentric_coords);
-        if (vec_at != Vector())
-        {
-          face_vectors.insert(fH, opt_val ? opt_val.get() + vec_at : vec_at);
-        }
-      }
-    }
-  }
+  publishVectorField("combined", layer_vertex_vectors, true);
 }
 
 void MeshMap::publishVectorField(const std::string& name,
                                  const lvr2::DenseVertexMap<lvr2::BaseVector<float>>& vector_map,
                                  const lvr2::DenseVertexMap<float>& values,
                                  const std::function<float(float)>& cost_function, const bool publish_face_vectors)
+{
+  // the marker is built from copies on the publishing thread, the caller may change its maps meanwhile
+  background_pub->publish<visualization_msgs::Marker>(
+      "vector_field/" + name, vector_field_pub,
+      [this, name, vector_map, values, cost_function, publish_face_vectors]() {
+        return vectorFieldMarker(name, vector_map, values, cost_function, publish_face_vectors);
+      });
+}
+
+visualization_msgs::Marker MeshMap::vectorFieldMarker(const std::string& name,
+                                                      const lvr2::DenseVertexMap<lvr2::BaseVector<float>>& vector_map,
+                                                      const lvr2::DenseVertexMap<float>& values,
+                                                      const std::function<float(float)>& cost_function,
+                                                      const bool publish_face_vectors)
 {
   const auto& mesh = this->mesh();
-  const auto& vertex_costs = vertexCosts();
-  const auto& face_normals = faceNormals();
 
   visualization_msgs::Marker vector_field;
 
@@ -778,132 +1212,215 @@ void MeshMap::publishVectorField(const std::string& name,
   vector_field.color.a = 1;
   vector_field.id = 0;
 
-  vector_field.colors.reserve(2 * vector_map.numValues());
-  vector_field.points.reserve(2 * vector_map.numValues());
-
-  unsigned int cnt = 0;
-  unsigned int faces = 0;
+  const float density = vector_field_density;
+  const float radius = vector_field_radius;
 
-  lvr2::DenseFaceMap<uint8_t> vector_field_faces(mesh.numFaces(), 0);
-  std::set<lvr2::FaceHandle> complete_faces;
-
-  for (auto vH : vector_map)
+  // limit the vectors to the robot's neighbourhood, the whole map is used if the robot pose is unknown
+  bool limit_radius = false;
+  Vector robot_position;
+  if (radius > 0)
   {
-    const auto& dir_vec = vector_map[vH];
-    const float len2 = dir_vec.length2();
-    if (len2 == 0 || !std::isfinite(len2))
+    try
     {
-      ROS_DEBUG_STREAM_THROTTLE(0.3, "Found invalid direction vector in vector field \"" << name << "\". Ignoring it!");
-      continue;
+      const auto transform = tf_buffer.lookupTransform(global_frame, robot_frame, ros::Time(0));
+      robot_position = Vector(transform.transform.translation.x, transform.transform.translation.y,
+                              transform.transform.translation.z);
+      limit_radius = true;
     }
-
-    auto u = mesh.getVertexPosition(vH);
-    auto v = u + dir_vec * 0.1;
-
-    u.z = u.z + 0.01;
-    v.z = v.z + 0.01;
-
-    if (!std::isfinite(u.x) || !std::isfinite(u.y) || !std::isfinite(u.z) || !std::isfinite(v.x) ||
-        !std::isfinite(v.y) || !std::isfinite(v.z))
+    catch (const tf2::TransformException& e)
     {
-      continue;
+      ROS_WARN_STREAM_THROTTLE(5.0, "Could not look up the robot pose to limit the vector field: " << e.what());
     }
-    vector_field.points.push_back(toPoint(u));
-    vector_field.points.push_back(toPoint(v));
+  }
+  const float radius2 = radius * radius;
 
-    const float value = cost_function ? cost_function(values[vH]) : values[vH];
-    std_msgs::ColorRGBA color = getRainbowColor(value);
-    vector_field.colors.push_back(color);
-    vector_field.colors.push_back(color);
-
-    cnt++;
-    // vector.header.seq = cnt;
-    // vector.id = cnt++;
-    // vector_field.markers.push_back(vector);
+  // the vertices with a valid vector and position within the radius
+  const long num_vertices = mesh.nextVertexIndex();
+  std::vector<uint8_t> valid(num_vertices, 0);
+#pragma omp parallel for schedule(static)
+  for (long i = 0; i < num_vertices; i++)
+  {
+    const lvr2::VertexHandle vH(i);
+    if (!vector_map.containsKey(vH))
+      continue;
+    const float len2 = vector_map[vH].length2();
+    if (len2 == 0 || !std::isfinite(len2))
+      continue;
     try
     {
-      for (auto fH : mesh.getFacesOfVertex(vH))
-      {
-        if (++vector_field_faces[fH] == 3)
-        {
-          faces++;
-          complete_faces.insert(fH);
-        }
-      }
+      const Vector u = mesh.getVertexPosition(vH);
+      const Vector v = u + vector_map[vH] * 0.1;
+      if (!std::isfinite(u.x) || !std::isfinite(u.y) || !std::isfinite(u.z) || !std::isfinite(v.x) ||
+          !std::isfinite(v.y) || !std::isfinite(v.z))
+        continue;
+      if (limit_radius && (u - robot_position).length2() > radius2)
+        continue;
+      valid[i] = 1;
     }
     catch (lvr2::PanicException exception)
     {
-      invalid.insert(vH, true);
     }
   }
 
-  size_t invalid_cnt = 0;
-  for (auto vH : invalid)
+  std::vector<lvr2::Index> selected;
+  if (density > 0)
   {
-    if (invalid[vH])
-      invalid_cnt++;
-  }
+    // spatial decimation, the vertex closest to the center of each voxel represents it, a surface crossing a voxel
+    // thereby contributes about one vector per cell_size^2
+    const float cell_size = 1.0 / std::sqrt(density);
+    std::vector<uint64_t> keys(num_vertices);
+    std::vector<float> center_dists(num_vertices);
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < num_vertices; i++)
+    {
+      if (!valid[i])
+        continue;
+      const Vector u = mesh.getVertexPosition(lvr2::VertexHandle(i));
+      const float position[3] = { u.x, u.y, u.z };
+      uint64_t key = 0;
+      float dist2 = 0;
+      for (size_t k = 0; k < 3; k++)
+      {
+        const float cell = std::floor(position[k] / cell_size);
+        key = (key << 21) | (static_cast<uint64_t>(static_cast<int64_t>(cell)) & 0x1FFFFF);
+        const float offset = position[k] - (cell + 0.5f) * cell_size;
+        dist2 += offset * offset;
+      }
+      keys[i] = key;
+      center_dists[i] = dist2;
+    }
 
-  if (invalid_cnt > 0)
+    std::unordered_map<uint64_t, lvr2::Index> cells;
+    for (long i = 0; i < num_vertices; i++)
+    {
+      if (!valid[i])
+        continue;
+      auto inserted = cells.emplace(keys[i], i);
+      if (!inserted.second && center_dists[i] < center_dists[inserted.first->second])
+        inserted.first->second = i;
+    }
+    selected.reserve(cells.size());
+    for (const auto& cell : cells)
+    {
+      selected.push_back(cell.second);
+    }
+    std::sort(selected.begin(), selected.end());
+  }
+  else
   {
-    ROS_WARN_STREAM("Found " << invalid_cnt << " non manifold vertices!");
+    for (long i = 0; i < num_vertices; i++)
+    {
+      if (valid[i])
+        selected.push_back(i);
+    }
   }
-  ROS_INFO_STREAM("Found " << faces << " complete vector faces!");
 
-  if (publish_face_vectors)
+  // the face vectors are only added to the full resolution vector field
+  std::vector<lvr2::Index> complete_faces;
+  if (publish_face_vectors && density <= 0)
   {
-    vector_field.points.reserve(faces + cnt);
-
-    for (auto fH : complete_faces)
+    const long num_faces = mesh.nextFaceIndex();
+    std::vector<uint8_t> complete(num_faces, 0);
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < num_faces; i++)
     {
-      const auto& vertices = mesh.getVertexPositionsOfFace(fH);
-      const auto& vertex_handles = mesh.getVerticesOfFace(fH);
-      mesh_map::Vector center = (vertices[0] + vertices[1] + vertices[2]) / 3;
-      std::array<float, 3> barycentric_coords;
-      float dist;
-      if (mesh_map::projectedBarycentricCoords(center, vertices, barycentric_coords, dist))
+      try
       {
-        boost::optional<mesh_map::Vector> dir_opt = directionAtPosition(vector_map, vertex_handles, barycentric_coords);
-        if (dir_opt)
-        {
-          const float& cost = costAtPosition(values, vertex_handles, barycentric_coords);
-          const float& value = cost_function ? cost_function(cost) : cost;
+        const auto vertices = mesh.getVerticesOfFace(lvr2::FaceHandle(i));
+        complete[i] = valid[vertices[0].idx()] && valid[vertices[1].idx()] && valid[vertices[2].idx()];
+      }
+      catch (lvr2::PanicException exception)
+      {
+      }
+    }
+    for (long i = 0; i < num_faces; i++)
+    {
+      if (complete[i])
+        complete_faces.push_back(i);
+    }
+    ROS_INFO_STREAM("Found " << complete_faces.size() << " complete vector faces!");
+  }
 
-          // vector.color = getRainbowColor(value);
-          // vector.pose = mesh_map::calculatePoseFromDirection(
-          //    center, dir_opt.get(), face_normals[fH]);
+  // all vectors are written into the preallocated arrays, failed face vectors are removed afterwards
+  const long num_selected = selected.size();
+  const long num_complete = complete_faces.size();
+  vector_field.points.resize(2 * (num_selected + num_complete));
+  vector_field.colors.resize(2 * (num_selected + num_complete));
 
-          auto u = center;
-          auto v = u + dir_opt.get() * 0.1;
+#pragma omp parallel for schedule(static)
+  for (long i = 0; i < num_selected; i++)
+  {
+    const lvr2::VertexHandle vH(selected[i]);
+    Vector u = mesh.getVertexPosition(vH);
+    Vector v = u + vector_map[vH] * 0.1;
+    u.z = u.z + 0.01;
+    v.z = v.z + 0.01;
+    vector_field.points[2 * i] = toPoint(u);
+    vector_field.points[2 * i + 1] = toPoint(v);
 
-          if (!std::isfinite(u.x) || !std::isfinite(u.y) || !std::isfinite(u.z) || !std::isfinite(v.x) ||
-              !std::isfinite(v.y) || !std::isfinite(v.z))
-          {
-            continue;
-          }
+    const float value = cost_function ? cost_function(values[vH]) : values[vH];
+    vector_field.colors[2 * i] = vector_field.colors[2 * i + 1] = getRainbowColor(value);
+  }
 
-          // vector_field.header.seq = cnt;
-          // vector_field.id = cnt++;
-          vector_field.points.push_back(toPoint(u));
-          vector_field.points.push_back(toPoint(v));
+  std::vector<uint8_t> face_vector_valid(num_complete, 0);
+  size_t failed_faces = 0;
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+ : failed_faces)
+  for (long i = 0; i < num_complete; i++)
+  {
+    const lvr2::FaceHandle fH(complete_faces[i]);
+    const auto& vertices = mesh.getVertexPositionsOfFace(fH);
+    const auto& vertex_handles = mesh.getVerticesOfFace(fH);
+    const Vector center = (vertices[0] + vertices[1] + vertices[2]) / 3;
+    std::array<float, 3> barycentric_coords;
+    float dist;
+    boost::optional<mesh_map::Vector> dir_opt;
+    if (!mesh_map::projectedBarycentricCoords(center, vertices, barycentric_coords, dist) ||
+        !(dir_opt = directionAtPosition(vector_map, vertex_handles, barycentric_coords)))
+    {
+      failed_faces++;
+      continue;
+    }
 
-          std_msgs::ColorRGBA color = getRainbowColor(value);
-          vector_field.colors.push_back(color);
-          vector_field.colors.push_back(color);
-        }
-        else
-        {
-          ROS_ERROR_STREAM_THROTTLE(0.3, "Could not compute the direction!");
-        }
-      }
-      else
-      {
-        ROS_ERROR_STREAM_THROTTLE(0.3, "Could not compute the barycentric coords!");
-      }
+    const Vector v = center + dir_opt.get() * 0.1;
+    if (!std::isfinite(center.x) || !std::isfinite(center.y) || !std::isfinite(center.z) || !std::isfinite(v.x) ||
+        !std::isfinite(v.y) || !std::isfinite(v.z))
+      continue;
+
+    const float cost = costAtPosition(values, vertex_handles, barycentric_coords);
+    const float value = cost_function ? cost_function(cost) : cost;
+    const long slot = num_selected + i;
+    vector_field.points[2 * slot] = toPoint(center);
+    vector_field.points[2 * slot + 1] = toPoint(v);
+    vector_field.colors[2 * slot] = vector_field.colors[2 * slot + 1] = getRainbowColor(value);
+    face_vector_valid[i] = 1;
+  }
+  if (failed_faces > 0)
+  {
+    ROS_ERROR_STREAM("Could not compute the direction of " << failed_faces << " face vectors!");
+  }
+
+  // compact the face vectors
+  size_t end = 2 * num_selected;
+  for (long i = 0; i < num_complete; i++)
+  {
+    if (!face_vector_valid[i])
+      continue;
+    const size_t slot = 2 * (num_selected + i);
+    if (slot != end)
+    {
+      vector_field.points[end] = vector_field.points[slot];
+      vector_field.points[end + 1] = vector_field.points[slot + 1];
+      vector_field.colors[end] = vector_field.colors[slot];
+      vector_field.colors[end + 1] = vector_field.colors[slot + 1];
     }
+    end += 2;
   }
-  vector_field_pub.publish(vector_field);
-  ROS_INFO_STREAM("Published vector field \"" << name << "\" with " << cnt << " elements.");
+  vector_field.points.resize(end);
+  vector_field.colors.resize(end);
+
+  ROS_INFO_STREAM("Publish vector field \"" << name << "\" with " << end / 2 << " of " << num_vertices
+                                             << " vectors.");
+  return vector_field;
 }
 
 bool MeshMap::inTriangle(const Vector& pos, const lvr2::FaceHandle& face, const float& dist)
@@ -985,6 +1502,12 @@ boost::optional<std::tuple<lvr2::FaceHandle, std::array<Vector, 3>, std::array<f
 }
 
 bool MeshMap::meshAhead(mesh_map::Vector& pos, lvr2::FaceHandle& face, const float& step_size)
+{
+  return meshAhead(pos, face, step_size, vector_map);
+}
+
+bool MeshMap::meshAhead(mesh_map::Vector& pos, lvr2::FaceHandle& face, const float& step_size,
+                        const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map)
 {
   std::array<float, 3> bary_coords;
   float dist;
@@ -1007,23 +1530,134 @@ bool MeshMap::meshAhead(mesh_map::Vector& pos, lvr2::FaceHandle& face, const flo
   {
     return false;
   }
-  const auto& opt_dir = directionAtPosition(vector_map, mesh_ptr->getVerticesOfFace(face), bary_coords);
+  const auto& opt_dir = combinedDirectionAtPosition(vector_map, mesh_ptr->getVerticesOfFace(face), bary_coords);
   if (opt_dir)
   {
-    Vector dir = opt_dir.get().normalized();
-    std::array<lvr2::VertexHandle, 3> handels = mesh_ptr->getVerticesOfFace(face);
-    // iter over all layer vector fields
-    for (auto layer : layers)
+    pos += opt_dir.get() * step_size;
+    return true;
+  }
+  return false;
+}
+
+boost::optional<Vector> MeshMap::combinedDirectionAtPosition(const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map,
+                                                             const std::array<lvr2::VertexHandle, 3>& vertices,
+                                                             const std::array<float, 3>& barycentric_coords)
+{
+  const auto& opt_dir = directionAtPosition(vector_map, vertices, barycentric_coords);
+  if (!opt_dir)
+    return boost::none;
+
+  Vector dir = opt_dir.get().normalized();
+  // add the materialised vector field of all layers
+  dir += mesh_map::linearCombineBarycentricCoords<mesh_map::Vector>(vertices, layer_vertex_vectors, barycentric_coords);
+  return dir.normalized();
+}
+
+bool MeshMap::walkToFace(const Vector& pos, lvr2::FaceHandle& face, std::array<float, 3>& bary_coords, float& dist,
+                         const size_t max_steps)
+{
+  // a face is never its own neighbour, so the start face is a valid initial value
+  lvr2::FaceHandle previous = face;
+  for (size_t step = 0; step <= max_steps; step++)
+  {
+    if (mesh_map::projectedBarycentricCoords(pos, mesh_ptr->getVertexPositionsOfFace(face), bary_coords, dist))
+      return true;
+
+    // cross the edge opposite to the most negative coordinate, a negative coordinate means the position lies behind
+    // that edge. Do not step back to the previous face to avoid oscillating between two faces.
+    int best = -1;
+    for (int k = 0; k < 3; k++)
     {
-      dir += layer.second->vectorAt(handels, bary_coords);
+      const auto& neighbour = face_neighbours[face][k];
+      if (bary_coords[k] < 0 && neighbour && neighbour.unwrap() != previous && (best < 0 || bary_coords[k] < bary_coords[best]))
+        best = k;
     }
-    dir.normalize();
-    pos += dir * step_size;
-    return true;
+    if (best < 0)
+      return false;
+
+    previous = face;
+    face = face_neighbours[face][best].unwrap();
   }
   return false;
 }
 
+bool MeshMap::meshAheadExact(mesh_map::Vector& pos, lvr2::FaceHandle& face, const float& step_size,
+                             const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map)
+{
+  // an edge crossing without any progress happens if the field points back into the previous face
+  const size_t max_crossings = 3;
+  for (size_t crossings = 0; crossings < max_crossings; crossings++)
+  {
+    const auto positions = mesh_ptr->getVertexPositionsOfFace(face);
+    std::array<float, 3> bary_coords;
+    float dist;
+    if (!mesh_map::projectedBarycentricCoords(pos, positions, bary_coords, dist))
+    {
+      // the position left the face, relocate it with the neighbour search
+      return meshAhead(pos, face, step_size, vector_map);
+    }
+
+    // clamp the position onto the triangle
+    float sum = 0;
+    for (auto& coord : bary_coords)
+    {
+      coord = std::max(coord, 0.0f);
+      sum += coord;
+    }
+    for (auto& coord : bary_coords)
+    {
+      coord /= sum;
+    }
+    pos = mesh_map::linearCombineBarycentricCoords(positions, bary_coords);
+
+    const auto& opt_dir = combinedDirectionAtPosition(vector_map, mesh_ptr->getVerticesOfFace(face), bary_coords);
+    if (!opt_dir)
+      return false;
+
+    // move within the triangle's plane
+    const Normal& normal = face_normals[face];
+    Vector dir = opt_dir.get() - normal * opt_dir.get().dot(normal);
+    if (dir.length2() < 1e-12)
+      return false;
+    dir.normalize();
+
+    // the barycentric coordinates change linearly along the direction, find the first one dropping to zero
+    std::array<float, 3> bary_ahead;
+    mesh_map::projectedBarycentricCoords(pos + dir, positions, bary_ahead, dist);
+
+    float step = step_size;
+    int exit_edge = -1;
+    for (int k = 0; k < 3; k++)
+    {
+      const float delta = bary_ahead[k] - bary_coords[k];
+      if (delta < -1e-9)
+      {
+        const float t = -bary_coords[k] / delta;
+        if (t < step)
+        {
+          step = t;
+          exit_edge = k;
+        }
+      }
+    }
+
+    pos += dir * step;
+    if (exit_edge < 0)
+      return true;
+
+    const auto& neighbour = face_neighbours[face][exit_edge];
+    if (!neighbour)
+      return false;
+    face = neighbour.unwrap();
+
+    if (step > 1e-6)
+      return true;
+  }
+
+  // no progress on the edge, take a fixed step instead
+  return meshAhead(pos, face, step_size, vector_map);
+}
+
 lvr2::OptionalFaceHandle MeshMap::getContainingFace(Vector& position, const float& max_dist)
 {
   auto search_result = searchContainingFace(position, max_dist);
@@ -1036,6 +1670,16 @@ boost::optional<std::tuple<lvr2::FaceHandle, std::array<mesh_map::Vector , 3>,
     std::array<float, 3>>> MeshMap::searchContainingFace(
     Vector& position, const float& max_dist)
 {
+  // the face grid locates the triangle directly, vertical triangles and positions off the mesh are searched below
+  if (face_grid_ptr)
+  {
+    if (auto located = face_grid_ptr->locate(position.x, position.y, position.z, max_dist))
+    {
+      const lvr2::FaceHandle& fH = std::get<0>(*located);
+      return std::make_tuple(fH, mesh_ptr->getVertexPositionsOfFace(fH), std::get<1>(*located));
+    }
+  }
+
   if(auto vH_opt = getNearestVertexHandle(position))
   {
     auto vH = vH_opt.unwrap();
@@ -1048,16 +1692,16 @@ boost::optional<std::tuple<lvr2::FaceHandle, std::array<mesh_map::Vector , 3>,
       const auto& tmp_vertices = mesh_ptr->getVertexPositionsOfFace(fH);
       float dist = 0;
       std::array<float, 3> tmp_bary_coords;
-      if (mesh_map::projectedBarycentricCoords(position, vertices, tmp_bary_coords, dist)
+      if (mesh_map::projectedBarycentricCoords(position, tmp_vertices, tmp_bary_coords, dist)
           && std::fabs(dist) < max_dist)
       {
         return std::make_tuple(fH, tmp_vertices, tmp_bary_coords);
       }
 
       float triangle_dist = 0;
-      triangle_dist += (vertices[0] - position).length2();
-      triangle_dist += (vertices[1] - position).length2();
-      triangle_dist += (vertices[2] - position).length2();
+      triangle_dist += (tmp_vertices[0] - position).length2();
+      triangle_dist += (tmp_vertices[1] - position).length2();
+      triangle_dist += (tmp_vertices[2] - position).length2();
       if(triangle_dist < min_triangle_position_distance)
       {
         min_triangle_position_distance = triangle_dist;
@@ -1077,6 +1721,77 @@ boost::optional<std::tuple<lvr2::FaceHandle, std::array<mesh_map::Vector , 3>,
   return boost::none;
 }
 
+boost::optional<std::tuple<lvr2::FaceHandle, std::array<float, 3>>> MeshMap::locateFace(const float x, const float y,
+                                                                                         const float z_hint,
+                                                                                         const float max_dist)
+{
+  if (face_grid_ptr)
+    return face_grid_ptr->locate(x, y, z_hint, max_dist);
+
+  Vector position(x, y, z_hint);
+  if (auto search_result = searchContainingFace(position, max_dist))
+    return std::make_tuple(std::get<0>(*search_result), std::get<2>(*search_result));
+  return boost::none;
+}
+
+void MeshMap::projectPoints(const std::vector<Vector>& points, const float max_dist,
+                            std::vector<lvr2::OptionalFaceHandle>& faces,
+                            std::vector<std::array<float, 3>>& barycentric_coords, std::vector<float>& heights)
+{
+  faces.assign(points.size(), lvr2::OptionalFaceHandle());
+  barycentric_coords.resize(points.size());
+  heights.resize(points.size());
+
+  // the k-d tree and the mesh are only read, thus the points are projected concurrently
+#pragma omp parallel
+  {
+    std::vector<lvr2::FaceHandle> vertex_faces;
+#pragma omp for schedule(dynamic, 1024)
+    for (long i = 0; i < static_cast<long>(points.size()); i++)
+    {
+      const Vector& point = points[i];
+
+      // the face grid locates the triangle by the xy position, the height is measured along its normal, vertical
+      // triangles and points off the mesh are searched from the nearest vertex below
+      if (face_grid_ptr)
+      {
+        if (auto located = face_grid_ptr->locate(point.x, point.y, point.z, max_dist))
+        {
+          const lvr2::FaceHandle& fH = std::get<0>(*located);
+          std::array<float, 3> coords;
+          float dist;
+          mesh_map::projectedBarycentricCoords(point, mesh_ptr->getVertexPositionsOfFace(fH), coords, dist);
+          faces[i] = fH;
+          barycentric_coords[i] = std::get<1>(*located);
+          heights[i] = dist;
+          continue;
+        }
+      }
+
+      auto vH_opt = getNearestVertexHandle(point);
+      if (!vH_opt)
+        continue;
+
+      vertex_faces.clear();
+      mesh_ptr->getFacesOfVertex(vH_opt.unwrap(), vertex_faces);
+      float min_dist = max_dist;
+      for (auto fH : vertex_faces)
+      {
+        std::array<float, 3> coords;
+        float dist;
+        if (mesh_map::projectedBarycentricCoords(point, mesh_ptr->getVertexPositionsOfFace(fH), coords, dist) &&
+            std::fabs(dist) <= min_dist)
+        {
+          min_dist = std::fabs(dist);
+          faces[i] = fH;
+          barycentric_coords[i] = coords;
+          heights[i] = dist;
+        }
+      }
+    }
+  }
+}
+
 lvr2::OptionalVertexHandle MeshMap::getNearestVertexHandle(const Vector& pos)
 {
   float querry_point[3] = {pos.x, pos.y, pos.z};
@@ -1184,17 +1899,51 @@ void MeshMap::publishCostLayers()
 {
   for (auto& layer : layers)
   {
-    vertex_costs_pub.publish(mesh_msgs_conversions::toVertexCostsStamped(layer.second->costs(), mesh_ptr->numVertices(),
-                                                           layer.second->defaultValue(), layer.first, global_frame,
-                                                           uuid_str));
+    publishLayerCosts(layer.second->costs(), layer.second->defaultValue(), layer.first);
   }
-  vertex_costs_pub.publish(mesh_msgs_conversions::toVertexCostsStamped(vertex_costs, "Combined Costs", global_frame, uuid_str));
+  publishLayerCosts(vertex_costs, 0, "Combined Costs");
 }
 
 void MeshMap::publishVertexCosts(const lvr2::VertexMap<float>& costs, const std::string& name)
 {
-  vertex_costs_pub.publish(
-      mesh_msgs_conversions::toVertexCostsStamped(costs, mesh_ptr->numVertices(), 0, name, global_frame, uuid_str));
+  publishLayerCosts(costs, 0, name);
+}
+
+void MeshMap::publishLayerCosts(const lvr2::VertexMap<float>& costs, const float default_value,
+                                const std::string& name)
+{
+  if (!publish_cost_deltas && vertex_costs_pub.getNumSubscribers() == 0)
+    return;
+
+  // the caller only pays for the snapshot, the message is built and serialised on the publishing thread
+  const size_t num_vertices = mesh_ptr->numVertices();
+  std::vector<float> snapshot(num_vertices);
+  for (size_t i = 0; i < num_vertices; i++)
+  {
+    const lvr2::VertexHandle vH(i);
+    snapshot[i] = costs.containsKey(vH) ? costs[vH] : default_value;
+  }
+
+  if (publish_cost_deltas)
+  {
+    // the deltas refer to the last published state, thus superseded snapshots can be dropped as well
+    background_pub->publish("vertex_costs_delta/" + name, [this, name, snapshot = std::move(snapshot)]() mutable {
+      return vertex_costs_delta_pub->publish(std::move(snapshot), name, global_frame, uuid_str);
+    });
+  }
+  else
+  {
+    background_pub->publish<mesh_msgs::MeshVertexCostsStamped>(
+        "vertex_costs/" + name, vertex_costs_pub, [this, name, snapshot = std::move(snapshot)]() mutable {
+          mesh_msgs::MeshVertexCostsStamped msg;
+          msg.header.frame_id = global_frame;
+          msg.header.stamp = ros::Time::now();
+          msg.uuid = uuid_str;
+          msg.type = name;
+          msg.mesh_vertex_costs.costs = std::move(snapshot);
+          return msg;
+        });
+  }
 }
 
 void MeshMap::publishVertexColors()
@@ -1227,6 +1976,16 @@ void MeshMap::publishVertexColors()
 void MeshMap::reconfigureCallback(mesh_map::MeshMapConfig& cfg, uint32_t level)
 {
   ROS_INFO_STREAM("Dynamic reconfigure callback...");
+  debug_marker_pub->setRate(cfg.debug_marker_rate);
+  debug_marker_pub->setEnabled(cfg.debug_markers);
+  vertex_costs_delta_pub->setKeyframeInterval(cfg.cost_keyframe_interval);
+  background_pub->setRate(cfg.publish_rate);
+  background_pub->setBandwidth(cfg.publish_bandwidth * 1e6);
+  vector_field_density = cfg.vector_field_density;
+  vector_field_radius = cfg.vector_field_radius;
+  publish_cost_deltas = cfg.publish_cost_deltas;
+  persist_layers = cfg.persist_layers;
+
   if (first_config)
   {
     config = cfg;
@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <lvr2/io/hdf5/MeshIO.hpp>
+#include <mesh_map/chunked_mesh_io.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+using HDF5MeshIO = lvr2::Hdf5IO<lvr2::hdf5features::ArrayIO, lvr2::hdf5features::ChannelIO,
+                                lvr2::hdf5features::VariantChannelIO, lvr2::hdf5features::MeshIO>;
+
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program
+            << " --map FILE --part NAME [--chunk-size SIZE] [--halo DISTANCE] [--channels NAME,NAME,...]" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::string map_file, mesh_part;
+  float chunk_size = 20.0;
+  float halo = 1.0;
+  std::vector<std::string> channels = { "face_normals", "vertex_normals" };
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    const std::string option = argv[i];
+    if (option == "--map")
+      map_file = argv[i + 1];
+    else if (option == "--part")
+      mesh_part = argv[i + 1];
+    else if (option == "--chunk-size")
+      chunk_size = std::atof(argv[i + 1]);
+    else if (option == "--halo")
+      halo = std::atof(argv[i + 1]);
+    else if (option == "--channels")
+    {
+      channels.clear();
+      std::string list = argv[i + 1];
+      for (size_t start = 0; start <= list.size();)
+      {
+        const size_t end = std::min(list.find(',', start), list.size());
+        if (end > start)
+          channels.push_back(list.substr(start, end - start));
+        start = end + 1;
+      }
+    }
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (map_file.empty() || mesh_part.empty())
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    HDF5MeshIO io;
+    io.open(map_file);
+    io.setMeshName(mesh_part);
+    if (!mesh_map::ChunkedMeshIO::partition(io, chunk_size, halo, channels))
+      return EXIT_FAILURE;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Could not partition the map file \"" << map_file << "\": " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
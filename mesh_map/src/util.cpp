@@ -35,6 +35,7 @@
  *
  */
 
+#include <cstring>
 #include <mesh_map/util.h>
 #include <std_msgs/ColorRGBA.h>
 #include <tf/transform_datatypes.h>
@@ -229,4 +230,38 @@ void getRainbowColor(float value, float& r, float& g, float& b)
     r = 1, g = n, b = 0;
 }
 
+Fingerprint& Fingerprint::mix(const uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    hash ^= (value >> (8 * i)) & 0xff;
+    hash *= 16777619u;
+  }
+  return *this;
+}
+
+Fingerprint& Fingerprint::mix(const float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return mix(bits);
+}
+
+Fingerprint& Fingerprint::mix(const double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return mix(static_cast<uint32_t>(bits)).mix(static_cast<uint32_t>(bits >> 32));
+}
+
+Fingerprint& Fingerprint::mix(const std::string& value)
+{
+  for (const char c : value)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  return mix(static_cast<uint32_t>(value.size()));
+}
+
 } /* namespace mesh_map */
@@ -0,0 +1,261 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <cmath>
+#include <lvr2/geometry/Handles.hpp>
+#include <mesh_map/vertex_costs_delta.h>
+
+namespace mesh_map
+{
+namespace
+{
+//! compares costs bitwise equal, thus unchanged NaN and infinite costs are not sent again
+inline bool sameCost(const float a, const float b)
+{
+  return a == b || (std::isnan(a) && std::isnan(b));
+}
+}  // namespace
+
+VertexCostsDeltaPublisher::VertexCostsDeltaPublisher(ros::NodeHandle& nh, const std::string& topic)
+  : keyframe_interval(10.0)
+{
+  pub = nh.advertise<mesh_map::VertexCostsDelta>(
+      topic, 10, boost::bind(&VertexCostsDeltaPublisher::connectCallback, this, _1), ros::SubscriberStatusCallback());
+}
+
+void VertexCostsDeltaPublisher::setKeyframeInterval(const double seconds)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  keyframe_interval = ros::WallDuration(seconds);
+}
+
+size_t VertexCostsDeltaPublisher::publish(const lvr2::VertexMap<float>& costs, const size_t num_vertices,
+                                          const float default_value, const std::string& name,
+                                          const std::string& frame_id, const std::string& uuid)
+{
+  std::vector<float> current(num_vertices);
+  for (size_t i = 0; i < num_vertices; i++)
+  {
+    const lvr2::VertexHandle vH(i);
+    current[i] = costs.containsKey(vH) ? costs[vH] : default_value;
+  }
+  return publish(std::move(current), name, frame_id, uuid);
+}
+
+size_t VertexCostsDeltaPublisher::publish(std::vector<float>&& costs, const std::string& name,
+                                          const std::string& frame_id, const std::string& uuid)
+{
+  std::vector<float> current(std::move(costs));
+  const size_t num_vertices = current.size();
+
+  size_t bytes = 0;
+  std::lock_guard<std::mutex> lock(mtx);
+  LayerState& state = layers[name];
+  const ros::WallTime now = ros::WallTime::now();
+  bool send_keyframe = state.costs.size() != num_vertices || state.uuid != uuid;
+
+  mesh_map::VertexCostsDelta msg;
+  if (!send_keyframe)
+  {
+    // collect the changed ranges, ranges separated by small gaps are merged
+    size_t i = 0;
+    while (i < num_vertices)
+    {
+      if (sameCost(current[i], state.costs[i]))
+      {
+        i++;
+        continue;
+      }
+      const size_t start = i;
+      size_t end = i + 1;
+      for (size_t j = end; j < num_vertices && j <= end + MERGE_GAP; j++)
+      {
+        if (!sameCost(current[j], state.costs[j]))
+          end = j + 1;
+      }
+      msg.range_starts.push_back(start);
+      msg.range_lengths.push_back(end - start);
+      msg.costs.insert(msg.costs.end(), current.begin() + start, current.begin() + end);
+      i = end;
+    }
+    // a keyframe is smaller if most of the costs changed
+    send_keyframe = msg.costs.size() + 2 * msg.range_starts.size() >= num_vertices;
+  }
+
+  state.costs.swap(current);
+  state.frame_id = frame_id;
+  state.uuid = uuid;
+
+  if (!send_keyframe && !msg.range_starts.empty())
+  {
+    msg.header.frame_id = frame_id;
+    msg.header.stamp = ros::Time::now();
+    msg.uuid = uuid;
+    msg.type = name;
+    msg.sequence = ++state.sequence;
+    msg.keyframe = false;
+    msg.num_vertices = num_vertices;
+    ROS_DEBUG_STREAM("Publish delta " << msg.sequence << " of layer \"" << name << "\" with " << msg.costs.size()
+                                      << " costs in " << msg.range_starts.size() << " ranges.");
+    pub.publish(msg);
+    bytes += ros::serialization::serializationLength(msg);
+  }
+
+  // the periodic keyframe follows the delta, thus receivers can validate their reassembled state against it
+  if (send_keyframe || (!keyframe_interval.isZero() && now - state.last_keyframe > keyframe_interval))
+  {
+    state.sequence++;
+    state.last_keyframe = now;
+    ROS_DEBUG_STREAM("Publish keyframe " << state.sequence << " of layer \"" << name << "\".");
+    const mesh_map::VertexCostsDelta keyframe_msg = keyframe(name, state);
+    pub.publish(keyframe_msg);
+    bytes += ros::serialization::serializationLength(keyframe_msg);
+  }
+  return bytes;
+}
+
+mesh_map::VertexCostsDelta VertexCostsDeltaPublisher::keyframe(const std::string& name, const LayerState& state)
+{
+  mesh_map::VertexCostsDelta msg;
+  msg.header.frame_id = state.frame_id;
+  msg.header.stamp = ros::Time::now();
+  msg.uuid = state.uuid;
+  msg.type = name;
+  msg.sequence = state.sequence;
+  msg.keyframe = true;
+  msg.num_vertices = state.costs.size();
+  msg.range_starts.push_back(0);
+  msg.range_lengths.push_back(state.costs.size());
+  msg.costs = state.costs;
+  return msg;
+}
+
+void VertexCostsDeltaPublisher::connectCallback(const ros::SingleSubscriberPublisher& subscriber)
+{
+  // the new subscriber receives the current state, the following deltas continue its sequence
+  std::lock_guard<std::mutex> lock(mtx);
+  for (const auto& layer : layers)
+  {
+    subscriber.publish(keyframe(layer.first, layer.second));
+  }
+}
+
+bool VertexCostsReassembler::apply(const mesh_map::VertexCostsDelta& msg)
+{
+  LayerState& state = layers[msg.type];
+  if (msg.range_starts.size() != msg.range_lengths.size())
+  {
+    state.synchronised = false;
+    return false;
+  }
+
+  if (msg.keyframe)
+  {
+    state.costs.assign(msg.num_vertices, 0);
+    state.synchronised = true;
+  }
+  else if (!state.synchronised || msg.sequence != state.sequence + 1 || msg.num_vertices != state.costs.size() ||
+           msg.uuid != state.uuid)
+  {
+    // the sequence continues only with the next keyframe
+    state.synchronised = false;
+    return false;
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < msg.range_starts.size(); i++)
+  {
+    const size_t start = msg.range_starts[i];
+    const size_t length = msg.range_lengths[i];
+    if (start + length > state.costs.size() || offset + length > msg.costs.size())
+    {
+      state.synchronised = false;
+      return false;
+    }
+    std::copy(msg.costs.begin() + offset, msg.costs.begin() + offset + length, state.costs.begin() + start);
+    offset += length;
+  }
+
+  state.sequence = msg.sequence;
+  state.header = msg.header;
+  state.uuid = msg.uuid;
+  return true;
+}
+
+bool VertexCostsReassembler::validate(const mesh_map::VertexCostsDelta& msg, size_t& mismatches) const
+{
+  auto iter = layers.find(msg.type);
+  if (!msg.keyframe || iter == layers.end() || !iter->second.synchronised ||
+      msg.costs.size() != iter->second.costs.size())
+    return false;
+
+  const std::vector<float>& costs = iter->second.costs;
+  mismatches = 0;
+  for (size_t i = 0; i < costs.size(); i++)
+  {
+    if (!sameCost(costs[i], msg.costs[i]))
+      mismatches++;
+  }
+  return true;
+}
+
+bool VertexCostsReassembler::synchronised(const std::string& name) const
+{
+  auto iter = layers.find(name);
+  return iter != layers.end() && iter->second.synchronised;
+}
+
+const std::vector<float>* VertexCostsReassembler::costs(const std::string& name) const
+{
+  auto iter = layers.find(name);
+  return iter != layers.end() && iter->second.synchronised ? &iter->second.costs : nullptr;
+}
+
+bool VertexCostsReassembler::toVertexCostsStamped(const std::string& name,
+                                                  mesh_msgs::MeshVertexCostsStamped& msg) const
+{
+  auto iter = layers.find(name);
+  if (iter == layers.end() || !iter->second.synchronised)
+    return false;
+  msg.header = iter->second.header;
+  msg.uuid = iter->second.uuid;
+  msg.type = name;
+  msg.mesh_vertex_costs.costs = iter->second.costs;
+  return true;
+}
+
+} /* namespace mesh_map */
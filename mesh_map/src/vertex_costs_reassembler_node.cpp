@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/vertex_costs_delta.h>
+#include <mesh_msgs/MeshVertexCostsStamped.h>
+#include <ros/ros.h>
+
+/**
+ * Reassembles the vertex cost layers published as deltas by the mesh map and republishes them as full
+ * mesh_msgs/MeshVertexCostsStamped messages, e.g. for RViz on a remote machine. Each keyframe is validated against
+ * the reassembled state before it is applied.
+ */
+
+namespace
+{
+mesh_map::VertexCostsReassembler reassembler;
+ros::Publisher vertex_costs_pub;
+
+void deltaCallback(const mesh_map::VertexCostsDelta::ConstPtr& msg)
+{
+  size_t mismatches = 0;
+  if (msg->keyframe && reassembler.validate(*msg, mismatches))
+  {
+    if (mismatches > 0)
+      ROS_ERROR_STREAM("The reassembled layer \"" << msg->type << "\" differs from keyframe " << msg->sequence << " in "
+                                                  << mismatches << " vertices!");
+    else
+      ROS_DEBUG_STREAM("The reassembled layer \"" << msg->type << "\" matches keyframe " << msg->sequence << ".");
+  }
+
+  if (!reassembler.apply(*msg))
+  {
+    ROS_WARN_STREAM_THROTTLE(1.0, "Missed a delta of the layer \"" << msg->type << "\" before " << msg->sequence
+                                                                   << ", waiting for the next keyframe.");
+    return;
+  }
+
+  mesh_msgs::MeshVertexCostsStamped costs_msg;
+  if (reassembler.toVertexCostsStamped(msg->type, costs_msg))
+    vertex_costs_pub.publish(costs_msg);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "vertex_costs_reassembler");
+  ros::NodeHandle nh;
+  vertex_costs_pub = nh.advertise<mesh_msgs::MeshVertexCostsStamped>("vertex_costs", 10);
+  ros::Subscriber delta_sub = nh.subscribe("vertex_costs_delta", 100, deltaCallback);
+  ros::spin();
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_NAVIGATION__WAVE_FRONT_PLANNER__CLUSTER_GRAPH_H
+#define MESH_NAVIGATION__WAVE_FRONT_PLANNER__CLUSTER_GRAPH_H
+
+#include <lvr2/attrmaps/AttrMaps.hpp>
+#include <lvr2/geometry/HalfEdgeMesh.hpp>
+#include <mesh_map/mesh_map.h>
+#include <vector>
+
+namespace wave_front_planner
+{
+/**
+ * @brief A coarse proxy graph of the mesh. Vertices are grouped into compact clusters by growing regions around
+ * greedily chosen seeds. Two clusters are connected if they share a mesh edge, the connection is weighted by the
+ * shortest seed to seed connection over such a shared edge. It is used to find a corridor of clusters in which the
+ * full resolution planning is done.
+ */
+class ClusterGraph
+{
+public:
+  //! marks vertices which do not belong to any cluster, e.g. lethal vertices
+  static constexpr uint32_t NO_CLUSTER = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Constructor, the graph is empty until build() has been called.
+   */
+  ClusterGraph();
+
+  /**
+   * @brief Clusters the mesh and computes the weighted cluster adjacency
+   * @param mesh The mesh to cluster
+   * @param edge_weights The edge weights, i.e. the costs to traverse the edges
+   * @param vertex_costs The combined vertex costs
+   * @param invalid The vertices which have been marked as invalid
+   * @param cost_limit Vertices with costs above the limit are not part of any cluster
+   * @param cluster_radius The maximum distance of a cluster vertex to its seed with respect to the edge weights
+   */
+  void build(const lvr2::HalfEdgeMesh<mesh_map::Vector>& mesh, const lvr2::DenseEdgeMap<float>& edge_weights,
+             const lvr2::DenseVertexMap<float>& vertex_costs, const lvr2::DenseVertexMap<bool>& invalid,
+             const float cost_limit, const float cluster_radius);
+
+  /**
+   * @brief Searches the shortest path in the cluster graph and marks all vertices of the path's clusters and their
+   * neighbouring clusters
+   * @param start A vertex of the start
+   * @param goal A vertex of the goal
+   * @param corridor The vertex map in which the corridor vertices are set to true, it has to be initialized
+   * @return true if a path between the clusters of the start and the goal exists
+   */
+  bool corridor(const lvr2::VertexHandle& start, const lvr2::VertexHandle& goal,
+                lvr2::DenseVertexMap<bool>& corridor) const;
+
+  /**
+   * @brief Returns the cluster of the given vertex or NO_CLUSTER
+   */
+  uint32_t clusterOf(const lvr2::VertexHandle& vH) const
+  {
+    const auto opt = cluster_of.get(vH);
+    return opt ? *opt : NO_CLUSTER;
+  }
+
+  /**
+   * @brief Returns true if the graph has been built for the given cost state and parameters
+   */
+  bool isValid(const uint64_t cost_version, const float cost_limit, const float cluster_radius) const
+  {
+    return built && cost_version == built_cost_version && cost_limit == built_cost_limit &&
+           cluster_radius == built_cluster_radius;
+  }
+
+  /**
+   * @brief Stores the parameters and the cost version the graph has been built for
+   */
+  void setBuildState(const uint64_t cost_version, const float cost_limit, const float cluster_radius);
+
+  /**
+   * @brief Returns the number of clusters
+   */
+  size_t numClusters() const
+  {
+    return members.size();
+  }
+
+private:
+  //! cluster index of each vertex
+  lvr2::DenseVertexMap<uint32_t> cluster_of;
+
+  //! the member vertices of each cluster, the first one is the seed
+  std::vector<std::vector<lvr2::VertexHandle>> members;
+
+  //! weighted adjacency of the clusters
+  std::vector<std::vector<std::pair<uint32_t, float>>> adjacency;
+
+  //! whether the graph has been built
+  bool built;
+
+  //! the cost version of the mesh map the graph has been built for
+  uint64_t built_cost_version;
+
+  //! the cost limit the graph has been built with
+  float built_cost_limit;
+
+  //! the cluster radius the graph has been built with
+  float built_cluster_radius;
+};
+
+}  // namespace wave_front_planner
+
+#endif  // MESH_NAVIGATION__WAVE_FRONT_PLANNER__CLUSTER_GRAPH_H
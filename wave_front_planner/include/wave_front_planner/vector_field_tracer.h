@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_NAVIGATION__WAVE_FRONT_PLANNER__VECTOR_FIELD_TRACER_H
+#define MESH_NAVIGATION__WAVE_FRONT_PLANNER__VECTOR_FIELD_TRACER_H
+
+#include <mesh_map/mesh_map.h>
+
+namespace wave_front_planner
+{
+/**
+ * @brief Lazily traces a path along a vector field on the mesh surface. Each call of next() yields the next path
+ * position, thus the first part of a path is available before the complete path has been traced.
+ */
+class VectorFieldTracer
+{
+public:
+  /**
+   * @brief Constructor
+   * @param mesh_map The mesh map to trace on
+   * @param vector_map The vector field to follow, it has to point towards the target
+   * @param start The position to start tracing at
+   * @param start_face The face containing the start position
+   * @param target The position the vector field points to
+   * @param target_face The face containing the target position
+   * @param step_width The step width on the mesh surface, with exact integration the maximum length of a segment
+   * within a face
+   * @param exact Yields a position at each edge crossing, i.e. the path consists of one segment per crossed face,
+   * instead of positions in fixed steps
+   */
+  VectorFieldTracer(const mesh_map::MeshMap::Ptr& mesh_map,
+                    const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map, const mesh_map::Vector& start,
+                    const lvr2::FaceHandle& start_face, const mesh_map::Vector& target,
+                    const lvr2::FaceHandle& target_face, const float step_width, const bool exact = false);
+
+  /**
+   * @brief Yields the next position of the path, starting with the start and ending with the target
+   * @param position The next position and its face
+   * @return false if the trace is finished, i.e. the target has been reached or the trace failed
+   */
+  bool next(std::pair<mesh_map::Vector, lvr2::FaceHandle>& position);
+
+  /**
+   * @brief Returns true if the trace could not be continued, e.g. if the vector field is not defined
+   */
+  bool failed() const
+  {
+    return state == FAILED;
+  }
+
+  /**
+   * @brief Returns the length which has been traced so far
+   */
+  float length() const
+  {
+    return traced_length;
+  }
+
+private:
+  enum State
+  {
+    START,
+    TRACING,
+    TARGET,
+    DONE,
+    FAILED
+  };
+
+  //! the mesh map to trace on
+  const mesh_map::MeshMap::Ptr mesh_map;
+
+  //! the vector field to follow
+  const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map;
+
+  //! the current position
+  mesh_map::Vector current_pos;
+
+  //! the face of the current position
+  lvr2::FaceHandle current_face;
+
+  //! the target position
+  const mesh_map::Vector target;
+
+  //! the face of the target position
+  const lvr2::FaceHandle target_face;
+
+  //! the step width on the mesh surface
+  const float step_width;
+
+  //! integrate face by face up to each edge crossing
+  const bool exact;
+
+  //! the state of the trace
+  State state;
+
+  //! the traced length
+  float traced_length;
+};
+
+}  // namespace wave_front_planner
+
+#endif  // MESH_NAVIGATION__WAVE_FRONT_PLANNER__VECTOR_FIELD_TRACER_H
@@ -42,7 +42,10 @@
 #include <mbf_msgs/GetPathResult.h>
 #include <mesh_map/mesh_map.h>
 #include <wave_front_planner/WaveFrontPlannerConfig.h>
+#include <wave_front_planner/cluster_graph.h>
+#include <wave_front_planner/vector_field_tracer.h>
 #include <nav_msgs/Path.h>
+#include <mutex>
 
 namespace wave_front_planner
 {
@@ -51,6 +54,9 @@ class WaveFrontPlanner : public mbf_mesh_core::MeshPlanner
 public:
   typedef boost::shared_ptr<wave_front_planner::WaveFrontPlanner> Ptr;
 
+  //! contiguous sequence of path positions and their faces
+  typedef std::vector<std::pair<mesh_map::Vector, lvr2::FaceHandle>> Path;
+
   /**
    * @brief Constructor
    */
@@ -75,6 +81,24 @@ public:
                             double tolerance, std::vector<geometry_msgs::PoseStamped>& plan, double& cost,
                             std::string& message);
 
+  /**
+   * @brief Computes geodesic paths from the start to multiple goals within a single wave front propagation.
+   * The wave is seeded at the start and stops once all goal faces are fixed. The stored vector field of the
+   * mesh map is not touched.
+   * @param start The start pose, i.e. the robot's pose
+   * @param goals The goal poses
+   * @param tolerance The goal tolerance, TODO is currently not used
+   * @param plans The computed plans, one for each goal
+   * @param costs The computed costs for the plans, one for each goal
+   * @param outcomes The result outcome codes for each goal, see the GetPath action definition
+   * @param message a detailed outcome message
+   * @return SUCCESS if at least one of the goals has been reached, otherwise an error outcome code
+   */
+  virtual uint32_t makePlans(const geometry_msgs::PoseStamped& start,
+                             const std::vector<geometry_msgs::PoseStamped>& goals, double tolerance,
+                             std::vector<std::vector<geometry_msgs::PoseStamped>>& plans, std::vector<double>& costs,
+                             std::vector<uint32_t>& outcomes, std::string& message);
+
   /**
    * @brief Requests the planner to cancel, e.g. if it takes too much time.
    * @return true if cancel has been successfully requested, false otherwise
@@ -95,11 +119,10 @@ protected:
    * @brief Computes a wavefront propagation from the start until it reached the goal
    * @param start The seed of the wave, i.e. the robot's goal pose
    * @param goal The goal of the wavefront, where it will stop propagating
-   * @param path The backtracked path
+   * @param path The backtracked path, ordered from the goal of the wavefront to its seed
    * @return a ExePath action related outcome code
    */
-  uint32_t waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal,
-                                std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path);
+  uint32_t waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal, Path& path);
 
   /**
    *
@@ -108,17 +131,56 @@ protected:
    * @param goal The goal of the wavefront, where it will stop propagating
    * @param edge_weights The edge weights map to use for vertex distances in a triangle
    * @param costs The combined vertex costs to use during the propagation
-   * @param path The backtracked path
+   * @param path The backtracked path, ordered from the goal of the wavefront to its seed
    * @param distances The computed distances
    * @param predecessors The backtracked predecessors
    * @return a ExePath action related outcome code
    */
   uint32_t waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal,
                                 const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::DenseVertexMap<float>& costs,
-                                std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path,
+                                Path& path, lvr2::DenseVertexMap<float>& distances,
+                                lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors);
+
+  /**
+   * @brief Plans on the coarse cluster graph first and restricts the wavefront propagation to the corridor of the
+   * selected clusters. Falls back to the full resolution propagation if no path has been found within the corridor.
+   * The cluster graph is (re-)built if the mesh map costs or the cluster parameters have changed.
+   * @param start The seed of the wave
+   * @param goal The goal of the wavefront
+   * @param path The resulting backtracked path, ordered from the goal of the wavefront to its seed
+   * @return a GetPath action related outcome code
+   */
+  uint32_t hierarchicalWaveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal, Path& path);
+
+  /**
+   * @brief Computes a wavefront propagation from the start until it reached all goals
+   * @param start The seed of the wave
+   * @param goals The goals of the wavefront, it will stop propagating if all of them have been reached
+   * @param edge_weights The edge weights map to use for vertex distances in a triangle
+   * @param costs The combined vertex costs to use during the propagation
+   * @param paths The backtracked paths, one for each goal, each ordered from the goal to the seed
+   * @param outcomes The GetPath action related outcome codes, one for each goal
+   * @param distances The computed distances
+   * @param predecessors The backtracked predecessors
+   * @return a GetPath action related outcome code, SUCCESS if at least one goal has been reached
+   */
+  uint32_t waveFrontPropagation(const mesh_map::Vector& start, const std::vector<mesh_map::Vector>& goals,
+                                const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::DenseVertexMap<float>& costs,
+                                std::vector<Path>& paths, std::vector<uint32_t>& outcomes,
                                 lvr2::DenseVertexMap<float>& distances,
                                 lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors);
 
+  /**
+   * @brief Converts a backtracked path into a plan of poses
+   * @param path The backtracked path, ordered from the first to the last position
+   * @param goal The goal position the last pose points to
+   * @param header The header to use for all poses
+   * @param plan The plan to be filled
+   * @param cost The length of the plan
+   */
+  void pathToPlan(const Path& path, const mesh_map::Vector& goal, const std_msgs::Header& header,
+                  std::vector<geometry_msgs::PoseStamped>& plan, double& cost);
+
   /**
    * Fast Marching Method update step using the Hesse normal form to determine if the direction vector is cutting the current triangle
    * @param distances Distance map to the goal which stores the current state of all distances to the goal
@@ -146,7 +208,8 @@ protected:
                               const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2, const lvr2::VertexHandle& v3);
 
   /**
-   * @brief Computes the vector field in a post processing. It rotates the predecessor edges by the stored angles
+   * @brief Computes the vector field in a post processing. It rotates the predecessor edges by the stored angles.
+   * The vector field is stored in the planner and not shared with the mesh map.
    */
   void computeVectorMap();
 
@@ -169,6 +232,9 @@ private:
   //! flag if cancel has been requested
   std::atomic_bool cancel_planning;
 
+  //! mutex to serialize planning requests, e.g. from the action server and the multi goal service
+  std::mutex planning_mtx;
+
   //! publisher for the backtracked path
   ros::Publisher path_pub;
 
@@ -210,6 +276,15 @@ private:
 
   //! potential field / scalar distance field to the seed
   lvr2::DenseVertexMap<float> potential;
+
+  //! coarse cluster graph for the hierarchical planning, cached until the mesh map costs change
+  ClusterGraph cluster_graph;
+
+  //! vertices the wavefront propagation is restricted to, if restrict_to_corridor is set
+  lvr2::DenseVertexMap<bool> corridor;
+
+  //! whether to restrict the wavefront propagation to the corridor
+  bool restrict_to_corridor;
 };
 
 }  // namespace wave_front_planner
@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <queue>
+#include <unordered_map>
+
+#include "wave_front_planner/cluster_graph.h"
+
+namespace wave_front_planner
+{
+constexpr uint32_t ClusterGraph::NO_CLUSTER;
+
+ClusterGraph::ClusterGraph()
+  : built(false), built_cost_version(0), built_cost_limit(0), built_cluster_radius(0)
+{
+}
+
+void ClusterGraph::setBuildState(const uint64_t cost_version, const float cost_limit, const float cluster_radius)
+{
+  built = true;
+  built_cost_version = cost_version;
+  built_cost_limit = cost_limit;
+  built_cluster_radius = cluster_radius;
+}
+
+void ClusterGraph::build(const lvr2::HalfEdgeMesh<mesh_map::Vector>& mesh,
+                         const lvr2::DenseEdgeMap<float>& edge_weights,
+                         const lvr2::DenseVertexMap<float>& vertex_costs, const lvr2::DenseVertexMap<bool>& invalid,
+                         const float cost_limit, const float cluster_radius)
+{
+  built = false;
+  members.clear();
+  adjacency.clear();
+  cluster_of = lvr2::DenseVertexMap<uint32_t>(mesh.nextVertexIndex(), NO_CLUSTER);
+
+  // distance of each clustered vertex to the seed of its cluster
+  lvr2::DenseVertexMap<float> seed_dist(mesh.nextVertexIndex(), std::numeric_limits<float>::infinity());
+
+  auto passable = [&](const lvr2::VertexHandle& vH) {
+    return !invalid[vH] && std::isfinite(vertex_costs[vH]) && vertex_costs[vH] <= cost_limit;
+  };
+
+  typedef std::pair<float, lvr2::Index> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> pq;
+  std::vector<lvr2::EdgeHandle> edges;
+
+  for (auto seed : mesh.vertices())
+  {
+    if (cluster_of[seed] != NO_CLUSTER || !passable(seed))
+      continue;
+
+    const uint32_t cluster = members.size();
+    members.emplace_back();
+
+    // grow the cluster over the unclustered vertices within the cluster radius
+    seed_dist[seed] = 0;
+    pq.emplace(0, seed.idx());
+    while (!pq.empty())
+    {
+      const QueueEntry top = pq.top();
+      pq.pop();
+      const lvr2::VertexHandle vH(top.second);
+      if (cluster_of[vH] != NO_CLUSTER || top.first > seed_dist[vH])
+        continue;
+
+      cluster_of[vH] = cluster;
+      members[cluster].push_back(vH);
+
+      edges.clear();
+      try
+      {
+        mesh.getEdgesOfVertex(vH, edges);
+      }
+      catch (lvr2::PanicException exception)
+      {
+        continue;
+      }
+      catch (lvr2::VertexLoopException exception)
+      {
+        continue;
+      }
+
+      for (auto eH : edges)
+      {
+        const auto vertices = mesh.getVerticesOfEdge(eH);
+        const lvr2::VertexHandle& nH = vertices[0] == vH ? vertices[1] : vertices[0];
+        if (cluster_of[nH] != NO_CLUSTER || !passable(nH))
+          continue;
+
+        const float dist = top.first + edge_weights[eH];
+        if (dist <= cluster_radius && dist < seed_dist[nH])
+        {
+          seed_dist[nH] = dist;
+          pq.emplace(dist, nH.idx());
+        }
+      }
+    }
+  }
+
+  // connect clusters sharing an edge by the shortest seed to seed connection over such an edge
+  std::vector<std::unordered_map<uint32_t, float>> cluster_edges(members.size());
+  for (auto eH : mesh.edges())
+  {
+    const auto vertices = mesh.getVerticesOfEdge(eH);
+    const uint32_t c0 = cluster_of[vertices[0]];
+    const uint32_t c1 = cluster_of[vertices[1]];
+    if (c0 == NO_CLUSTER || c1 == NO_CLUSTER || c0 == c1)
+      continue;
+
+    const float weight = seed_dist[vertices[0]] + edge_weights[eH] + seed_dist[vertices[1]];
+    auto iter = cluster_edges[c0].find(c1);
+    if (iter == cluster_edges[c0].end() || weight < iter->second)
+    {
+      cluster_edges[c0][c1] = weight;
+      cluster_edges[c1][c0] = weight;
+    }
+  }
+
+  adjacency.resize(members.size());
+  for (size_t i = 0; i < cluster_edges.size(); i++)
+  {
+    adjacency[i].assign(cluster_edges[i].begin(), cluster_edges[i].end());
+  }
+}
+
+bool ClusterGraph::corridor(const lvr2::VertexHandle& start, const lvr2::VertexHandle& goal,
+                            lvr2::DenseVertexMap<bool>& corridor) const
+{
+  const uint32_t start_cluster = clusterOf(start);
+  const uint32_t goal_cluster = clusterOf(goal);
+  if (start_cluster == NO_CLUSTER || goal_cluster == NO_CLUSTER)
+    return false;
+
+  // Dijkstra on the cluster graph
+  std::vector<float> distances(members.size(), std::numeric_limits<float>::infinity());
+  std::vector<uint32_t> predecessors(members.size(), NO_CLUSTER);
+
+  typedef std::pair<float, uint32_t> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> pq;
+  distances[start_cluster] = 0;
+  pq.emplace(0, start_cluster);
+  while (!pq.empty())
+  {
+    const QueueEntry top = pq.top();
+    pq.pop();
+    if (top.first > distances[top.second])
+      continue;
+    if (top.second == goal_cluster)
+      break;
+
+    for (const auto& neighbour : adjacency[top.second])
+    {
+      const float dist = top.first + neighbour.second;
+      if (dist < distances[neighbour.first])
+      {
+        distances[neighbour.first] = dist;
+        predecessors[neighbour.first] = top.second;
+        pq.emplace(dist, neighbour.first);
+      }
+    }
+  }
+
+  if (!std::isfinite(distances[goal_cluster]))
+    return false;
+
+  // the corridor consists of the path clusters and their direct neighbours
+  std::vector<bool> in_corridor(members.size(), false);
+  for (uint32_t cluster = goal_cluster; cluster != NO_CLUSTER; cluster = predecessors[cluster])
+  {
+    in_corridor[cluster] = true;
+    for (const auto& neighbour : adjacency[cluster])
+    {
+      in_corridor[neighbour.first] = true;
+    }
+  }
+
+  for (size_t cluster = 0; cluster < members.size(); cluster++)
+  {
+    if (!in_corridor[cluster])
+      continue;
+    for (const auto& vH : members[cluster])
+    {
+      corridor[vH] = true;
+    }
+  }
+  return true;
+}
+
+}  // namespace wave_front_planner
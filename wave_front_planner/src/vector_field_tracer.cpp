@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "wave_front_planner/vector_field_tracer.h"
+
+namespace wave_front_planner
+{
+VectorFieldTracer::VectorFieldTracer(const mesh_map::MeshMap::Ptr& mesh_map,
+                                     const lvr2::DenseVertexMap<mesh_map::Vector>& vector_map,
+                                     const mesh_map::Vector& start, const lvr2::FaceHandle& start_face,
+                                     const mesh_map::Vector& target, const lvr2::FaceHandle& target_face,
+                                     const float step_width, const bool exact)
+  : mesh_map(mesh_map)
+  , vector_map(vector_map)
+  , current_pos(start)
+  , current_face(start_face)
+  , target(target)
+  , target_face(target_face)
+  , step_width(step_width)
+  , exact(exact)
+  , state(START)
+  , traced_length(0)
+{
+}
+
+bool VectorFieldTracer::next(std::pair<mesh_map::Vector, lvr2::FaceHandle>& position)
+{
+  switch (state)
+  {
+    case START:
+      state = TRACING;
+      position = std::make_pair(current_pos, current_face);
+      return true;
+
+    case TRACING:
+      // move the current position ahead on the surface following the vector field,
+      // updates the current face if necessary
+      if (current_pos.distance2(target) > step_width)
+      {
+        try
+        {
+          const mesh_map::Vector last_pos = current_pos;
+          // the exact integration stops at each edge crossing, thus it yields one straight segment per crossed face
+          const bool moved = exact ? mesh_map->meshAheadExact(current_pos, current_face, step_width, vector_map) :
+                                     mesh_map->meshAhead(current_pos, current_face, step_width, vector_map);
+          if (!moved)
+          {
+            ROS_WARN_STREAM("Could not find a valid path, while back-tracking along the vector field");
+            state = FAILED;
+            return false;
+          }
+          traced_length += current_pos.distance(last_pos);
+        }
+        catch (lvr2::PanicException exception)
+        {
+          ROS_ERROR_STREAM("Could not find a valid path, while back-tracking along the vector field: "
+                           "HalfEdgeMesh panicked!");
+          state = FAILED;
+          return false;
+        }
+        position = std::make_pair(current_pos, current_face);
+        return true;
+      }
+      // the target is within reach
+      state = TARGET;
+      // fall through
+
+    case TARGET:
+      state = DONE;
+      traced_length += current_pos.distance(target);
+      position = std::make_pair(target, target_face);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+}  // namespace wave_front_planner
@@ -43,6 +43,7 @@
 #include <pluginlib/class_list_macros.h>
 
 #include "wave_front_planner/wave_front_planner.h"
+#include <algorithm>
 //#define DEBUG
 //#define USE_UPDATE_WITH_S
 
@@ -50,7 +51,7 @@ PLUGINLIB_EXPORT_CLASS(wave_front_planner::WaveFrontPlanner, mbf_mesh_core::Mesh
 
 namespace wave_front_planner
 {
-WaveFrontPlanner::WaveFrontPlanner()
+WaveFrontPlanner::WaveFrontPlanner() : restrict_to_corridor(false)
 {
 }
 
@@ -62,8 +63,8 @@ uint32_t WaveFrontPlanner::makePlan(const geometry_msgs::PoseStamped& start, con
                                     double tolerance, std::vector<geometry_msgs::PoseStamped>& plan, double& cost,
                                     std::string& message)
 {
-  const auto& mesh = mesh_map->mesh();
-  std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>> path;
+  std::lock_guard<std::mutex> lock(planning_mtx);
+  Path path;
 
   // mesh_map->combineVertexCosts(); // TODO should be outside the planner
 
@@ -72,40 +73,21 @@ uint32_t WaveFrontPlanner::makePlan(const geometry_msgs::PoseStamped& start, con
   mesh_map::Vector goal_vec = mesh_map::toVector(goal.pose.position);
   mesh_map::Vector start_vec = mesh_map::toVector(start.pose.position);
 
-  uint32_t outcome = waveFrontPropagation(goal_vec, start_vec, path);
-
-  path.reverse();
+  uint32_t outcome;
+  if (config.hierarchical && goal_vec.distance(start_vec) > config.hierarchical_min_distance)
+  {
+    outcome = hierarchicalWaveFrontPropagation(goal_vec, start_vec, path);
+  }
+  else
+  {
+    outcome = waveFrontPropagation(goal_vec, start_vec, path);
+  }
 
   std_msgs::Header header;
   header.stamp = ros::Time::now();
   header.frame_id = mesh_map->mapFrame();
 
-  cost = 0;
-  float dir_length;
-  if (!path.empty())
-  {
-    mesh_map::Vector vec = path.front().first;
-    lvr2::FaceHandle fH = path.front().second;
-    path.pop_front();
-
-    const auto& face_normals = mesh_map->faceNormals();
-    for (auto& next : path)
-    {
-      geometry_msgs::PoseStamped pose;
-      pose.header = header;
-      pose.pose = mesh_map::calculatePoseFromPosition(vec, next.first, face_normals[fH], dir_length);
-      cost += dir_length;
-      vec = next.first;
-      fH = next.second;
-      plan.push_back(pose);
-    }
-
-    geometry_msgs::PoseStamped pose;
-    pose.header = header;
-    pose.pose = mesh_map::calculatePoseFromPosition(vec, goal_vec, face_normals[fH], dir_length);
-    cost += dir_length;
-    plan.push_back(pose);
-  }
+  pathToPlan(path, goal_vec, header, plan, cost);
 
   nav_msgs::Path path_msg;
   path_msg.poses = plan;
@@ -123,6 +105,84 @@ uint32_t WaveFrontPlanner::makePlan(const geometry_msgs::PoseStamped& start, con
   return outcome;
 }
 
+uint32_t WaveFrontPlanner::makePlans(const geometry_msgs::PoseStamped& start,
+                                     const std::vector<geometry_msgs::PoseStamped>& goals, double tolerance,
+                                     std::vector<std::vector<geometry_msgs::PoseStamped>>& plans,
+                                     std::vector<double>& costs, std::vector<uint32_t>& outcomes, std::string& message)
+{
+  std::lock_guard<std::mutex> lock(planning_mtx);
+  std::vector<Path> paths;
+
+  ROS_INFO_STREAM("start wave front propagation for " << goals.size() << " goals.");
+
+  mesh_map::Vector start_vec = mesh_map::toVector(start.pose.position);
+  std::vector<mesh_map::Vector> goal_vecs;
+  goal_vecs.reserve(goals.size());
+  for (const auto& goal : goals)
+  {
+    goal_vecs.push_back(mesh_map::toVector(goal.pose.position));
+  }
+
+  // the wave is seeded at the robot, thus the backtracked paths have to be reversed
+  uint32_t outcome = waveFrontPropagation(start_vec, goal_vecs, mesh_map->edgeDistances(), mesh_map->vertexCosts(),
+                                          paths, outcomes, potential, predecessors);
+
+  std_msgs::Header header;
+  header.stamp = ros::Time::now();
+  header.frame_id = mesh_map->mapFrame();
+
+  plans.assign(goals.size(), std::vector<geometry_msgs::PoseStamped>());
+  costs.assign(goals.size(), 0);
+  for (size_t i = 0; i < goals.size(); i++)
+  {
+    if (outcomes[i] == mbf_msgs::GetPathResult::SUCCESS)
+    {
+      std::reverse(paths[i].begin(), paths[i].end());
+      pathToPlan(paths[i], goal_vecs[i], header, plans[i], costs[i]);
+      ROS_INFO_STREAM("Path length to goal " << i << ": " << costs[i] << "m");
+    }
+  }
+
+  if (publish_vector_field)
+  {
+    mesh_map->publishVectorField("vector_field", vector_map, publish_face_vectors);
+  }
+
+  return outcome;
+}
+
+void WaveFrontPlanner::pathToPlan(const Path& path, const mesh_map::Vector& goal, const std_msgs::Header& header,
+                                  std::vector<geometry_msgs::PoseStamped>& plan, double& cost)
+{
+  cost = 0;
+  float dir_length;
+  if (path.empty())
+    return;
+
+  plan.reserve(plan.size() + path.size());
+  const auto& face_normals = mesh_map->faceNormals();
+  auto iter = path.begin();
+  mesh_map::Vector vec = iter->first;
+  lvr2::FaceHandle fH = iter->second;
+
+  for (++iter; iter != path.end(); ++iter)
+  {
+    geometry_msgs::PoseStamped pose;
+    pose.header = header;
+    pose.pose = mesh_map::calculatePoseFromPosition(vec, iter->first, face_normals[fH], dir_length);
+    cost += dir_length;
+    vec = iter->first;
+    fH = iter->second;
+    plan.push_back(pose);
+  }
+
+  geometry_msgs::PoseStamped pose;
+  pose.header = header;
+  pose.pose = mesh_map::calculatePoseFromPosition(vec, goal, face_normals[fH], dir_length);
+  cost += dir_length;
+  plan.push_back(pose);
+}
+
 bool WaveFrontPlanner::cancel()
 {
   cancel_planning = true;
@@ -201,16 +261,80 @@ void WaveFrontPlanner::computeVectorMap()
     // store the normalized rotated vector in the vector map
     vector_map.insert(v3, dirVec.normalized());
   }
-  mesh_map->setVectorMap(vector_map);
 }
 
 uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal,
-                                                std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path)
+                                                Path& path)
 {
   return waveFrontPropagation(start, goal, mesh_map->edgeDistances(), mesh_map->vertexCosts(), path, potential,
                               predecessors);
 }
 
+uint32_t WaveFrontPlanner::hierarchicalWaveFrontPropagation(const mesh_map::Vector& start,
+                                                            const mesh_map::Vector& goal, Path& path)
+{
+  const auto& mesh = mesh_map->mesh();
+
+  const uint64_t cost_version = mesh_map->costVersion();
+  if (!cluster_graph.isValid(cost_version, config.cost_limit, config.cluster_radius))
+  {
+    ros::WallTime t_build_start = ros::WallTime::now();
+    cluster_graph.build(mesh, mesh_map->edgeWeights(), mesh_map->vertexCosts(), mesh_map->invalid,
+                        config.cost_limit, config.cluster_radius);
+    cluster_graph.setBuildState(cost_version, config.cost_limit, config.cluster_radius);
+    ROS_INFO_STREAM("Built the cluster graph with " << cluster_graph.numClusters() << " clusters in "
+                                                    << (ros::WallTime::now() - t_build_start).toNSec() * 1e-6
+                                                    << " ms.");
+  }
+
+  mesh_map::Vector start_pos = start;
+  mesh_map::Vector goal_pos = goal;
+  const auto& start_opt = mesh_map->getContainingFace(start_pos, 0.4);
+  const auto& goal_opt = mesh_map->getContainingFace(goal_pos, 0.4);
+
+  // the full resolution propagation reports invalid starts and goals
+  if (!start_opt || !goal_opt)
+    return waveFrontPropagation(start, goal, path);
+
+  const auto start_vertices = mesh.getVerticesOfFace(start_opt.unwrap());
+  const auto goal_vertices = mesh.getVerticesOfFace(goal_opt.unwrap());
+
+  auto clusteredVertex = [this](const std::array<lvr2::VertexHandle, 3>& vertices) {
+    for (const auto& vH : vertices)
+    {
+      if (cluster_graph.clusterOf(vH) != ClusterGraph::NO_CLUSTER)
+        return lvr2::OptionalVertexHandle(vH);
+    }
+    return lvr2::OptionalVertexHandle();
+  };
+
+  const auto start_vertex = clusteredVertex(start_vertices);
+  const auto goal_vertex = clusteredVertex(goal_vertices);
+
+  corridor = lvr2::DenseVertexMap<bool>(mesh.nextVertexIndex(), false);
+  if (!start_vertex || !goal_vertex || !cluster_graph.corridor(start_vertex.unwrap(), goal_vertex.unwrap(), corridor))
+  {
+    ROS_WARN_STREAM("No path found in the cluster graph, using the full resolution wave front propagation.");
+    return waveFrontPropagation(start, goal, path);
+  }
+
+  for (const auto& vH : start_vertices)
+    corridor[vH] = true;
+  for (const auto& vH : goal_vertices)
+    corridor[vH] = true;
+
+  restrict_to_corridor = true;
+  uint32_t outcome = waveFrontPropagation(start, goal, path);
+  restrict_to_corridor = false;
+
+  if (outcome == mbf_msgs::GetPathResult::NO_PATH_FOUND)
+  {
+    ROS_WARN_STREAM("No path found within the corridor, using the full resolution wave front propagation.");
+    outcome = waveFrontPropagation(start, goal, path);
+  }
+  return outcome;
+}
+
 inline bool WaveFrontPlanner::waveFrontUpdateWithS(lvr2::DenseVertexMap<float>& distances,
                                                    const lvr2::DenseEdgeMap<float>& edge_weights,
                                                    const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
@@ -524,25 +648,48 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
                                                 const mesh_map::Vector& original_goal,
                                                 const lvr2::DenseEdgeMap<float>& edge_weights,
                                                 const lvr2::DenseVertexMap<float>& costs,
-                                                std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path,
-                                                lvr2::DenseVertexMap<float>& distances,
+                                                Path& path, lvr2::DenseVertexMap<float>& distances,
                                                 lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors)
+{
+  std::vector<Path> paths;
+  std::vector<uint32_t> outcomes;
+
+  const uint32_t outcome = waveFrontPropagation(original_start, { original_goal }, edge_weights, costs, paths,
+                                                outcomes, distances, predecessors);
+  path.clear();
+  if (!paths.empty())
+  {
+    path.swap(paths.front());
+  }
+
+  // share the vector field with the controller
+  if (outcome == mbf_msgs::GetPathResult::SUCCESS || outcome == mbf_msgs::GetPathResult::NO_PATH_FOUND)
+  {
+    mesh_map->setVectorMap(vector_map);
+  }
+  return outcome;
+}
+
+uint32_t WaveFrontPlanner::waveFrontPropagation(
+    const mesh_map::Vector& original_start, const std::vector<mesh_map::Vector>& original_goals,
+    const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::DenseVertexMap<float>& costs,
+    std::vector<Path>& paths, std::vector<uint32_t>& outcomes,
+    lvr2::DenseVertexMap<float>& distances, lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors)
 {
   ROS_DEBUG_STREAM("Init wave front propagation.");
 
   const auto& mesh = mesh_map->mesh();
-  const auto& vertex_costs = mesh_map->vertexCosts();
   auto& invalid = mesh_map->invalid;
 
+  paths.assign(original_goals.size(), Path());
+  outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::NO_PATH_FOUND);
+
   mesh_map->publishDebugPoint(original_start, mesh_map::color(0, 1, 0), "start_point");
-  mesh_map->publishDebugPoint(original_goal, mesh_map::color(0, 0, 1), "goal_point");
 
-  mesh_map::Vector start = original_start;
-  mesh_map::Vector goal = original_goal;
+  const mesh_map::Vector start = original_start;
 
-  // Find the containing faces of start and goal
+  // Find the containing face of the start
   const auto& start_opt = mesh_map->getContainingFace(start, 0.4);
-  const auto& goal_opt = mesh_map->getContainingFace(goal, 0.4);
 
   ros::WallTime t_initialization_start = ros::WallTime::now();
 
@@ -550,23 +697,68 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
   cancel_planning = false;
 
   if (!start_opt)
+  {
+    outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::INVALID_START);
     return mbf_msgs::GetPathResult::INVALID_START;
-  if (!goal_opt)
+  }
+  if (original_goals.empty())
     return mbf_msgs::GetPathResult::INVALID_GOAL;
 
   const auto& start_face = start_opt.unwrap();
-  const auto& goal_face = goal_opt.unwrap();
-
   mesh_map->publishDebugFace(start_face, mesh_map::color(0, 0, 1), "start_face");
-  mesh_map->publishDebugFace(goal_face, mesh_map::color(0, 1, 0), "goal_face");
 
-  path.clear();
   distances.clear();
   predecessors.clear();
 
-  if (goal_face == start_face)
+  // Find the containing faces of the goals, the goals which are left have to be reached by the wave
+  std::vector<lvr2::FaceHandle> goal_faces(original_goals.size(), start_face);
+  std::vector<size_t> open_goals;
+  lvr2::DenseVertexMap<bool> goal_vertex(mesh.nextVertexIndex(), false);
+  for (size_t i = 0; i < original_goals.size(); i++)
+  {
+    const auto& goal_opt = mesh_map->getContainingFace(original_goals[i], 0.4);
+    if (!goal_opt)
+    {
+      outcomes[i] = mbf_msgs::GetPathResult::INVALID_GOAL;
+      continue;
+    }
+    goal_faces[i] = goal_opt.unwrap();
+    if (goal_faces[i] == start_face)
+    {
+      outcomes[i] = mbf_msgs::GetPathResult::SUCCESS;
+      continue;
+    }
+
+    const auto& goal = original_goals[i];
+    std::array<lvr2::VertexHandle, 3> goal_vertices = mesh.getVerticesOfFace(goal_faces[i]);
+    ROS_DEBUG_STREAM("The goal " << i << " is at (" << goal.x << ", " << goal.y << ", " << goal.z << ") at the face ("
+                                 << goal_vertices[0] << ", " << goal_vertices[1] << ", " << goal_vertices[2] << ")");
+    if (mesh_map->debugEnabled())
+    {
+      mesh_map->publishDebugPoint(goal, mesh_map::color(0, 0, 1), "goal_point_" + std::to_string(i));
+      mesh_map->publishDebugFace(goal_faces[i], mesh_map::color(0, 1, 0), "goal_face_" + std::to_string(i));
+    }
+    for (auto vH : goal_vertices)
+    {
+      goal_vertex[vH] = true;
+    }
+    open_goals.push_back(i);
+  }
+
+  auto aggregatedOutcome = [&outcomes]() {
+    uint32_t outcome = mbf_msgs::GetPathResult::NO_PATH_FOUND;
+    for (auto goal_outcome : outcomes)
+    {
+      if (goal_outcome == mbf_msgs::GetPathResult::SUCCESS)
+        return goal_outcome;
+      outcome = goal_outcome;
+    }
+    return outcome;
+  };
+
+  if (open_goals.empty())
   {
-    return mbf_msgs::GetPathResult::SUCCESS;
+    return aggregatedOutcome();
   }
 
   lvr2::DenseVertexMap<bool> fixed(mesh.nextVertexIndex(), false);
@@ -596,15 +788,9 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
     pq.insert(vH, dist);
   }
 
-  std::array<lvr2::VertexHandle, 3> goal_vertices = mesh.getVerticesOfFace(goal_face);
-  ROS_DEBUG_STREAM("The goal is at (" << goal.x << ", " << goal.y << ", " << goal.z << ") at the face ("
-                                     << goal_vertices[0] << ", " << goal_vertices[1] << ", " << goal_vertices[2]
-                                     << ")");
-  mesh_map->publishDebugPoint(mesh.getVertexPosition(goal_vertices[0]), mesh_map::color(0, 0, 1), "goal_face_v1");
-  mesh_map->publishDebugPoint(mesh.getVertexPosition(goal_vertices[1]), mesh_map::color(0, 0, 1), "goal_face_v2");
-  mesh_map->publishDebugPoint(mesh.getVertexPosition(goal_vertices[2]), mesh_map::color(0, 0, 1), "goal_face_v3");
-
   float goal_dist = std::numeric_limits<float>::infinity();
+  std::vector<bool> goal_reached(original_goals.size(), false);
+  size_t reached_cnt = 0;
 
   ROS_DEBUG_STREAM("Start wavefront propagation...");
 
@@ -623,18 +809,29 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
     if (distances[current_vh] > goal_dist)
       continue;
 
-    if (vertex_costs[current_vh] > config.cost_limit)
+    if (costs[current_vh] > config.cost_limit)
       continue;
 
     if (invalid[current_vh])
       continue;
 
-    if (current_vh == goal_vertices[0] || current_vh == goal_vertices[1] || current_vh == goal_vertices[2])
+    if (goal_vertex[current_vh] && goal_dist == std::numeric_limits<float>::infinity())
     {
-      if (goal_dist == std::numeric_limits<float>::infinity() && fixed[goal_vertices[0]] && fixed[goal_vertices[1]] &&
-          fixed[goal_vertices[2]])
+      for (size_t i : open_goals)
+      {
+        if (goal_reached[i])
+          continue;
+        const auto goal_vertices = mesh.getVerticesOfFace(goal_faces[i]);
+        if (fixed[goal_vertices[0]] && fixed[goal_vertices[1]] && fixed[goal_vertices[2]])
+        {
+          goal_reached[i] = true;
+          reached_cnt++;
+        }
+      }
+      // the wave front stops as soon as the last goal face has been reached
+      if (reached_cnt == open_goals.size())
       {
-        ROS_DEBUG_STREAM("Wave front reached the goal!");
+        ROS_DEBUG_STREAM("Wave front reached all goals!");
         goal_dist = distances[current_vh] + goal_dist_offset;
       }
     }
@@ -654,6 +851,9 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
         if (invalid[a] || invalid[b] || invalid[c])
           continue;
 
+        if (restrict_to_corridor && !(corridor[a] && corridor[b] && corridor[c]))
+          continue;
+
         // We are looking for a face where exactly
         // one vertex is not in the fixed set
         if (fixed[a] && fixed[b] && fixed[c])
@@ -737,6 +937,7 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
   if (cancel_planning)
   {
     ROS_WARN_STREAM("Wave front propagation has been canceled!");
+    outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::CANCELED);
     return mbf_msgs::GetPathResult::CANCELED;
   }
   ros::WallTime t_wavefront_end = ros::WallTime::now();
@@ -748,52 +949,53 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
   ros::WallTime t_vector_field_end = ros::WallTime::now();
   double vector_field_duration = (t_vector_field_end - t_wavefront_end).toNSec() * 1e-6;
 
-  bool path_exists = false;
-  for (auto goal_vertex : goal_vertices)
+  ROS_DEBUG_STREAM("Start vector field back tracking!");
+
+  for (size_t i : open_goals)
   {
-    if (goal_vertex != predecessors[goal_vertex])
+    const auto goal_vertices = mesh.getVerticesOfFace(goal_faces[i]);
+    bool path_exists = false;
+    for (auto goal_vertex : goal_vertices)
     {
-      path_exists = true;
-      break;
+      if (goal_vertex != predecessors[goal_vertex])
+      {
+        path_exists = true;
+        break;
+      }
     }
-  }
 
-  if (!path_exists)
-  {
-    ROS_WARN("Predecessor of the goal is not set! No path found!");
-    return mbf_msgs::GetPathResult::NO_PATH_FOUND;
-  }
+    if (!path_exists)
+    {
+      ROS_WARN_STREAM("Predecessor of the goal " << i << " is not set! No path found!");
+      outcomes[i] = mbf_msgs::GetPathResult::NO_PATH_FOUND;
+      continue;
+    }
 
-  ROS_DEBUG_STREAM("Start vector field back tracking!");
+    // trace from the goal towards the seed, the distance of the goal gives the number of steps to expect
+    auto& path = paths[i];
+    const float trace_dist = std::min({ distances[goal_vertices[0]], distances[goal_vertices[1]],
+                                        distances[goal_vertices[2]] });
+    path.reserve(static_cast<size_t>(1.2 * trace_dist / config.step_width) + 2);
 
-  lvr2::FaceHandle current_face = goal_face;
-  mesh_map::Vector current_pos = goal;
-  path.push_front(std::pair<mesh_map::Vector, lvr2::FaceHandle>(current_pos, current_face));
+    VectorFieldTracer tracer(mesh_map, vector_map, original_goals[i], goal_faces[i], start, start_face,
+                             config.step_width, config.exact_integration);
+    std::pair<mesh_map::Vector, lvr2::FaceHandle> position;
+    while (!cancel_planning && tracer.next(position))
+    {
+      path.push_back(position);
+    }
 
-  // move from the goal position towards the start position
-  while (current_pos.distance2(start) > config.step_width && !cancel_planning)
-  {
-    // move current pos ahead on the surface following the vector field,
-    // updates the current face if necessary
-    try
+    if (tracer.failed())
     {
-      if (mesh_map->meshAhead(current_pos, current_face, config.step_width))
-      {
-        path.push_front(std::pair<mesh_map::Vector, lvr2::FaceHandle>(current_pos, current_face));
-      }
-      else
-      {
-        ROS_WARN_STREAM("Could not find a valid path, while back-tracking from the goal");
-        return mbf_msgs::GetPathResult::NO_PATH_FOUND;
-      }
+      ROS_WARN_STREAM("Could not find a valid path, while back-tracking from the goal " << i);
+      outcomes[i] = mbf_msgs::GetPathResult::NO_PATH_FOUND;
+      path.clear();
     }
-    catch (lvr2::PanicException exception)
+    else
     {
-      ROS_ERROR_STREAM("Could not find a valid path, while back-tracking from the goal: HalfEdgeMesh panicked!");
-      return mbf_msgs::GetPathResult::NO_PATH_FOUND;
+      outcomes[i] = mbf_msgs::GetPathResult::SUCCESS;
     }
   }
-  path.push_front(std::pair<mesh_map::Vector, lvr2::FaceHandle>(start, start_face));
 
   ros::WallTime t_path_backtracking = ros::WallTime::now();
   double path_backtracking_duration = (t_path_backtracking - t_vector_field_end).toNSec() * 1e-6;
@@ -807,11 +1009,12 @@ uint32_t WaveFrontPlanner::waveFrontPropagation(const mesh_map::Vector& original
   if (cancel_planning)
   {
     ROS_WARN_STREAM("Wave front propagation has been canceled!");
+    outcomes.assign(original_goals.size(), mbf_msgs::GetPathResult::CANCELED);
     return mbf_msgs::GetPathResult::CANCELED;
   }
 
   ROS_INFO_STREAM("Successfully finished vector field back tracking!");
-  return mbf_msgs::GetPathResult::SUCCESS;
+  return aggregatedOutcome();
 }
 
 } /* namespace wave_front_planner */